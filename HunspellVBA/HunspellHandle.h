@@ -0,0 +1,54 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "../HunspellVBACore/SpellEngine.h"
+#include "../HunspellVBACore/StreamChecker.h"
+
+/**
+ * @brief State behind the handle returned by HunspellInit.
+ *
+ * Callers only ever see an opaque pointer. All checking is done by the
+ * platform-neutral SpellEngine; this layer only converts BSTRs and
+ * marshals results for VBA.
+ */
+struct HunspellHandle {
+	HunspellHandle(const char* affixFilePath, const char* dictionaryFilePath, bool loadHunspell = true,
+		const char* key = nullptr)
+		: engine(affixFilePath, dictionaryFilePath, loadHunspell, key) {
+	}
+
+	SpellEngine engine;
+};
+
+/**
+ * @brief State behind the handle returned by StreamOpen.
+ */
+struct HunspellStream {
+	HunspellStream(SpellEngine& engine, TextEncoding encoding)
+		: checker(engine, encoding) {
+	}
+
+	StreamChecker checker;
+};
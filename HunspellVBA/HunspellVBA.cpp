@@ -23,247 +23,1212 @@
  */
 #include "pch.h"
 #include "HunspellVBA.h"
+#include "HunspellHandle.h"
+#include <algorithm>
+#include <climits>
 #include <string>
-#include <fstream>
-#include <iomanip>
-#include <iostream>
+#include <string_view>
 #include <vector>
 #include <Windows.h>
-#include <sstream>
-#include "utf8.h"
 #include <stdexcept>
+#include "../HunspellVBACore/DictionaryFile.h"
+#include "../HunspellVBACore/EditDistance.h"
+#include "../HunspellVBACore/Log.h"
+#include "../HunspellVBACore/Snapshot.h"
+#include "../HunspellVBACore/Trace.h"
+#include "../HunspellVBACore/Utf.h"
 
-void __stdcall HunspellInit(Hunspell** hunspell, const char* affixFilePath, const char* dictionaryFilePath) {
+static_assert(sizeof(OLECHAR) == sizeof(char16_t), "BSTR must hold UTF-16 code units");
+
+namespace
+{
+	std::u16string_view ToView(BSTR text) {
+		return std::u16string_view(reinterpret_cast<const char16_t*>(text), SysStringLen(text));
+	}
+
+	const char** ToItems(const std::vector<std::string>& items, int* count) {
+		TraceSpan build("result_build", "result");
+		const char** result = (const char**)malloc((items.size() + 1) * sizeof(const char*));
+		if (result == nullptr) {
+			*count = 0;
+			return nullptr;
+		}
+		for (size_t i = 0; i < items.size(); ++i) {
+			result[i] = _strdup(items[i].c_str());
+		}
+		result[items.size()] = nullptr;
+		*count = static_cast<int>(items.size());
+		return result;
+	}
+
+	/** @return 1 for an hzip file, 0 for a plain one, -1 if neither exists, -2 if the header or key is wrong */
+	int ProbeDictionary(const char* path, const char* key) {
+		if (DictionaryFile::resolve(path).empty()) {
+			return -1;
+		}
+		DictionaryFile file;
+		if (!file.open(path, key)) {
+			return -2;
+		}
+		return file.isCompressed() ? 1 : 0;
+	}
+
+	/** Keeps a SAFEARRAY locked while its elements are read. */
+	class LockedArray {
+	public:
+		explicit LockedArray(SAFEARRAY* array) : array(array) {
+			if (FAILED(SafeArrayAccessData(array, &data))) {
+				data = nullptr;
+			}
+		}
+		~LockedArray() {
+			if (data != nullptr) {
+				SafeArrayUnaccessData(array);
+			}
+		}
+		LockedArray(const LockedArray&) = delete;
+		LockedArray& operator=(const LockedArray&) = delete;
+
+		void* data = nullptr;
+
+	private:
+		SAFEARRAY* array;
+	};
+}
+
+void __stdcall HunspellInit(HunspellHandle** hunspell, const char* affixFilePath, const char* dictionaryFilePath) {
 	if (hunspell == nullptr || affixFilePath == nullptr || dictionaryFilePath == nullptr) {
-#ifdef _DEBUG
-		std::cerr << "Error: Null pointer argument." << std::endl;
-#endif
+		LOG_ERROR("Null pointer argument.");
 		throw std::invalid_argument("Null pointer argument.");
 	}
 
+	TraceSpan span("HunspellInit", "api");
+
 	try {
-		*hunspell = new Hunspell(affixFilePath, dictionaryFilePath);
+		*hunspell = new HunspellHandle(affixFilePath, dictionaryFilePath);
 	}
 	catch (const std::exception& e) {
-#ifdef _DEBUG
-		std::cerr << "Hunspell initialization failed: " << e.what() << std::endl;
-#endif
+		LOG_ERROR_TEXT("Hunspell initialization failed:", e.what());
 		* hunspell = nullptr;
 	}
 }
 
-bool __stdcall CheckSpelling(Hunspell* hunspell, BSTR word) {
+int __stdcall HunspellInitShared(HunspellHandle** hunspell, const char* affixFilePath, const char* dictionaryFilePath, const char* segmentDirectory) {
+	if (hunspell == nullptr || affixFilePath == nullptr || dictionaryFilePath == nullptr || segmentDirectory == nullptr) {
+		LOG_ERROR("Null pointer argument.");
+		return -1;
+	}
+
+	TraceSpan span("HunspellInitShared", "api");
+
+	try {
+		*hunspell = new HunspellHandle(affixFilePath, dictionaryFilePath, false);
+	}
+	catch (const std::exception& e) {
+		LOG_ERROR_TEXT("Hunspell initialization failed:", e.what());
+		*hunspell = nullptr;
+		return -3;
+	}
+
+	long long words = (*hunspell)->engine.attachSharedDictionary(segmentDirectory);
+	if (words < 0) {
+		LOG_ERROR_TEXT("Cannot build or load the shared dictionary in:", segmentDirectory);
+		return -2;
+	}
+	return words > INT_MAX ? INT_MAX : (int)words;
+}
+
+int __stdcall SaveHandleSnapshot(HunspellHandle* hunspell, const char* snapshotPath) {
 	if (hunspell == nullptr) {
-		std::cerr << "Error: Null pointer passed for Hunspell instance." << std::endl;
-		return false;
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
 	}
 
-	if (word == nullptr) {
-		std::cerr << "Error: Null pointer passed for word." << std::endl;
-		return false;
+	if (snapshotPath == nullptr) {
+		LOG_ERROR("Null pointer passed for snapshot path.");
+		return -2;
 	}
 
+	TraceSpan span("SaveHandleSnapshot", "api");
 	try {
-		std::wstring wstr(word, SysStringLen(word));
-
-		int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), NULL, 0, NULL, NULL);
-		if (size_needed <= 0) {
-			std::cerr << "Error: WideCharToMultiByte failed to calculate size." << std::endl;
-			return false;
+		int result = hunspell->engine.saveSnapshot(snapshotPath);
+		if (result == -1) {
+			LOG_ERROR("Cannot read a dictionary file of the handle.");
+			return -3;
 		}
-
-		std::vector<char> utf8_buffer(size_needed);
-		int result = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), utf8_buffer.data(), size_needed, NULL, NULL);
-		if (result == 0) {
-			std::cerr << "Error: WideCharToMultiByte conversion failed." << std::endl;
-			return false;
+		if (result == -2) {
+			LOG_ERROR("Cannot build the automaton of the snapshot.");
+			return -4;
+		}
+		if (result == -3) {
+			LOG_ERROR_TEXT("Cannot write snapshot:", snapshotPath);
+			return -5;
 		}
+		return 0;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -6;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during SaveHandleSnapshot.");
+		return -7;
+	}
+}
+
+int __stdcall LoadHandleSnapshot(HunspellHandle** hunspell, const char* snapshotPath, const char* key) {
+	if (hunspell == nullptr || snapshotPath == nullptr) {
+		LOG_ERROR("Null pointer argument.");
+		return -1;
+	}
+
+	*hunspell = nullptr;
+	TraceSpan span("LoadHandleSnapshot", "api");
+	EngineSnapshot snapshot;
+	if (!ReadSnapshot(snapshotPath, snapshot)) {
+		LOG_ERROR_TEXT("Snapshot missing or damaged:", snapshotPath);
+		return -2;
+	}
+	if (!SnapshotIsCurrent(snapshot)) {
+		LOG_ERROR_TEXT("Dictionary files changed since the snapshot was saved:", snapshotPath);
+		return -3;
+	}
+
+	long long words;
+	try {
+		*hunspell = new HunspellHandle(snapshot.sources[0].path.c_str(), snapshot.sources[1].path.c_str(), false,
+			snapshot.sources[1].encrypted ? key : nullptr);
+		words = (*hunspell)->engine.restoreSnapshot(snapshotPath, snapshot, key);
+	}
+	catch (const std::exception& e) {
+		LOG_ERROR_TEXT("Hunspell initialization failed:", e.what());
+		words = -1;
+	}
+	if (words < 0) {
+		LOG_ERROR_TEXT("Cannot restore snapshot:", snapshotPath);
+		delete *hunspell;
+		*hunspell = nullptr;
+		return -4;
+	}
+	return words > INT_MAX ? INT_MAX : (int)words;
+}
+
+int __stdcall HunspellInitWithKey(HunspellHandle** hunspell, const char* affixFilePath, const char* dictionaryFilePath, const char* key) {
+	if (hunspell == nullptr || affixFilePath == nullptr || dictionaryFilePath == nullptr) {
+		LOG_ERROR("Null pointer argument.");
+		return -1;
+	}
+
+	*hunspell = nullptr;
+	TraceSpan span("HunspellInitWithKey", "api");
+	int compressed = ProbeDictionary(dictionaryFilePath, key);
+	if (compressed == -1) {
+		LOG_ERROR_TEXT("Dictionary not found:", dictionaryFilePath);
+		return -2;
+	}
+	if (compressed == -2) {
+		LOG_ERROR_TEXT("Damaged compressed dictionary or wrong key:", dictionaryFilePath);
+		return -3;
+	}
+
+	try {
+		*hunspell = new HunspellHandle(affixFilePath, dictionaryFilePath, true, key);
+	}
+	catch (const std::exception& e) {
+		LOG_ERROR_TEXT("Hunspell initialization failed:", e.what());
+		*hunspell = nullptr;
+		return -4;
+	}
+	return compressed;
+}
+
+bool __stdcall CheckSpelling(HunspellHandle* hunspell, BSTR word) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return false;
+	}
+
+	if (word == nullptr) {
+		LOG_ERROR("Null pointer passed for word.");
+		return false;
+	}
+
+	if (SysStringLen(word) == 0) {
+		HUNSPELL_LOG(LogLevel::Debug, "Empty word.", 0, nullptr);
+		return false;
+	}
 
-		std::string utf8str(utf8_buffer.begin(), utf8_buffer.end());
+	TraceSpan span("CheckSpelling", "api");
 
-		return hunspell->spell(utf8str);
+	try {
+		return hunspell->engine.check(ToView(word));
 	}
 	catch (const std::exception& ex) {
-		std::cerr << "Exception: " << ex.what() << std::endl;
+		LOG_ERROR_TEXT("Exception:", ex.what());
 		return false;
 	}
 	catch (...) {
-		std::cerr << "Unknown error occurred during CheckSpelling." << std::endl;
+		LOG_ERROR("Unknown error occurred during CheckSpelling.");
 		return false;
 	}
 }
 
-
-
-void __stdcall HunspellFree(Hunspell* hunspell) {
+void __stdcall HunspellFree(HunspellHandle* hunspell) {
 	if (hunspell != nullptr) {
 		delete hunspell;
 		hunspell = nullptr;
 	}
 }
 
-int __stdcall AddDictionary(Hunspell* hunspell, const char* dictionaryFilePath) {
+int __stdcall AddDictionaryWithKey(HunspellHandle* hunspell, const char* dictionaryFilePath, const char* key) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+
+	if (dictionaryFilePath == nullptr) {
+		LOG_ERROR("Null pointer passed for dictionary file path.");
+		return -2;
+	}
+
+	TraceSpan span("AddDictionaryWithKey", "api");
+	int compressed = ProbeDictionary(dictionaryFilePath, key);
+	if (compressed == -1) {
+		LOG_ERROR_TEXT("Dictionary not found:", dictionaryFilePath);
+		return -3;
+	}
+	if (compressed == -2) {
+		LOG_ERROR_TEXT("Damaged compressed dictionary or wrong key:", dictionaryFilePath);
+		return -4;
+	}
+
+	try {
+		int result = hunspell->engine.addDictionary(dictionaryFilePath, key);
+		if (result != 0) {
+			LOG_ERROR_CODE("Failed to add dictionary. Result code:", result);
+			return -5;
+		}
+		return compressed;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -5;
+	}
+}
+
+int __stdcall ReloadDictionary(HunspellHandle* hunspell, int wait) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+
+	TraceSpan span("ReloadDictionary", "api");
+
+	try {
+		if (!hunspell->engine.reload() && !wait) {
+			LOG_ERROR("A dictionary reload is already running.");
+			return -2;
+		}
+		if (!wait) {
+			return 0;
+		}
+		if (hunspell->engine.finishReload() != 1) {
+			LOG_ERROR("Cannot read the dictionary files; the current dictionary is kept.");
+			return -3;
+		}
+		return 1;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -4;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during ReloadDictionary.");
+		return -5;
+	}
+}
+
+int __stdcall AddDictionary(HunspellHandle* hunspell, const char* dictionaryFilePath) {
 	if (hunspell == nullptr) {
-		std::cerr << "Error: Null pointer passed for Hunspell instance." << std::endl;
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
 		return -1;
 	}
 
 	if (dictionaryFilePath == nullptr) {
-		std::cerr << "Error: Null pointer passed for dictionary file path." << std::endl;
+		LOG_ERROR("Null pointer passed for dictionary file path.");
 		return -2;
 	}
 
+	TraceSpan span("AddDictionary", "api");
+
 	try {
-		int result = hunspell->add_dic(dictionaryFilePath);
+		int result = hunspell->engine.addDictionary(dictionaryFilePath);
 
 		if (result != 0) {
-			std::cerr << "Error: Failed to add dictionary. Result code: " << result << std::endl;
+			LOG_ERROR_CODE("Failed to add dictionary. Result code:", result);
 			return result;
 		}
 
 		return 0;
 	}
 	catch (const std::exception& ex) {
-		std::cerr << "Exception: " << ex.what() << std::endl;
+		LOG_ERROR_TEXT("Exception:", ex.what());
 		return -3;
 	}
 	catch (...) {
-		std::cerr << "Unknown error occurred while adding dictionary." << std::endl;
+		LOG_ERROR("Unknown error occurred while adding dictionary.");
 		return -4;
 	}
 }
 
-int __stdcall AddWord(Hunspell* hunspell, BSTR word) {
+int __stdcall AddWord(HunspellHandle* hunspell, BSTR word) {
 	if (hunspell == nullptr) {
-		std::cerr << "Error: Null pointer passed for Hunspell instance." << std::endl;
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
 		return -1;
 	}
 
 	if (word == nullptr) {
-		std::cerr << "Error: Null pointer passed for word." << std::endl;
+		LOG_ERROR("Null pointer passed for word.");
 		return -2;
 	}
 
-	try {
-		std::wstring wstr(word, SysStringLen(word));
-
-		int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), NULL, 0, NULL, NULL);
-		if (size_needed <= 0) {
-			std::cerr << "Error: WideCharToMultiByte failed to calculate size." << std::endl;
-			return -3;
-		}
-
-		std::vector<char> utf8_buffer(size_needed);
-		int result = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), utf8_buffer.data(), size_needed, NULL, NULL);
-		if (result == 0) {
-			std::cerr << "Error: WideCharToMultiByte conversion failed." << std::endl;
-			return -4;
-		}
+	if (SysStringLen(word) == 0) {
+		HUNSPELL_LOG(LogLevel::Debug, "Empty word.", 0, nullptr);
+		return -3;
+	}
 
-		std::string utf8str(utf8_buffer.begin(), utf8_buffer.end());
+	TraceSpan span("AddWord", "api");
 
-		return hunspell->add(utf8str);
+	try {
+		return hunspell->engine.addWord(ToView(word));
 	}
 	catch (const std::exception& ex) {
-		std::cerr << "Exception: " << ex.what() << std::endl;
+		LOG_ERROR_TEXT("Exception:", ex.what());
 		return -5;
 	}
 	catch (...) {
-		std::cerr << "Unknown error occurred while adding word." << std::endl;
+		LOG_ERROR("Unknown error occurred while adding word.");
 		return -6;
 	}
 }
 
-
 void __stdcall FreeItems(const char** items, int count) {
+	if (items == nullptr) {
+		return;
+	}
 	for (int i = 0; i < count; ++i) {
 		free((void*)items[i]);
 	}
 	free(items);
 }
 
-const char** __stdcall GetSuggestions(Hunspell* hunspell, BSTR word, int* count) {
+const char** __stdcall GetSuggestions(HunspellHandle* hunspell, BSTR word, int* count) {
 	if (count == nullptr) {
 		return nullptr;
 	}
+	if (hunspell == nullptr || word == nullptr) {
+		LOG_ERROR("Null pointer passed to GetSuggestions.");
+		*count = 0;
+		return nullptr;
+	}
+
+	TraceSpan span("GetSuggestions", "api");
+
+	try {
+		return ToItems(hunspell->engine.suggest(ToView(word)), count);
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		*count = 0;
+		return nullptr;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during GetSuggestions.");
+		*count = 0;
+		return nullptr;
+	}
+}
 
-	std::wstring wstr(word, SysStringLen(word));
+int __stdcall CheckAndSuggest(HunspellHandle* hunspell, BSTR word, int maxCount, const char*** suggestions, int* count) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+	if (word == nullptr || suggestions == nullptr || count == nullptr) {
+		LOG_ERROR("Null pointer passed to CheckAndSuggest.");
+		return -2;
+	}
+	*suggestions = nullptr;
+	*count = 0;
+	if (maxCount < 0) {
+		LOG_ERROR_CODE("Negative suggestion count passed to CheckAndSuggest:", maxCount);
+		return -3;
+	}
 
-	int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), NULL, 0, NULL, NULL);
-	std::string utf8str(size_needed, 0);
-	WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), &utf8str[0], size_needed, NULL, NULL);
+	TraceSpan span("CheckAndSuggest", "api");
 
-	std::vector<std::string> suggestions = hunspell->suggest(utf8str);
+	try {
+		// As in CheckSpelling, an empty word is reported as misspelled.
+		std::vector<std::string> found;
+		if (SysStringLen(word) != 0 && hunspell->engine.checkAndSuggest(ToView(word), (size_t)maxCount, found)) {
+			return 1;
+		}
+		if (!found.empty()) {
+			*suggestions = ToItems(found, count);
+		}
+		return 0;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -4;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during CheckAndSuggest.");
+		return -5;
+	}
+}
 
-	const char** result = (const char**)malloc(suggestions.size() * sizeof(const char*));
-	for (size_t i = 0; i < suggestions.size(); ++i) {
-		result[i] = _strdup(suggestions[i].c_str());
+const char** __stdcall GetSuffixSuggestions(HunspellHandle* hunspell, BSTR word, int* count) {
+	if (count == nullptr) {
+		return nullptr;
+	}
+	if (hunspell == nullptr || word == nullptr) {
+		LOG_ERROR("Null pointer passed to GetSuffixSuggestions.");
+		*count = 0;
+		return nullptr;
 	}
 
-	*count = static_cast<int>(suggestions.size());
+	TraceSpan span("GetSuffixSuggestions", "api");
 
-	return result;
+	try {
+		return ToItems(hunspell->engine.suffixSuggest(ToView(word)), count);
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		*count = 0;
+		return nullptr;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during GetSuffixSuggestions.");
+		*count = 0;
+		return nullptr;
+	}
 }
 
-const char** __stdcall GetSuffixSuggestions(Hunspell* hunspell, BSTR word, int* count) {
+const char** __stdcall GetMisspellings(HunspellHandle* hunspell, BSTR text, int* count) {
 	if (count == nullptr) {
 		return nullptr;
 	}
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		*count = 0;
+		return nullptr;
+	}
 
-	std::wstring wstr(word, SysStringLen(word));
+	TraceSpan span("GetMisspellings", "api");
 
-	int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), NULL, 0, NULL, NULL);
-	std::string utf8str(size_needed, 0);
-	WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), &utf8str[0], size_needed, NULL, NULL);
+	try {
+		std::vector<std::string> misspelledWords;
+		hunspell->engine.forEachMisspelling(ToView(text), [&](const Misspelling& misspelling) {
+			misspelledWords.emplace_back(misspelling.word);
+			return true;
+		});
 
-	std::vector<std::string> suggestions = hunspell->suffix_suggest(utf8str);
+		return ToItems(misspelledWords, count);
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		*count = 0;
+		return nullptr;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during GetMisspellings.");
+		*count = 0;
+		return nullptr;
+	}
+}
 
-	const char** result = (const char**)malloc(suggestions.size() * sizeof(const char*));
-	for (size_t i = 0; i < suggestions.size(); ++i) {
-		result[i] = _strdup(suggestions[i].c_str());
+int __stdcall LoadCorrections(HunspellHandle* hunspell, const char* path) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
 	}
 
-	*count = static_cast<int>(suggestions.size());
+	if (path == nullptr) {
+		LOG_ERROR("Null pointer passed for corrections file path.");
+		return -2;
+	}
 
-	return result;
+	TraceSpan span("LoadCorrections", "api");
+	long long entries = hunspell->engine.loadCorrections(path);
+	if (entries < 0) {
+		LOG_ERROR_TEXT("Cannot load corrections:", path);
+		return -3;
+	}
+	return (int)entries;
 }
 
-const char** __stdcall GetMisspellings(Hunspell* hunspell, BSTR text, int* count) {
-	if (count == nullptr) {
-		return nullptr;
+int __stdcall LoadAutomaton(HunspellHandle* hunspell, const char* path) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
 	}
 
-	std::wstring wstr(text, SysStringLen(text));
+	if (path == nullptr) {
+		LOG_ERROR("Null pointer passed for automaton file path.");
+		return -2;
+	}
+
+	TraceSpan span("LoadAutomaton", "api");
+	long long words = hunspell->engine.loadAutomaton(path);
+	if (words < 0) {
+		LOG_ERROR_TEXT("Cannot load automaton:", path);
+		return -3;
+	}
+	return words > INT_MAX ? INT_MAX : (int)words;
+}
+
+int __stdcall SetSuggestionBackend(HunspellHandle* hunspell, int backend, int ranking, const char* frequencyListPath) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
 
-	int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), NULL, 0, NULL, NULL);
-	std::string utf8str(size_needed, 0);
-	WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), &utf8str[0], size_needed, NULL, NULL);
+	if (backend < 0 || backend > 2 || ranking < 0 || ranking > 1) {
+		LOG_ERROR("Invalid suggestion backend or ranking.");
+		return -2;
+	}
 
-	std::vector<std::string> misspelledWords;
-	std::string word;
-	std::istringstream iss(utf8str);
+	TraceSpan span("SetSuggestionBackend", "api");
+	if (backend == 0) {
+		hunspell->engine.useHunspellSuggest();
+		return 0;
+	}
 
-	while (iss >> word) {
-		if (!hunspell->spell(word)) {
-			misspelledWords.push_back(word);
+	try {
+		int result = backend == 2 ? hunspell->engine.useTrigramIndex()
+			: hunspell->engine.useSymSpell((SuggestionRanking)ranking, frequencyListPath);
+		if (result == -1) {
+			LOG_ERROR("Cannot build the suggestion index from the dictionary files.");
+			return -3;
 		}
+		if (result == -2) {
+			LOG_ERROR_TEXT("Cannot read frequency list:", frequencyListPath ? frequencyListPath : "(null)");
+			return -4;
+		}
+		return 0;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -5;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during SetSuggestionBackend.");
+		return -6;
 	}
+}
 
-	const char** result = (const char**)malloc((misspelledWords.size() + 1) * sizeof(const char*));
+int __stdcall SetTokenFilter(HunspellHandle* hunspell, int rules, int maxUppercaseLength) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
 
-	for (size_t i = 0; i < misspelledWords.size(); ++i) {
-		result[i] = _strdup(misspelledWords[i].c_str());
+	if (rules < 0 || (unsigned)rules > TokenFilter::kAll || maxUppercaseLength < 0) {
+		LOG_ERROR_CODE("Invalid token filter rules:", rules);
+		return -2;
 	}
 
-	if (result)
-	{
-		result[misspelledWords.size()] = nullptr;
+	TokenFilter filter;
+	filter.rules = (unsigned)rules;
+	filter.maxUppercaseLength = (size_t)maxUppercaseLength;
+	hunspell->engine.setTokenFilter(filter);
+	return 0;
+}
+
+int __stdcall SetGuardrails(HunspellHandle* hunspell, int maxCheckLength, int maxSuggestLength, int candidateBudget, int timeoutMs) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
 	}
 
-	if (count)
-	{
-		*count = static_cast<int>(misspelledWords.size());
+	if (maxCheckLength < 0 || maxSuggestLength < 0 || candidateBudget < 0 || timeoutMs < 0) {
+		LOG_ERROR("Guardrail limits must not be negative.");
+		return -2;
 	}
 
-	return result;
-}
\ No newline at end of file
+	Guardrails limits;
+	limits.maxCheckLength = (size_t)maxCheckLength;
+	limits.maxSuggestLength = (size_t)maxSuggestLength;
+	limits.candidateBudget = (size_t)candidateBudget;
+	limits.suggestTimeoutMs = (unsigned)timeoutMs;
+	hunspell->engine.setGuardrails(limits);
+	return 0;
+}
+
+int __stdcall GetLastSkip(HunspellHandle* hunspell) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+	return (int)hunspell->engine.lastTrip();
+}
+
+int __stdcall RankCandidates(BSTR word, const char** candidates, int count, int* distances, int* order) {
+	if (word == nullptr) {
+		LOG_ERROR("Null pointer passed for word.");
+		return -1;
+	}
+
+	if (count < 0 || (count > 0 && candidates == nullptr)) {
+		LOG_ERROR_CODE("Invalid candidate list passed to RankCandidates:", count);
+		return -2;
+	}
+
+	TraceSpan span("RankCandidates", "api");
+	std::string utf8;
+	ToUtf8(ToView(word), utf8);
+	std::u32string query;
+	DecodeUtf8(utf8, query);
+	std::vector<std::u32string> decoded((size_t)count);
+	std::vector<std::u32string_view> views;
+	views.reserve((size_t)count);
+	for (int i = 0; i < count; ++i) {
+		if (candidates[i] != nullptr) {
+			DecodeUtf8(candidates[i], decoded[i]);
+		}
+		views.push_back(decoded[i]);
+	}
+	RankByDistance(query, views, distances, order);
+	return count;
+}
+
+int __stdcall GetMisspellingsCallback(HunspellHandle* hunspell, BSTR text, MisspellingProc callback, void* context) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+
+	if (callback == nullptr) {
+		LOG_ERROR("Null pointer passed for callback.");
+		return -2;
+	}
+
+	TraceSpan span("GetMisspellingsCallback", "api");
+
+	try {
+		int delivered = 0;
+		hunspell->engine.forEachMisspelling(ToView(text), [&](const Misspelling& misspelling) {
+			++delivered;
+			return callback(misspelling.word.data(), (int)misspelling.word.size(),
+				(int)misspelling.offset, (int)misspelling.length, context) != 0;
+		});
+		return delivered;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -3;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during GetMisspellingsCallback.");
+		return -4;
+	}
+}
+
+int __stdcall GetSuggestionsCallback(HunspellHandle* hunspell, BSTR word, ItemProc callback, void* context) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+
+	if (word == nullptr || callback == nullptr) {
+		LOG_ERROR("Null pointer passed to GetSuggestionsCallback.");
+		return -2;
+	}
+
+	TraceSpan span("GetSuggestionsCallback", "api");
+
+	try {
+		std::vector<std::string> suggestions = hunspell->engine.suggest(ToView(word));
+		int delivered = 0;
+		for (const std::string& suggestion : suggestions) {
+			int index = delivered++;
+			if (callback(suggestion.data(), (int)suggestion.size(), index, context) == 0) {
+				break;
+			}
+		}
+		return delivered;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -3;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during GetSuggestionsCallback.");
+		return -4;
+	}
+}
+
+const char** __stdcall Analyze(HunspellHandle* hunspell, BSTR word, int* count) {
+	if (count == nullptr) {
+		return nullptr;
+	}
+	if (hunspell == nullptr || word == nullptr) {
+		LOG_ERROR("Null pointer passed to Analyze.");
+		*count = 0;
+		return nullptr;
+	}
+
+	TraceSpan span("Analyze", "api");
+
+	try {
+		return ToItems(hunspell->engine.analyze(ToView(word)), count);
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		*count = 0;
+		return nullptr;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during Analyze.");
+		*count = 0;
+		return nullptr;
+	}
+}
+
+const char** __stdcall Stem(HunspellHandle* hunspell, BSTR word, int* count) {
+	if (count == nullptr) {
+		return nullptr;
+	}
+	if (hunspell == nullptr || word == nullptr) {
+		LOG_ERROR("Null pointer passed to Stem.");
+		*count = 0;
+		return nullptr;
+	}
+
+	TraceSpan span("Stem", "api");
+
+	try {
+		return ToItems(hunspell->engine.stem(ToView(word)), count);
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		*count = 0;
+		return nullptr;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during Stem.");
+		*count = 0;
+		return nullptr;
+	}
+}
+
+const char** __stdcall Generate(HunspellHandle* hunspell, BSTR word, BSTR example, int* count) {
+	if (count == nullptr) {
+		return nullptr;
+	}
+	if (hunspell == nullptr || word == nullptr || example == nullptr) {
+		LOG_ERROR("Null pointer passed to Generate.");
+		*count = 0;
+		return nullptr;
+	}
+
+	TraceSpan span("Generate", "api");
+
+	try {
+		return ToItems(hunspell->engine.generate(ToView(word), ToView(example)), count);
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		*count = 0;
+		return nullptr;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during Generate.");
+		*count = 0;
+		return nullptr;
+	}
+}
+
+const char** __stdcall StemText(HunspellHandle* hunspell, BSTR text, int* count) {
+	if (count == nullptr) {
+		return nullptr;
+	}
+	if (hunspell == nullptr || text == nullptr) {
+		LOG_ERROR("Null pointer passed to StemText.");
+		*count = 0;
+		return nullptr;
+	}
+
+	TraceSpan span("StemText", "api");
+
+	try {
+		return ToItems(hunspell->engine.stemText(ToView(text)), count);
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		*count = 0;
+		return nullptr;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during StemText.");
+		*count = 0;
+		return nullptr;
+	}
+}
+
+int __stdcall CheckFile(HunspellHandle* hunspell, const char* path, int** ranges, int* count) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+
+	if (path == nullptr || ranges == nullptr || count == nullptr) {
+		LOG_ERROR("Null pointer passed to CheckFile.");
+		return -2;
+	}
+
+	*ranges = nullptr;
+	*count = 0;
+	TraceSpan span("CheckFile", "api");
+
+	try {
+		std::vector<int> found;
+		bool tooLarge = false;
+		TextEncoding encoding;
+		bool opened = hunspell->engine.forEachMisspellingInFile(path, [&](const Misspelling& misspelling) {
+			if (misspelling.offset + misspelling.length > (size_t)INT_MAX) {
+				tooLarge = true;
+				return false;
+			}
+			found.push_back((int)misspelling.offset);
+			found.push_back((int)misspelling.length);
+			return true;
+		}, encoding);
+
+		if (!opened) {
+			LOG_ERROR_TEXT("Cannot open file:", path);
+			return -3;
+		}
+		if (tooLarge) {
+			LOG_ERROR_TEXT("File too large for int offsets:", path);
+			return -4;
+		}
+
+		if (!found.empty()) {
+			*ranges = (int*)malloc(found.size() * sizeof(int));
+			if (*ranges == nullptr) {
+				return -5;
+			}
+			memcpy(*ranges, found.data(), found.size() * sizeof(int));
+			*count = (int)(found.size() / 2);
+		}
+		return (int)encoding;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -5;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during CheckFile.");
+		return -6;
+	}
+}
+
+int __stdcall CheckRange(HunspellHandle* hunspell, VARIANT* values, int** records, int* count) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+
+	if (values == nullptr || records == nullptr || count == nullptr) {
+		LOG_ERROR("Null pointer passed to CheckRange.");
+		return -2;
+	}
+
+	*records = nullptr;
+	*count = 0;
+	TraceSpan span("CheckRange", "api");
+
+	// A Variant passed ByRef from VBA may itself refer to the variable.
+	while (V_VT(values) == (VT_BYREF | VT_VARIANT) && V_VARIANTREF(values) != nullptr) {
+		values = V_VARIANTREF(values);
+	}
+
+	try {
+		std::vector<int> found;
+		auto checkCell = [&](BSTR text, int row, int column) {
+			hunspell->engine.forEachMisspelling(ToView(text), [&](const Misspelling& misspelling) {
+				found.push_back(row);
+				found.push_back(column);
+				found.push_back((int)misspelling.offset);
+				found.push_back((int)misspelling.length);
+				return true;
+			});
+		};
+
+		// Range.Value of a single cell is the value itself.
+		if (V_VT(values) == VT_BSTR || V_VT(values) == (VT_BYREF | VT_BSTR)) {
+			checkCell(V_VT(values) == VT_BSTR ? V_BSTR(values) : *V_BSTRREF(values), 1, 1);
+		}
+		else {
+			if ((V_VT(values) & VT_ARRAY) == 0) {
+				LOG_ERROR("CheckRange expects a string or a 2-D array.");
+				return -3;
+			}
+			SAFEARRAY* array = (V_VT(values) & VT_BYREF) ? *V_ARRAYREF(values) : V_ARRAY(values);
+			VARTYPE type = V_VT(values) & VT_TYPEMASK;
+			if (array == nullptr || SafeArrayGetDim(array) != 2 || (type != VT_VARIANT && type != VT_BSTR)) {
+				LOG_ERROR("CheckRange expects a 2-D array of Variant or String.");
+				return -3;
+			}
+
+			LONG firstRow, lastRow, firstColumn, lastColumn;
+			SafeArrayGetLBound(array, 1, &firstRow);
+			SafeArrayGetUBound(array, 1, &lastRow);
+			SafeArrayGetLBound(array, 2, &firstColumn);
+			SafeArrayGetUBound(array, 2, &lastColumn);
+			LockedArray locked(array);
+			if (locked.data == nullptr) {
+				LOG_ERROR("Cannot lock the array passed to CheckRange.");
+				return -4;
+			}
+
+			// Elements are stored column by column: the first dimension varies fastest.
+			size_t index = 0;
+			for (LONG column = firstColumn; column <= lastColumn; ++column) {
+				for (LONG row = firstRow; row <= lastRow; ++row, ++index) {
+					if (type == VT_BSTR) {
+						checkCell(static_cast<BSTR*>(locked.data)[index], row, column);
+						continue;
+					}
+					VARIANT* cell = static_cast<VARIANT*>(locked.data) + index;
+					if (V_VT(cell) == VT_BSTR) {
+						checkCell(V_BSTR(cell), row, column);
+					}
+				}
+			}
+		}
+
+		if (!found.empty()) {
+			*records = (int*)malloc(found.size() * sizeof(int));
+			if (*records == nullptr) {
+				return -5;
+			}
+			memcpy(*records, found.data(), found.size() * sizeof(int));
+			*count = (int)(found.size() / 4);
+		}
+		return *count;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -5;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during CheckRange.");
+		return -6;
+	}
+}
+
+void __stdcall FreeRanges(int* ranges) {
+	free(ranges);
+}
+
+int __stdcall StreamOpen(HunspellHandle* hunspell, int encoding, HunspellStream** stream) {
+	if (hunspell == nullptr) {
+		LOG_ERROR("Null pointer passed for Hunspell instance.");
+		return -1;
+	}
+
+	if (stream == nullptr) {
+		LOG_ERROR("Null pointer passed for stream.");
+		return -2;
+	}
+
+	if (encoding < (int)TextEncoding::Utf8 || encoding > (int)TextEncoding::Utf16BE) {
+		LOG_ERROR_CODE("Unknown stream encoding:", encoding);
+		*stream = nullptr;
+		return -3;
+	}
+
+	*stream = new HunspellStream(hunspell->engine, (TextEncoding)encoding);
+	return 0;
+}
+
+int __stdcall StreamPush(HunspellStream* stream, const void* data, int size) {
+	if (stream == nullptr) {
+		LOG_ERROR("Null pointer passed for stream.");
+		return -1;
+	}
+
+	if ((data == nullptr && size != 0) || size < 0) {
+		LOG_ERROR("Invalid chunk passed to StreamPush.");
+		return -2;
+	}
+
+	TraceSpan span("StreamPush", "api");
+
+	try {
+		return (int)stream->checker.push(data, (size_t)size);
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -3;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during StreamPush.");
+		return -4;
+	}
+}
+
+int __stdcall StreamFinish(HunspellStream* stream) {
+	if (stream == nullptr) {
+		LOG_ERROR("Null pointer passed for stream.");
+		return -1;
+	}
+
+	try {
+		return stream->checker.finish() ? 1 : 0;
+	}
+	catch (const std::exception& ex) {
+		LOG_ERROR_TEXT("Exception:", ex.what());
+		return -2;
+	}
+	catch (...) {
+		LOG_ERROR("Unknown error occurred during StreamFinish.");
+		return -3;
+	}
+}
+
+int __stdcall StreamSetCallback(HunspellStream* stream, StreamMisspellingProc callback, void* context) {
+	if (stream == nullptr) {
+		LOG_ERROR("Null pointer passed for stream.");
+		return -1;
+	}
+
+	if (callback == nullptr) {
+		stream->checker.setCallback(nullptr);
+		return 0;
+	}
+
+	stream->checker.setCallback([callback, context](const Misspelling& misspelling) {
+		return callback(misspelling.word.data(), (int)misspelling.word.size(),
+			(long long)misspelling.offset, (int)misspelling.length, context) != 0;
+	});
+	return 0;
+}
+
+int __stdcall StreamDrain(HunspellStream* stream, int capacity, long long* offsets, int* lengths, const char*** words) {
+	if (stream == nullptr) {
+		LOG_ERROR("Null pointer passed for stream.");
+		return -1;
+	}
+
+	if (capacity < 0) {
+		LOG_ERROR_CODE("Negative capacity passed to StreamDrain:", capacity);
+		return -2;
+	}
+
+	// The results stay queued until the word array is built, so a failed
+	// allocation loses none of them.
+	size_t count = (std::min)((size_t)capacity, stream->checker.queued());
+	if (words != nullptr) {
+		const char** items = (const char**)malloc((count + 1) * sizeof(const char*));
+		size_t built = 0;
+		if (items != nullptr) {
+			for (; built < count; ++built) {
+				items[built] = _strdup(stream->checker.queuedAt(built).word.c_str());
+				if (items[built] == nullptr) {
+					break;
+				}
+			}
+		}
+		if (built < count || items == nullptr) {
+			LOG_ERROR("Out of memory in StreamDrain; the results stay queued.");
+			FreeItems(items, (int)built);
+			*words = nullptr;
+			return -3;
+		}
+		items[count] = nullptr;
+		*words = items;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		const StreamMisspelling& result = stream->checker.queuedAt(i);
+		if (offsets != nullptr) {
+			offsets[i] = (long long)result.offset;
+		}
+		if (lengths != nullptr) {
+			lengths[i] = (int)result.length;
+		}
+	}
+	stream->checker.discard(count);
+	return (int)count;
+}
+
+void __stdcall StreamClose(HunspellStream* stream) {
+	delete stream;
+}
+
+void __stdcall EnableStats(HunspellHandle* hunspell, int enable) {
+	if (hunspell != nullptr) {
+		hunspell->engine.stats().enabled.store(enable != 0, std::memory_order_relaxed);
+	}
+}
+
+int __stdcall GetStats(HunspellHandle* hunspell, char* buffer, int bufferSize) {
+	if (hunspell == nullptr) {
+		return -1;
+	}
+
+	std::string json = hunspell->engine.stats().toJson();
+	int length = static_cast<int>(json.size());
+	if (buffer != nullptr && bufferSize > length) {
+		memcpy(buffer, json.c_str(), json.size() + 1);
+	}
+	return length;
+}
+
+void __stdcall ResetStats(HunspellHandle* hunspell) {
+	if (hunspell != nullptr) {
+		hunspell->engine.stats().reset();
+	}
+}
+
+void __stdcall TraceEnable(int enable) {
+	TraceBuffer::instance().setEnabled(enable != 0);
+}
+
+int __stdcall TraceDump(const char* path) {
+	if (path == nullptr) {
+		LOG_ERROR("Null pointer passed for trace file path.");
+		return -1;
+	}
+	return TraceBuffer::instance().writeJson(path);
+}
+
+void __stdcall TraceClear() {
+	TraceBuffer::instance().clear();
+}
+
+void __stdcall LogSetLevel(int level) {
+	if (level < (int)LogLevel::Debug) {
+		level = (int)LogLevel::Debug;
+	}
+	if (level > (int)LogLevel::Off) {
+		level = (int)LogLevel::Off;
+	}
+	Logger::instance().setLevel((LogLevel)level);
+}
+
+int __stdcall LogSetFile(const char* path) {
+	return Logger::instance().setFile(path) ? 0 : -1;
+}
+
+int __stdcall LogDump(const char* path) {
+	if (path == nullptr) {
+		LOG_ERROR("Null pointer passed for log file path.");
+		return -1;
+	}
+	return Logger::instance().dump(path);
+}
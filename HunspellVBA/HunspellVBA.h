@@ -25,13 +25,162 @@
 
 #include <Windows.h>
 #include <oleauto.h>
-#include "../../hunspell-1.7.2/src/hunspell/hunspell.hxx"
+
+struct HunspellHandle;
+struct HunspellStream;
+
+/**
+ * @brief Receives one misspelling from GetMisspellingsCallback.
+ *
+ * In VBA: Function OnMisspelling(ByVal word As LongPtr, ByVal wordLength As Long,
+ * ByVal offset As Long, ByVal length As Long, ByVal context As LongPtr) As Long
+ *
+ * @param word - UTF-8 text of the misspelling, valid only during the call and not NUL-terminated
+ * @param wordLength - length of word in bytes
+ * @param offset - position of the misspelling in the text, in UTF-16 characters
+ * @param length - length of the misspelling in UTF-16 characters
+ * @param context - value passed to the export, for the caller's own use
+ * @return non-zero to continue, 0 to stop
+ */
+typedef int (__stdcall *MisspellingProc)(const char* word, int wordLength, int offset, int length, void* context);
+
+/**
+ * @brief Receives one misspelling from a stream (StreamSetCallback).
+ *
+ * A stream can pass 2 GB, so the offset is 64-bit: in VBA, ByVal offset As
+ * LongLong, which only 64-bit Office has. 32-bit VBA uses StreamDrain.
+ *
+ * @param offset - position of the misspelling in bytes from the start of the stream
+ * @param length - length of the misspelling in bytes
+ * @see MisspellingProc for the other parameters
+ */
+typedef int (__stdcall *StreamMisspellingProc)(const char* word, int wordLength, long long offset, int length, void* context);
+
+/**
+ * @brief Receives one item (suggestion) from the callback exports.
+ *
+ * @param item - UTF-8 text, valid only during the call and not NUL-terminated
+ * @param itemLength - length of item in bytes
+ * @param index - position of the item in the result list
+ * @param context - value passed to the export
+ * @return non-zero to continue, 0 to stop
+ */
+typedef int (__stdcall *ItemProc)(const char* item, int itemLength, int index, void* context);
 
 extern "C" {
-	__declspec(dllexport) void __stdcall HunspellInit(Hunspell** hunspell, const char* affixFilePath, const char* dictionaryFilePath);
-	__declspec(dllexport) bool __stdcall CheckSpelling(Hunspell* hunspell, BSTR word);
-	__declspec(dllexport) void __stdcall HunspellFree(Hunspell* hunspell);
-	__declspec(dllexport) int __stdcall AddDictionary(Hunspell* hunspell, const char* dictionaryFilePath);
+	__declspec(dllexport) void __stdcall HunspellInit(HunspellHandle** hunspell, const char* affixFilePath, const char* dictionaryFilePath);
+
+	/**
+	 * @brief HunspellInit for many processes using the same dictionaries.
+	 *
+	 * The surface forms of the dictionary are kept as an automaton in a file in
+	 * segmentDirectory. The first process builds it (this takes seconds, once
+	 * per dictionary version); processes started meanwhile do not build it
+	 * again but return -2 and work with their own Hunspell. Every later
+	 * Excel, Word or Outlook process maps the same file read-only, so its
+	 * pages are in memory only once. Hunspell
+	 * itself is loaded privately by each handle, and only when a word is not in
+	 * the automaton or a function other than checking needs it. Added words
+	 * and dictionaries stay private to the handle.
+	 *
+	 * @param hunspell - receives the handle, or NULL if it cannot be created
+	 * @param segmentDirectory - directory writable by every process, for example on a local disk
+	 * @return number of words in the shared automaton; -1 null argument, -2 the
+	 *         automaton cannot be built or loaded, or another process is
+	 *         building it (the handle still works, with its own Hunspell),
+	 *         -3 the handle cannot be created
+	 */
+	__declspec(dllexport) int __stdcall HunspellInitShared(HunspellHandle** hunspell, const char* affixFilePath, const char* dictionaryFilePath, const char* segmentDirectory);
+
+	/**
+	 * @brief HunspellInit for hzip-compressed (.hz) and encrypted dictionaries.
+	 *
+	 * Files are found the way Hunspell finds them: the given name if it
+	 * exists, otherwise the same name with ".hz" appended, so "tk-TM.dic"
+	 * loads tk-TM.dic.hz when only that is installed (a name given with ".hz"
+	 * works too). Compressed files are decoded block by block while they are
+	 * read, never unpacked to disk or into one buffer.
+	 *
+	 * @param hunspell - receives the handle, or NULL if it cannot be created
+	 * @param key - key the files were encrypted with (hzip -P), or NULL
+	 * @return 1 if the dictionary was loaded from a compressed file, 0 from a
+	 *         plain one; -1 null argument, -2 dictionary not found, -3 the
+	 *         compressed file is damaged or the key is wrong, -4 initialization failed
+	 */
+	__declspec(dllexport) int __stdcall HunspellInitWithKey(HunspellHandle** hunspell, const char* affixFilePath, const char* dictionaryFilePath, const char* key);
+
+	/**
+	 * @brief Save everything needed to recreate a handle into one file.
+	 *
+	 * The file records the .aff and .dic files (with size, modification time
+	 * and a hash of their contents), dictionaries added with AddDictionary,
+	 * words added with AddWord, the token filter, guardrails, suggestion
+	 * backend and correction table, and an automaton of every correct form.
+	 * Building the automaton takes seconds; do it once after the handle is set
+	 * up, not on every start. Keys of encrypted dictionaries are not saved.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param snapshotPath - file to write; an existing one is replaced
+	 * @return 0 on success, -1 null handle, -2 null path, -3 a dictionary file
+	 *         cannot be read, -4 the automaton cannot be built, -5 the file
+	 *         cannot be written, -6 out of memory (or another exception),
+	 *         -7 unknown error
+	 */
+	__declspec(dllexport) int __stdcall SaveHandleSnapshot(HunspellHandle* hunspell, const char* snapshotPath);
+
+	/**
+	 * @brief Create a handle from a file written by SaveHandleSnapshot.
+	 *
+	 * Replaces HunspellInit and the AddDictionary and AddWord calls that
+	 * followed it. Correct words are answered from the automaton in the
+	 * snapshot; Hunspell loads the dictionaries only when a word is not in
+	 * it or a suggestion, stem or analysis is requested. A snapshot whose
+	 * dictionary files changed since it was saved is refused, so the caller
+	 * can set the handle up the long way and save a new one; files that were
+	 * only touched or copied are hashed and still accepted.
+	 *
+	 * @param hunspell - receives the handle, or NULL if it cannot be created
+	 * @param key - key of encrypted dictionaries in the snapshot, or NULL
+	 * @return number of words in the snapshot's automaton; -1 null argument,
+	 *         -2 snapshot missing or damaged, -3 a dictionary file changed or
+	 *         is missing, -4 the handle cannot be created
+	 */
+	__declspec(dllexport) int __stdcall LoadHandleSnapshot(HunspellHandle** hunspell, const char* snapshotPath, const char* key);
+	__declspec(dllexport) bool __stdcall CheckSpelling(HunspellHandle* hunspell, BSTR word);
+	__declspec(dllexport) void __stdcall HunspellFree(HunspellHandle* hunspell);
+	__declspec(dllexport) int __stdcall AddDictionary(HunspellHandle* hunspell, const char* dictionaryFilePath);
+
+	/**
+	 * @brief AddDictionary for hzip-compressed (.hz) and encrypted dictionaries.
+	 *
+	 * The file is found as in HunspellInitWithKey.
+	 *
+	 * @param key - key the file was encrypted with, or NULL
+	 * @return 1 if a compressed file was added, 0 a plain one; -1 null handle,
+	 *         -2 null path, -3 dictionary not found, -4 the compressed file is
+	 *         damaged or the key is wrong, -5 Hunspell could not add it
+	 */
+	__declspec(dllexport) int __stdcall AddDictionaryWithKey(HunspellHandle* hunspell, const char* dictionaryFilePath, const char* key);
+
+	/**
+	 * @brief Load updated dictionary files without closing the handle.
+	 *
+	 * The .aff and .dic files the handle was created with, and the
+	 * dictionaries added to it, are read again on a background thread while
+	 * the handle keeps answering from the current dictionary. The first call
+	 * after the new one is complete switches to it in one step, together
+	 * with its suggestion index and automaton; words added with AddWord,
+	 * before or during the reload, are kept. Statistics, settings and open
+	 * streams stay as they are.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param wait - 1 to return only when the new dictionary is in use, 0 to return at once
+	 * @return 0 reload started, 1 new dictionary in use (wait = 1), -1 null handle,
+	 *         -2 a reload is already running (wait = 0), -3 a dictionary file
+	 *         cannot be read or the new dictionary does not fit in memory; the
+	 *         current dictionary is kept, -4/-5 internal error
+	 */
+	__declspec(dllexport) int __stdcall ReloadDictionary(HunspellHandle* hunspell, int wait);
 
 	/**
 	 * @brief Suggest words based on combination of affix+roots.
@@ -50,7 +199,31 @@ extern "C" {
 	 * @pre hunspell, count must be created before.
 	 * @post returned pointer must be freed by the calling side.
 	 */
-	__declspec(dllexport) const char** __stdcall GetSuggestions(Hunspell* hunspell, BSTR word, int* count);
+	__declspec(dllexport) const char** __stdcall GetSuggestions(HunspellHandle* hunspell, BSTR word, int* count);
+
+	/**
+	 * @brief Check a word and, if it is misspelled, suggest corrections in the same call.
+	 *
+	 * Replaces the CheckSpelling + GetSuggestions pair of a correction
+	 * report: the word crosses the boundary and is converted once.
+	 * Suggestions are the first ones GetSuggestions would return, from the
+	 * same correction table, backend or Hunspell and under the same
+	 * guardrails.
+	 *
+	 * In VBA: Declare PtrSafe Function CheckAndSuggest Lib "HunspellVBA.dll" (ByVal hunspell As LongPtr,
+	 * ByVal word As LongPtr, ByVal maxCount As Long, ByRef suggestions As LongPtr, ByRef count As Long) As Long
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param word - word to check (StrPtr in VBA)
+	 * @param maxCount - most suggestions to return, up to 15; 0 only checks
+	 * @param suggestions - receives a UTF-8 string array for a misspelled word, NULL otherwise
+	 * @param count - receives the number of suggestions
+	 * @return 1 correct, 0 misspelled, -1 null handle, -2 null argument,
+	 *         -3 negative maxCount, -4/-5 internal error
+	 *
+	 * @post suggestions must be freed with FreeItems.
+	 */
+	__declspec(dllexport) int __stdcall CheckAndSuggest(HunspellHandle* hunspell, BSTR word, int maxCount, const char*** suggestions, int* count);
 
 	/**
 	 * @brief Suggest words based on combination of affix+roots, more focused than suggest()
@@ -69,8 +242,373 @@ extern "C" {
 	 * @pre hunspell, count must be created before.
 	 * @post returned pointer must be freed by the calling side.
 	 */
-	__declspec(dllexport) const char** __stdcall GetSuffixSuggestions(Hunspell* hunspell, BSTR word, int* count);
-	__declspec(dllexport) const char** __stdcall GetMisspellings(Hunspell* hunspell, BSTR text, int* count);
+	__declspec(dllexport) const char** __stdcall GetSuffixSuggestions(HunspellHandle* hunspell, BSTR word, int* count);
+	__declspec(dllexport) const char** __stdcall GetMisspellings(HunspellHandle* hunspell, BSTR text, int* count);
+
+	/**
+	 * @brief Load a precomputed misspelling -> suggestions table.
+	 *
+	 * The table is written by "HunspellVBACli build-corrections" from a corpus
+	 * of observed typos. Once loaded, GetSuggestions answers words found in
+	 * the table with one perfect-hash lookup and only calls Hunspell for the
+	 * rest. Hits and lookups are reported by GetStats.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param path - table file; replaces any table loaded before
+	 * @return number of entries, or -1 null handle, -2 null path, -3 file missing or invalid
+	 */
+	__declspec(dllexport) int __stdcall LoadCorrections(HunspellHandle* hunspell, const char* path);
+
+	/**
+	 * @brief Load a prebuilt automaton of the dictionary's surface forms.
+	 *
+	 * The file is written by "HunspellVBACli build-automaton" and memory-mapped.
+	 * Once loaded, CheckSpelling and the other checking functions accept
+	 * words found in it with one walk over their letters and only ask
+	 * Hunspell about the rest (compounds, capitalised forms, added words).
+	 * GetStats reports automaton lookups and hits.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param path - automaton file; replaces any automaton loaded before
+	 * @return number of words, or -1 null handle, -2 null path, -3 file missing or invalid
+	 */
+	__declspec(dllexport) int __stdcall LoadAutomaton(HunspellHandle* hunspell, const char* path);
+
+	/**
+	 * @brief Choose how GetSuggestions finds candidates for this handle.
+	 *
+	 * Backend 1 builds a symmetric-delete index over the dictionary and its
+	 * suffix rules (this takes about a second) and answers from it in well
+	 * under a millisecond; candidates are still checked with Hunspell.
+	 * Backend 2 replaces Hunspell's n-gram pass with an inverted trigram index
+	 * over the roots, so suggestions stay as fast after AddDictionary and
+	 * AddWord, which update the index in place.
+	 * Backend 0 goes back to Hunspell's own suggest.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param backend - 0 Hunspell, 1 symmetric delete, 2 trigram index
+	 * @param ranking - order of candidates at equal edit distance: 0 by similarity
+	 *                  to the misspelling, 1 by frequency from frequencyListPath;
+	 *                  backend 2 always ranks by distance, then similarity
+	 * @param frequencyListPath - UTF-8 "word count" lines; only used when ranking is 1
+	 * @return 0 on success, -1 null handle, -2 invalid backend or ranking,
+	 *         -3 dictionary cannot be indexed, -4 frequency list cannot be read,
+	 *         -5 the index does not fit in memory (or another exception),
+	 *         -6 unknown error; on errors the previous backend stays in use
+	 */
+	__declspec(dllexport) int __stdcall SetSuggestionBackend(HunspellHandle* hunspell, int backend, int ranking, const char* frequencyListPath);
+
+	/**
+	 * @brief Skip tokens that are not words before they reach Hunspell.
+	 *
+	 * CheckSpelling, GetMisspellings and the streaming and callback variants
+	 * treat matching tokens as correct. Each token is classified in one pass
+	 * over its characters; GetStats counts skipped tokens per rule.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param rules - sum of 1 (tokens with digits), 2 (URLs), 4 (e-mail addresses)
+	 *                and 8 (all-uppercase ASCII tokens); 0 checks every token
+	 * @param maxUppercaseLength - longest all-uppercase token skipped by rule 8, 0 for any length
+	 * @return 0 on success, -1 null handle, -2 invalid rules or length
+	 */
+	__declspec(dllexport) int __stdcall SetTokenFilter(HunspellHandle* hunspell, int rules, int maxUppercaseLength);
+
+	/**
+	 * @brief Keep single pathological words from freezing the host application.
+	 *
+	 * A word longer than a length limit is skipped: CheckSpelling returns
+	 * true and GetSuggestions an empty list; GetMisspellings and the other
+	 * scans pass over it. Hunspell's own suggest cannot be interrupted, so
+	 * with a timeout it runs on the handle's worker thread, and a late call
+	 * is left to finish there: until it does, further suggestion calls time
+	 * out at once, and a check that needs Hunspell loads the dictionaries
+	 * again. HunspellFree waits for such a call. GetLastSkip tells a skipped
+	 * word from a real result; GetStats counts every trip.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param maxCheckLength - longest word checked, in characters; 0 for no limit
+	 * @param maxSuggestLength - longest word that gets suggestions; 0 for no limit
+	 * @param candidateBudget - candidates a suggestion backend (SetSuggestionBackend)
+	 *                          may verify per call, or Hunspell's suggest may
+	 *                          try for the word; 0 for no limit
+	 * @param timeoutMs - longest GetSuggestions call in milliseconds; 0 for no limit
+	 * @return 0 on success, -1 null handle, -2 negative limit
+	 */
+	__declspec(dllexport) int __stdcall SetGuardrails(HunspellHandle* hunspell, int maxCheckLength, int maxSuggestLength, int candidateBudget, int timeoutMs);
+
+	/**
+	 * @brief Why the last CheckSpelling or suggestion call was skipped.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @return 0 not skipped, 1 word too long, 2 candidate budget used up (the
+	 *         suggestions are incomplete), 3 timed out, -1 null handle
+	 */
+	__declspec(dllexport) int __stdcall GetLastSkip(HunspellHandle* hunspell);
+
+	/**
+	 * @brief Rank candidate corrections by edit distance from a word.
+	 *
+	 * Distances count insertions, deletions, substitutions and swaps of
+	 * adjacent letters, over code points. Candidates at equal distance keep
+	 * their order, so re-ranking the result of GetSuggestions only moves the
+	 * entries the distance disagrees with.
+	 *
+	 * @param word - the misspelled word
+	 * @param candidates - UTF-8 strings, for example the items of GetSuggestions
+	 * @param count - number of candidates
+	 * @param distances - receives count distances, in candidate order; may be null
+	 * @param order - receives count candidate indexes (0-based), closest first; may be null
+	 * @return count, or -1 null word, -2 negative count or null candidates
+	 */
+	__declspec(dllexport) int __stdcall RankCandidates(BSTR word, const char** candidates, int count, int* distances, int* order);
+
+	/**
+	 * @brief GetMisspellings without building a result array.
+	 *
+	 * callback is called once per misspelling, in text order, with a pointer
+	 * into internal storage. Returning 0 from the callback ends the scan, for
+	 * example after the first screenful of results.
+	 *
+	 * @return number of misspellings delivered, or -1 null handle, -2 null callback, -3/-4 internal error
+	 */
+	__declspec(dllexport) int __stdcall GetMisspellingsCallback(HunspellHandle* hunspell, BSTR text, MisspellingProc callback, void* context);
+
+	/**
+	 * @brief GetSuggestions without building a result array.
+	 *
+	 * @return number of suggestions delivered, or -1 null handle, -2 null word or callback, -3/-4 internal error
+	 */
+	__declspec(dllexport) int __stdcall GetSuggestionsCallback(HunspellHandle* hunspell, BSTR word, ItemProc callback, void* context);
 	__declspec(dllexport) void __stdcall FreeItems(const char** items, int count);
-	__declspec(dllexport) int __stdcall AddWord(Hunspell* hunspell, BSTR word);
+	__declspec(dllexport) int __stdcall AddWord(HunspellHandle* hunspell, BSTR word);
+
+	/**
+	 * @brief Morphological analysis of a word (Hunspell::analyze).
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param word - word to analyze
+	 * @param count - pointer to the number of analyses returned
+	 * @return pointer to UTF-8 string array, one morphological description per item
+	 *
+	 * @post returned pointer must be freed with FreeItems.
+	 */
+	__declspec(dllexport) const char** __stdcall Analyze(HunspellHandle* hunspell, BSTR word, int* count);
+
+	/**
+	 * @brief Stems of a word (Hunspell::stem).
+	 *
+	 * @post returned pointer must be freed with FreeItems.
+	 */
+	__declspec(dllexport) const char** __stdcall Stem(HunspellHandle* hunspell, BSTR word, int* count);
+
+	/**
+	 * @brief Generate forms of word that carry the affixes of example (Hunspell::generate).
+	 *
+	 * @param word - word whose forms are generated
+	 * @param example - an inflected word whose affixes are copied
+	 * @post returned pointer must be freed with FreeItems.
+	 */
+	__declspec(dllexport) const char** __stdcall Generate(HunspellHandle* hunspell, BSTR word, BSTR example, int* count);
+
+	/**
+	 * @brief Stem every token of a text in one call, for search indexing.
+	 *
+	 * The text is split on whitespace and surrounding punctuation is trimmed
+	 * from each token. Every distinct token is stemmed once, and every distinct
+	 * stem is returned once, in order of first appearance. Tokens Hunspell
+	 * cannot stem are returned unchanged.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param text - document text
+	 * @param count - pointer to the number of stems returned
+	 * @return pointer to UTF-8 string array
+	 *
+	 * @post returned pointer must be freed with FreeItems.
+	 */
+	__declspec(dllexport) const char** __stdcall StemText(HunspellHandle* hunspell, BSTR text, int* count);
+
+	/**
+	 * @brief Check a text file without reading it into a VBA String.
+	 *
+	 * The file is memory-mapped and checked in place, so memory use does not
+	 * grow with the file size. UTF-8, UTF-16LE and UTF-16BE are recognised by
+	 * their byte order mark or, without one, by the pattern of zero bytes.
+	 * Tokens are split on whitespace as in GetMisspellings.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param path - file to check
+	 * @param ranges - receives 2 * count ints: byte offset from the start of
+	 *                 the file and byte length of each misspelling
+	 * @param count - receives the number of misspellings
+	 * @return detected encoding (0 UTF-8, 1 UTF-16LE, 2 UTF-16BE), or
+	 *         -1 null handle, -2 null argument, -3 file cannot be opened,
+	 *         -4 an offset does not fit in an int, -5/-6 internal error
+	 *
+	 * @post ranges must be freed with FreeRanges.
+	 */
+	__declspec(dllexport) int __stdcall CheckFile(HunspellHandle* hunspell, const char* path, int** ranges, int* count);
+	__declspec(dllexport) void __stdcall FreeRanges(int* ranges);
+
+	/**
+	 * @brief Check every text cell of a worksheet range in one call.
+	 *
+	 * Pass Range.Value as it is: a 2-D array of Variant (or String), or the
+	 * single value of a one-cell range. Cells that do not hold a string
+	 * (numbers, dates, errors, empty cells) are skipped; the others are
+	 * tokenized and checked as in GetMisspellings. The array is only read.
+	 *
+	 * In VBA: Declare PtrSafe Function CheckRange Lib "HunspellVBA.dll" (ByVal hunspell As LongPtr,
+	 * ByRef values As Variant, ByRef records As LongPtr, ByRef count As Long) As Long
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param values - the cell values
+	 * @param records - receives 4 * count ints, four per misspelling: row and column
+	 *                  as indexed in the array (1-based for Range.Value), then
+	 *                  offset (0-based) and length in the cell's text, in
+	 *                  UTF-16 characters; cells are visited column by column
+	 * @param count - receives the number of misspellings
+	 * @return number of misspellings, or -1 null handle, -2 null argument,
+	 *         -3 values is neither a string nor a 2-D array of Variant or
+	 *         String, -4 the array cannot be locked, -5/-6 internal error
+	 *
+	 * @post records must be freed with FreeRanges.
+	 */
+	__declspec(dllexport) int __stdcall CheckRange(HunspellHandle* hunspell, VARIANT* values, int** records, int* count);
+
+	/**
+	 * @brief Open a streaming session for text that arrives in chunks.
+	 *
+	 * Chunks may split words, UTF-8 sequences and UTF-16 code units anywhere;
+	 * incomplete tails are carried over to the next push. Memory stays
+	 * bounded however long the stream runs: at most 1024 results are queued
+	 * and tokens longer than 256 code units are skipped.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param encoding - 0 UTF-8, 1 UTF-16LE (VBA strings, use StrPtr/LenB), 2 UTF-16BE
+	 * @param stream - receives the stream handle
+	 * @return 0 on success, -1 null handle, -2 null stream pointer, -3 unknown encoding
+	 *
+	 * @post the stream must be closed with StreamClose before HunspellFree.
+	 */
+	__declspec(dllexport) int __stdcall StreamOpen(HunspellHandle* hunspell, int encoding, HunspellStream** stream);
+
+	/**
+	 * @brief Check the next chunk of the stream.
+	 *
+	 * @return number of bytes consumed. It is less than size only when the
+	 *         result queue is full: call StreamDrain and push the rest again.
+	 *         -1 null stream, -2 null data or negative size, -3/-4 internal
+	 *         error (Hunspell could not be loaded, for example).
+	 */
+	__declspec(dllexport) int __stdcall StreamPush(HunspellStream* stream, const void* data, int size);
+
+	/**
+	 * @brief Check the word at the end of the stream, after the last push.
+	 * @return 1 when done, 0 if the queue is full (drain and call again), -1 null stream,
+	 *         -2/-3 internal error
+	 */
+	__declspec(dllexport) int __stdcall StreamFinish(HunspellStream* stream);
+
+	/**
+	 * @brief Take queued misspellings off the stream.
+	 *
+	 * @param capacity - maximum number of results to take
+	 * @param offsets - receives the byte offset of each misspelling from the start of the stream, may be NULL
+	 * @param lengths - receives the byte length of each misspelling, may be NULL
+	 * @param words - receives a UTF-8 string array, may be NULL; free it with FreeItems
+	 * @return number of results taken, -1 null stream, -2 negative capacity,
+	 *         -3 out of memory for words; no result is taken then
+	 */
+	__declspec(dllexport) int __stdcall StreamDrain(HunspellStream* stream, int capacity, long long* offsets, int* lengths, const char*** words);
+
+	/**
+	 * @brief Deliver the stream's misspellings to callback instead of the queue.
+	 *
+	 * StreamPush then always consumes the whole chunk. Returning 0 from the
+	 * callback stops checking; later pushes are accepted and ignored.
+	 * Pass NULL to go back to the queue.
+	 *
+	 * @return 0 on success, -1 null stream
+	 */
+	__declspec(dllexport) int __stdcall StreamSetCallback(HunspellStream* stream, StreamMisspellingProc callback, void* context);
+
+	__declspec(dllexport) void __stdcall StreamClose(HunspellStream* stream);
+
+	/**
+	 * @brief Turn collection of runtime statistics on or off for a handle.
+	 *
+	 * Statistics are off after HunspellInit. While they are off the exports
+	 * do not read the clock or touch any counter.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param enable - non-zero to start collecting, zero to stop
+	 */
+	__declspec(dllexport) void __stdcall EnableStats(HunspellHandle* hunspell, int enable);
+
+	/**
+	 * @brief Write the handle's statistics as a JSON string.
+	 *
+	 * The JSON holds call counts per export, words checked, misses, UTF-8 bytes
+	 * converted, suggestions returned, correction table lookups, hits and hit
+	 * rate, tokens skipped by the token filter per rule, guardrail trips,
+	 * and latency histograms for spell and suggest.
+	 * Call with buffer = NULL to query the size first.
+	 *
+	 * @param hunspell - handle to Hunspell created by HunspellInit
+	 * @param buffer - receives the NUL-terminated JSON, may be NULL
+	 * @param bufferSize - size of buffer in bytes
+	 * @return length of the JSON without the terminator, or -1 for a null handle.
+	 *         Nothing is written when the buffer is too small.
+	 */
+	__declspec(dllexport) int __stdcall GetStats(HunspellHandle* hunspell, char* buffer, int bufferSize);
+	__declspec(dllexport) void __stdcall ResetStats(HunspellHandle* hunspell);
+
+	/**
+	 * @brief Start or stop recording trace spans.
+	 *
+	 * While tracing is on, every export records a span for the call and for its
+	 * phases (UTF-16 to UTF-8 conversion, tokenizing, spell, suggest, result
+	 * build) into a process-wide ring buffer. The newest spans are kept when the
+	 * buffer wraps. Tracing is off by default.
+	 *
+	 * @param enable - non-zero to start recording, zero to stop
+	 */
+	__declspec(dllexport) void __stdcall TraceEnable(int enable);
+
+	/**
+	 * @brief Write the recorded spans as Chrome trace-event JSON.
+	 *
+	 * The file can be opened in chrome://tracing or https://ui.perfetto.dev.
+	 *
+	 * @param path - file to create or overwrite
+	 * @return number of spans written, or -1 if the file could not be written
+	 */
+	__declspec(dllexport) int __stdcall TraceDump(const char* path);
+	__declspec(dllexport) void __stdcall TraceClear();
+
+	/**
+	 * @brief Set the minimum level of messages that are logged.
+	 *
+	 * Errors inside the exports are written to an in-memory ring buffer
+	 * instead of std::cerr. Each message site is rate limited, so a batch
+	 * of bad input costs a few atomic operations per call.
+	 *
+	 * @param level - 0 debug, 1 info, 2 warning (default), 3 error, 4 off
+	 */
+	__declspec(dllexport) void __stdcall LogSetLevel(int level);
+
+	/**
+	 * @brief Append log messages to a file from a background thread.
+	 *
+	 * @param path - file to append to, or NULL to stop the file sink.
+	 *               The sink must be stopped before the DLL is unloaded.
+	 * @return 0 on success, -1 if the file could not be opened
+	 */
+	__declspec(dllexport) int __stdcall LogSetFile(const char* path);
+
+	/**
+	 * @brief Write the messages held in the in-memory ring buffer to a file.
+	 * @return number of messages written, or -1 if the file could not be created
+	 */
+	__declspec(dllexport) int __stdcall LogDump(const char* path);
 }
@@ -0,0 +1,849 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Microbenchmarks for the spell checking engine.
+ *
+ * Every benchmark prints one JSON object per line (JSON Lines) so the output of
+ * two builds can be diffed or loaded into a spreadsheet:
+ *
+ *   {"benchmark":"check/correct","dictionary":"tk-TM","iterations":...,
+ *    "ns_per_op":...,"allocs_per_op":...,"alloc_bytes_per_op":...,"ops_per_sec":...,
+ *    "words_per_sec":...}
+ *
+ * Usage: HunspellVBABenchmarks [--filter <substring>] [--min-time-ms <ms>] [--out <file>]
+ *
+ * The benchmarks drive SpellEngine directly so they build and run on any
+ * platform; the exported functions only add a BSTR view on top of it.
+ *
+ * allocs_per_op counts operator new calls made by the engine and
+ * alloc_bytes_per_op the bytes they requested. Allocations made inside the
+ * hunspell library are not visible from here.
+ */
+#include "pch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../HunspellVBACore/AffixRules.h"
+#include "../HunspellVBACore/Automaton.h"
+#include "../HunspellVBACore/CorrectionTable.h"
+#include "../HunspellVBACore/DictionaryFile.h"
+#include "../HunspellVBACore/EditDistance.h"
+#include "../HunspellVBACore/Snapshot.h"
+#include "../HunspellVBACore/SpellEngine.h"
+#include "../HunspellVBACore/StreamChecker.h"
+#include "../HunspellVBACore/Trace.h"
+#include "../HunspellVBACore/Utf.h"
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#endif
+#if defined(_MSC_VER) || defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+static std::atomic<unsigned long long> g_allocations(0);
+static std::atomic<unsigned long long> g_allocatedBytes(0);
+
+void* operator new(size_t size) {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* p = malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+// This is the replacement of the delete that pairs with the new above, but
+// once both are inlined GCC sees new's pointer reach free() and warns.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+	free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete(void* p, size_t) noexcept {
+	operator delete(p);
+}
+
+// std::pmr's default resource allocates through the aligned forms.
+void* operator new(size_t size, std::align_val_t alignment) {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+#ifdef _MSC_VER
+	if (void* p = _aligned_malloc(size ? size : 1, (size_t)alignment)) {
+		return p;
+	}
+#else
+	void* p = nullptr;
+	if (posix_memalign(&p, std::max(sizeof(void*), (size_t)alignment), size ? size : 1) == 0) {
+		return p;
+	}
+#endif
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept {
+	operator delete(p, alignment);
+}
+
+namespace
+{
+	struct BenchOptions {
+		std::string filter;
+		long long minTimeMs = 300;
+		std::ostream* out = &std::cout;
+	};
+
+	/**
+	 * Memory of this process that no other process shares: the private commit on
+	 * Windows, the resident anonymous pages on Linux. Mapped read-only files such
+	 * as a dictionary segment are not included. Returns -1 where it cannot be read.
+	 */
+	long long PrivateMemoryBytes() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS_EX counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters))) {
+			return (long long)counters.PrivateUsage;
+		}
+		return -1;
+#else
+		FILE* file = fopen("/proc/self/status", "r");
+		if (file == nullptr) {
+			return -1;
+		}
+		long long kilobytes = -1;
+		char line[256];
+		while (fgets(line, sizeof(line), file) != nullptr) {
+			if (sscanf(line, "RssAnon: %lld", &kilobytes) == 1) {
+				break;
+			}
+		}
+		fclose(file);
+		return kilobytes < 0 ? -1 : kilobytes * 1024;
+#endif
+	}
+
+	/** Hands freed heap memory back to the system so PrivateMemoryBytes() deltas are not absorbed by it. */
+	void ReleaseFreeMemory() {
+#if defined(_MSC_VER)
+		_heapmin();
+#elif defined(__GLIBC__)
+		malloc_trim(0);
+#endif
+	}
+
+	struct Language {
+		const char* name;
+		const char* affixFilePath;
+		const char* dictionaryFilePath;
+		std::vector<std::u16string> correctWords;
+		std::vector<std::u16string> incorrectWords;
+		std::u16string sentence;
+		int sentenceWords;
+	};
+
+	std::u16string MakeParagraph(const std::u16string& sentence, int sentenceWords, int targetWords) {
+		std::u16string text;
+		for (int words = 0; words < targetWords; words += sentenceWords) {
+			if (!text.empty()) {
+				text += u' ';
+			}
+			text += sentence;
+		}
+		return text;
+	}
+
+	/**
+	 * Runs op until at least minTimeMs has elapsed (and at least minIterations
+	 * times), then prints one JSON line. wordsPerOp and bytesPerOp are used to
+	 * derive throughput and may be 0.
+	 */
+	template <typename Op>
+	void Run(const BenchOptions& options, const std::string& name, const char* dictionary,
+		long long minIterations, double wordsPerOp, double bytesPerOp, Op&& op) {
+		if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+			return;
+		}
+
+		typedef std::chrono::steady_clock clock;
+		const auto budget = std::chrono::milliseconds(options.minTimeMs);
+
+		op(); // warm-up
+
+		long long iterations = 0;
+		long long batch = 1;
+		unsigned long long allocations = g_allocations.load(std::memory_order_relaxed);
+		unsigned long long allocatedBytes = g_allocatedBytes.load(std::memory_order_relaxed);
+		auto start = clock::now();
+		auto elapsed = clock::duration::zero();
+		while (elapsed < budget || iterations < minIterations) {
+			for (long long i = 0; i < batch; ++i) {
+				op();
+			}
+			iterations += batch;
+			elapsed = clock::now() - start;
+			if (batch < (1 << 16)) {
+				batch *= 2;
+			}
+		}
+		allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+		allocatedBytes = g_allocatedBytes.load(std::memory_order_relaxed) - allocatedBytes;
+
+		double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+		double nsPerOp = ns / (double)iterations;
+		double opsPerSec = 1e9 / nsPerOp;
+
+		char line[512];
+		int length = snprintf(line, sizeof(line),
+			"{\"benchmark\":\"%s\",\"dictionary\":\"%s\",\"iterations\":%lld,"
+			"\"ns_per_op\":%.1f,\"allocs_per_op\":%.2f,\"alloc_bytes_per_op\":%.0f,\"ops_per_sec\":%.1f",
+			name.c_str(), dictionary, iterations, nsPerOp,
+			(double)allocations / (double)iterations, (double)allocatedBytes / (double)iterations, opsPerSec);
+		if (wordsPerOp > 0) {
+			length += snprintf(line + length, sizeof(line) - length, ",\"words_per_sec\":%.1f", opsPerSec * wordsPerOp);
+		}
+		if (bytesPerOp > 0) {
+			length += snprintf(line + length, sizeof(line) - length, ",\"bytes_per_sec\":%.1f", opsPerSec * bytesPerOp);
+		}
+		*options.out << line << "}\n";
+		options.out->flush();
+	}
+
+	void RunLanguage(const BenchOptions& options, const Language& language) {
+		Run(options, "init", language.name, 3, 0, 0, [&]() {
+			SpellEngine instance(language.affixFilePath, language.dictionaryFilePath);
+		});
+
+		// A process attaching to the shared segment another one built: Hunspell
+		// is not loaded until a word misses.
+		if (options.filter.empty() || std::string("init+segment").find(options.filter) != std::string::npos) {
+			auto start = std::chrono::steady_clock::now();
+			SpellEngine builder(language.affixFilePath, language.dictionaryFilePath, false);
+			long long words = builder.attachSharedDictionary(".");
+			if (words >= 0) {
+				double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				char line[256];
+				snprintf(line, sizeof(line), "{\"benchmark\":\"segment/build\",\"dictionary\":\"%s\",\"build_ms\":%.1f,\"words\":%lld}\n",
+					language.name, buildMs, words);
+				*options.out << line;
+				Run(options, "init+segment", language.name, 3, 0, 0, [&]() {
+					SpellEngine instance(language.affixFilePath, language.dictionaryFilePath, false);
+					instance.attachSharedDictionary(".");
+					instance.check(language.correctWords[0]);
+				});
+			}
+		}
+
+		// What one more process pays in private memory for a handle on the
+		// segment: after attaching, after the first word the automaton misses
+		// (which loads the handle's own Hunspell) and after the first suggest,
+		// next to a plain handle.
+		if (options.filter.empty() || std::string("segment/memory").find(options.filter) != std::string::npos) {
+			long long words = -1;
+			{
+				SpellEngine builder(language.affixFilePath, language.dictionaryFilePath, false);
+				words = builder.attachSharedDictionary(".");
+			}
+			ReleaseFreeMemory();
+			long long before = PrivateMemoryBytes();
+			SpellEngine instance(language.affixFilePath, language.dictionaryFilePath, false);
+			if (words >= 0 && before >= 0 && instance.attachSharedDictionary(".") >= 0) {
+				long long attached = PrivateMemoryBytes();
+				instance.check(language.incorrectWords[0]);
+				long long missed = PrivateMemoryBytes();
+				instance.suggest(language.incorrectWords[0]);
+				long long suggested = PrivateMemoryBytes();
+				SpellEngine plain(language.affixFilePath, language.dictionaryFilePath);
+				long long plainBytes = PrivateMemoryBytes() - suggested;
+				char line[320];
+				snprintf(line, sizeof(line), "{\"benchmark\":\"segment/memory\",\"dictionary\":\"%s\",\"attach_bytes\":%lld,"
+					"\"first_miss_bytes\":%lld,\"first_suggest_bytes\":%lld,\"plain_init_bytes\":%lld}\n",
+					language.name, attached - before, missed - before, suggested - before, plainBytes);
+				*options.out << line;
+			}
+		}
+
+		// The same dictionary read plain and from an hzip-compressed copy.
+		if (options.filter.empty() || std::string("dictionary/read+hz init+hz").find(options.filter) != std::string::npos) {
+			std::string compressedPath = std::string(language.name) + "-bench.dic";
+			if (WriteHzip(language.dictionaryFilePath, (compressedPath + ".hz").c_str(), nullptr)) {
+				std::ifstream plain(language.dictionaryFilePath, std::ios::binary | std::ios::ate);
+				std::ifstream packed(compressedPath + ".hz", std::ios::binary | std::ios::ate);
+				char line[256];
+				snprintf(line, sizeof(line), "{\"benchmark\":\"dictionary/size\",\"dictionary\":\"%s\",\"plain_bytes\":%lld,\"hz_bytes\":%lld}\n",
+					language.name, (long long)plain.tellg(), (long long)packed.tellg());
+				*options.out << line;
+
+				auto readAll = [](const char* path) {
+					DictionaryFile file;
+					std::string entry;
+					size_t lines = 0;
+					if (file.open(path)) {
+						while (file.getline(entry)) {
+							++lines;
+						}
+					}
+					return lines;
+				};
+				Run(options, "dictionary/read", language.name, 3, 0, 0, [&]() {
+					readAll(language.dictionaryFilePath);
+				});
+				Run(options, "dictionary/read+hz", language.name, 3, 0, 0, [&]() {
+					readAll(compressedPath.c_str());
+				});
+				Run(options, "init+hz", language.name, 3, 0, 0, [&]() {
+					SpellEngine instance(language.affixFilePath, compressedPath.c_str());
+				});
+			}
+		}
+
+		std::unique_ptr<SpellEngine> engine;
+		try {
+			engine.reset(new SpellEngine(language.affixFilePath, language.dictionaryFilePath));
+		}
+		catch (const std::exception&) {
+		}
+		if (!engine) {
+			std::cerr << "Skipping " << language.name << ": failed to load " << language.dictionaryFilePath << "\n";
+			return;
+		}
+
+		const std::vector<std::u16string>& correct = language.correctWords;
+		const std::vector<std::u16string>& incorrect = language.incorrectWords;
+
+		size_t next = 0;
+		Run(options, "check/correct", language.name, 1, 1, 0, [&]() {
+			engine->check(correct[next++ % correct.size()]);
+		});
+		Run(options, "check/incorrect", language.name, 1, 1, 0, [&]() {
+			engine->check(incorrect[next++ % incorrect.size()]);
+		});
+
+		// The UTF-16 to UTF-8 conversion every check starts with.
+		std::string converted;
+		Run(options, "convert/utf16", language.name, 1, 1, 0, [&]() {
+			ToUtf8(correct[next++ % correct.size()], converted);
+		});
+
+		// Sentence-initial words: Hunspell, and the automaton below, retry them in lowercase.
+		std::vector<std::u16string> capitalized = correct;
+		for (std::u16string& word : capitalized) {
+			if (word[0] >= u'a' && word[0] <= u'z') {
+				word[0] = (char16_t)(word[0] - (u'a' - u'A'));
+			}
+		}
+		Run(options, "check/capitalized", language.name, 1, 1, 0, [&]() {
+			engine->check(capitalized[next++ % capitalized.size()]);
+		});
+
+		engine->stats().enabled.store(true, std::memory_order_relaxed);
+		Run(options, "check/correct+stats", language.name, 1, 1, 0, [&]() {
+			engine->check(correct[next++ % correct.size()]);
+		});
+		engine->stats().enabled.store(false, std::memory_order_relaxed);
+
+		TraceBuffer::instance().setEnabled(true);
+		Run(options, "check/correct+trace", language.name, 1, 1, 0, [&]() {
+			engine->check(correct[next++ % correct.size()]);
+		});
+		TraceBuffer::instance().setEnabled(false);
+		TraceBuffer::instance().clear();
+
+		// Same checks answered by a walk of the full-form automaton. The forms are
+		// not verified against Hunspell here, so the build time is expansion plus
+		// minimisation only.
+		if (options.filter.empty() || std::string("check/correct+automaton").find(options.filter) != std::string::npos) {
+			auto start = std::chrono::steady_clock::now();
+			AffixRules rules;
+			std::vector<AffixRules::Entry> dictionary;
+			std::string forms;
+			std::vector<std::pair<size_t, size_t>> spans;
+			if (rules.load(language.affixFilePath) && rules.readDictionary(language.dictionaryFilePath, dictionary)) {
+				for (const AffixRules::Entry& entry : dictionary) {
+					rules.expand(entry, [&](std::u32string_view surface) {
+						size_t offset = forms.size();
+						AppendUtf8(surface, forms);
+						spans.emplace_back(offset, forms.size() - offset);
+					});
+				}
+			}
+			std::vector<std::string_view> words;
+			words.reserve(spans.size());
+			for (const auto& span : spans) {
+				words.emplace_back(forms.data() + span.first, span.second);
+			}
+			std::string automatonPath = std::string("automaton-") + language.name + ".bin";
+			AutomatonBuilder builder;
+			if (!words.empty() && builder.build(words, automatonPath.c_str()) && engine->loadAutomaton(automatonPath.c_str()) >= 0) {
+				double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				std::ifstream file(automatonPath, std::ios::binary | std::ios::ate);
+				char line[256];
+				snprintf(line, sizeof(line), "{\"benchmark\":\"automaton/build\",\"dictionary\":\"%s\",\"build_ms\":%.1f,"
+					"\"file_bytes\":%lld,\"words\":%llu}\n",
+					language.name, buildMs, (long long)file.tellg(), (unsigned long long)builder.wordCount());
+				*options.out << line;
+				Run(options, "check/correct+automaton", language.name, 1, 1, 0, [&]() {
+					engine->check(correct[next++ % correct.size()]);
+				});
+				Run(options, "check/incorrect+automaton", language.name, 1, 1, 0, [&]() {
+					engine->check(incorrect[next++ % incorrect.size()]);
+				});
+				Run(options, "check/capitalized+automaton", language.name, 1, 1, 0, [&]() {
+					engine->check(capitalized[next++ % capitalized.size()]);
+				});
+				engine->clearAutomaton();
+			}
+		}
+
+		const int paragraphSizes[] = { 10, 100, 1000 };
+		for (int size : paragraphSizes) {
+			std::u16string paragraph = MakeParagraph(language.sentence, language.sentenceWords, size);
+			int words = ((size + language.sentenceWords - 1) / language.sentenceWords) * language.sentenceWords;
+			Run(options, "misspellings/" + std::to_string(size) + "words", language.name, 1,
+				words, (double)paragraph.size() * sizeof(char16_t), [&]() {
+				size_t count = 0;
+				engine->forEachMisspelling(paragraph, [&](const Misspelling&) {
+					++count;
+					return true;
+				});
+			});
+			Run(options, "stream/" + std::to_string(size) + "words", language.name, 1,
+				words, (double)paragraph.size() * sizeof(char16_t), [&]() {
+				StreamChecker stream(*engine, TextEncoding::Utf16LE);
+				std::deque<StreamMisspelling> results;
+				const char* bytes = reinterpret_cast<const char*>(paragraph.data());
+				size_t size = paragraph.size() * sizeof(char16_t);
+				for (size_t position = 0; position < size;) {
+					position += stream.push(bytes + position, std::min<size_t>(4096, size - position));
+					stream.drain(results, StreamChecker::kDefaultMaxQueued);
+					results.clear();
+				}
+				while (!stream.finish()) {
+					stream.drain(results, StreamChecker::kDefaultMaxQueued);
+					results.clear();
+				}
+			});
+			Run(options, "stemText/" + std::to_string(size) + "words", language.name, 1,
+				words, (double)paragraph.size() * sizeof(char16_t), [&]() {
+				engine->stemText(paragraph);
+			});
+		}
+
+		// Spreadsheet-like text: the sentence between invoice numbers, dates,
+		// addresses and codes, checked with and without the token filter.
+		const std::u16string row = u"INV-2024-0117 12.03.2025 1,250.00 https://example.com/invoice info@example.com VAT EUR ";
+		const int rowWords = 7;
+		std::u16string sheet;
+		int sheetWords = 0;
+		while (sheetWords < 1000) {
+			sheet += row;
+			sheet += language.sentence;
+			sheet += u' ';
+			sheetWords += rowWords + language.sentenceWords;
+		}
+		for (unsigned rules : { 0u, TokenFilter::kAll }) {
+			TokenFilter filter;
+			filter.rules = rules;
+			filter.maxUppercaseLength = 4;
+			engine->setTokenFilter(filter);
+			Run(options, rules == 0 ? "misspellings/sheet" : "misspellings/sheet+filter", language.name, 1,
+				sheetWords, (double)sheet.size() * sizeof(char16_t), [&]() {
+				size_t count = 0;
+				engine->forEachMisspelling(sheet, [&](const Misspelling&) {
+					++count;
+					return true;
+				});
+			});
+		}
+		engine->setTokenFilter(TokenFilter());
+
+		// The same text as a two-column worksheet range, one cell at a time the
+		// way CheckRange walks it, collecting (row, column, offset, length).
+		std::vector<std::u16string> cells;
+		for (int words = 0; words < sheetWords; words += rowWords + language.sentenceWords) {
+			cells.push_back(row);
+			cells.push_back(language.sentence);
+		}
+		std::vector<int> records;
+		Run(options, "misspellings/cells", language.name, 1,
+			sheetWords, (double)sheet.size() * sizeof(char16_t), [&]() {
+			records.clear();
+			for (size_t i = 0; i < cells.size(); ++i) {
+				engine->forEachMisspelling(cells[i], [&](const Misspelling& misspelling) {
+					records.insert(records.end(), { (int)(i / 2) + 1, (int)(i % 2) + 1, (int)misspelling.offset, (int)misspelling.length });
+					return true;
+				});
+			}
+		});
+
+		Run(options, "suggest", language.name, 3, 1, 0, [&]() {
+			engine->suggest(incorrect[next++ % incorrect.size()]);
+		});
+
+		// A correction report over correct and misspelled words with up to 5
+		// suggestions each: CheckSpelling + GetSuggestions against CheckAndSuggest.
+		std::vector<std::u16string> report = correct;
+		report.insert(report.end(), incorrect.begin(), incorrect.end());
+		std::vector<std::string> corrections;
+		Run(options, "check+suggest", language.name, 3, 1, 0, [&]() {
+			const std::u16string& word = report[next++ % report.size()];
+			if (!engine->check(word)) {
+				corrections = engine->suggest(word);
+				if (corrections.size() > 5) {
+					corrections.resize(5);
+				}
+			}
+		});
+		Run(options, "checkAndSuggest", language.name, 3, 1, 0, [&]() {
+			engine->checkAndSuggest(report[next++ % report.size()], 5, corrections);
+		});
+
+		// A pasted blob with and without guardrails, and the cost of running
+		// every Hunspell suggest on a worker thread under a timeout.
+		std::u16string blob;
+		while (blob.size() < 300) {
+			blob += u"QmFzZTY0IGJsb2IgcGFzdGVkIGludG8gYSBjZWxs";
+		}
+		Run(options, "suggest/blob", language.name, 3, 1, 0, [&]() {
+			engine->suggest(blob);
+		});
+		Guardrails limits;
+		limits.maxCheckLength = 100;
+		limits.maxSuggestLength = 50;
+		engine->setGuardrails(limits);
+		Run(options, "suggest/blob+guardrails", language.name, 3, 1, 0, [&]() {
+			engine->suggest(blob);
+		});
+		limits = Guardrails();
+		limits.suggestTimeoutMs = 10000;
+		engine->setGuardrails(limits);
+		Run(options, "suggest+timeout", language.name, 3, 1, 0, [&]() {
+			engine->suggest(incorrect[next++ % incorrect.size()]);
+		});
+		engine->setGuardrails(Guardrails());
+
+		// Same words answered from a precomputed table instead of Hunspell.
+		CorrectionTable::Entries entries;
+		for (const std::u16string& word : incorrect) {
+			std::string key;
+			ToUtf8(word, key);
+			entries.emplace_back(key, engine->suggest(std::string_view(key)));
+		}
+		std::string tablePath = std::string("corrections-") + language.name + ".bin";
+		if (CorrectionTable::write(tablePath.c_str(), entries) && engine->loadCorrections(tablePath.c_str()) >= 0) {
+			Run(options, "suggest+corrections", language.name, 3, 1, 0, [&]() {
+				engine->suggest(incorrect[next++ % incorrect.size()]);
+			});
+			engine->clearCorrections();
+		}
+
+		// Symmetric-delete backend against Hunspell's own suggest above: build
+		// time and index memory go on one line, latency on the usual one.
+		if (options.filter.empty() || std::string("suggest+symspell").find(options.filter) != std::string::npos) {
+			auto start = std::chrono::steady_clock::now();
+			if (engine->useSymSpell(SuggestionRanking::Similarity, nullptr) == 0) {
+				double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				char line[256];
+				snprintf(line, sizeof(line), "{\"benchmark\":\"symspell/index\",\"dictionary\":\"%s\",\"build_ms\":%.1f,\"index_bytes\":%zu}\n",
+					language.name, buildMs, engine->suggestionBackendBytes());
+				*options.out << line;
+				Run(options, "suggest+symspell", language.name, 3, 1, 0, [&]() {
+					engine->suggest(incorrect[next++ % incorrect.size()]);
+				});
+				engine->useHunspellSuggest();
+			}
+		}
+
+		// Re-ranking kernels: one misspelling against 256 dictionary stems,
+		// with an exact distance (RankCandidates) and with the bound of 2 the
+		// suggestion backends use.
+		{
+			AffixRules rules;
+			std::vector<AffixRules::Entry> stems;
+			rules.load(language.affixFilePath);
+			rules.readDictionary(language.dictionaryFilePath, stems);
+			std::vector<std::u32string_view> candidates;
+			for (size_t i = 0; i < stems.size() && candidates.size() < 256; i += 97) {
+				candidates.push_back(stems[i].stem);
+			}
+			std::vector<std::u32string> queries;
+			for (const std::u16string& word : incorrect) {
+				std::string utf8;
+				ToUtf8(word, utf8);
+				queries.emplace_back();
+				DecodeUtf8(utf8, queries.back());
+			}
+			std::vector<int> distances(candidates.size());
+			for (int bound : { 64, 2 }) {
+				std::string suffix = bound == 64 ? "" : "/max2";
+				Run(options, "distance/scalar" + suffix, language.name, 1, (int)candidates.size(), 0, [&]() {
+					const std::u32string& query = queries[next++ % queries.size()];
+					for (size_t i = 0; i < candidates.size(); ++i) {
+						distances[i] = EditDistance(query, candidates[i], bound);
+					}
+				});
+				Run(options, "distance/bitparallel" + suffix, language.name, 1, (int)candidates.size(), 0, [&]() {
+					DistancePattern pattern(queries[next++ % queries.size()]);
+					for (size_t i = 0; i < candidates.size(); ++i) {
+						distances[i] = pattern.distance(candidates[i], bound);
+					}
+				});
+				if (DistancePattern::hasAvx2()) {
+					Run(options, "distance/avx2" + suffix, language.name, 1, (int)candidates.size(), 0, [&]() {
+						DistancePattern pattern(queries[next++ % queries.size()]);
+						pattern.distances(candidates.data(), candidates.size(), bound, distances.data());
+					});
+				}
+			}
+		}
+
+		Run(options, "suffixSuggest", language.name, 3, 1, 0, [&]() {
+			engine->suffixSuggest(correct[next++ % correct.size()]);
+		});
+		Run(options, "analyze", language.name, 1, 1, 0, [&]() {
+			engine->analyze(correct[next++ % correct.size()]);
+		});
+		Run(options, "stem", language.name, 1, 1, 0, [&]() {
+			engine->stem(correct[next++ % correct.size()]);
+		});
+
+		std::vector<std::u16string> added;
+		for (int i = 0; i < 1024; ++i) {
+			std::string word = "benchword" + std::to_string(i);
+			added.emplace_back(word.begin(), word.end());
+		}
+
+		// Reloading a handle with 1024 added words. "reload" is the whole
+		// rebuild; reload/blocking splits off the part the caller waits for:
+		// starting the job and installing its result.
+		if (options.filter.empty() || std::string("reload").find(options.filter) != std::string::npos) {
+			SpellEngine reloaded(language.affixFilePath, language.dictionaryFilePath);
+			for (const std::u16string& word : added) {
+				reloaded.addWord(word);
+			}
+			Run(options, "reload", language.name, 3, 0, 0, [&]() {
+				reloaded.reload();
+				reloaded.finishReload();
+			});
+
+			auto start = std::chrono::steady_clock::now();
+			reloaded.reload();
+			double startUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+			start = std::chrono::steady_clock::now();
+			reloaded.finishReload();
+			double installUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			char line[256];
+			snprintf(line, sizeof(line), "{\"benchmark\":\"reload/blocking\",\"dictionary\":\"%s\",\"start_us\":%.1f,\"install_us\":%.1f}\n",
+				language.name, startUs, installUs);
+			*options.out << line;
+		}
+
+		// Getting a handle with 1024 added words ready to answer its first
+		// check: set up the long way, or restored from a snapshot saved once.
+		// A misspelled first word or a suggestion backend brings back the
+		// costs the snapshot defers.
+		if (options.filter.empty() || std::string("init+replay snapshot/load+miss snapshot/load+symspell+suggest").find(options.filter) != std::string::npos) {
+			Run(options, "init+replay", language.name, 3, 0, 0, [&]() {
+				SpellEngine instance(language.affixFilePath, language.dictionaryFilePath);
+				for (const std::u16string& word : added) {
+					instance.addWord(word);
+				}
+				instance.check(language.correctWords[0]);
+			});
+
+			SpellEngine saved(language.affixFilePath, language.dictionaryFilePath);
+			for (const std::u16string& word : added) {
+				saved.addWord(word);
+			}
+			std::string snapshotPath = std::string(language.name) + "-bench.hvs";
+			auto start = std::chrono::steady_clock::now();
+			if (saved.saveSnapshot(snapshotPath.c_str()) == 0) {
+				double saveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				std::ifstream file(snapshotPath, std::ios::binary | std::ios::ate);
+				char line[256];
+				snprintf(line, sizeof(line), "{\"benchmark\":\"snapshot/save\",\"dictionary\":\"%s\",\"save_ms\":%.1f,\"bytes\":%lld}\n",
+					language.name, saveMs, (long long)file.tellg());
+				*options.out << line;
+				auto load = [&](const std::string& path, const std::u16string& word, bool suggest) {
+					EngineSnapshot snapshot;
+					if (ReadSnapshot(path.c_str(), snapshot) && SnapshotIsCurrent(snapshot)) {
+						SpellEngine instance(snapshot.sources[0].path.c_str(), snapshot.sources[1].path.c_str(), false);
+						instance.restoreSnapshot(path.c_str(), snapshot, nullptr);
+						instance.check(word);
+						if (suggest) {
+							instance.suggest(word);
+						}
+					}
+				};
+				Run(options, "snapshot/load", language.name, 3, 0, 0, [&]() {
+					load(snapshotPath, language.correctWords[0], false);
+				});
+				Run(options, "snapshot/load+miss", language.name, 3, 0, 0, [&]() {
+					load(snapshotPath, language.incorrectWords[0], false);
+				});
+
+				std::string backendPath = std::string(language.name) + "-bench-symspell.hvs";
+				if ((options.filter.empty() || std::string("snapshot/load+symspell+suggest").find(options.filter) != std::string::npos)
+					&& saved.useSymSpell(SuggestionRanking::Similarity, nullptr) == 0 && saved.saveSnapshot(backendPath.c_str()) == 0) {
+					Run(options, "snapshot/load+symspell", language.name, 3, 0, 0, [&]() {
+						load(backendPath, language.correctWords[0], false);
+					});
+					Run(options, "snapshot/load+symspell+suggest", language.name, 3, 0, 0, [&]() {
+						load(backendPath, language.incorrectWords[0], true);
+					});
+				}
+			}
+		}
+
+		Run(options, "addWord", language.name, 1, 1, 0, [&]() {
+			engine->addWord(added[next++ % added.size()]);
+		});
+
+		if (strcmp(language.name, "tk-TM") == 0) {
+			Run(options, "addDictionary", language.name, 3, 0, 0, [&]() {
+				engine->addDictionary("lang/tk-TM_addition.dic");
+			});
+		}
+
+		// Trigram index before and after the dictionary doubles in size: every
+		// root is added again with its first letter doubled, which puts a near
+		// miss next to each real candidate. The index is updated in place by
+		// addDictionary; Hunspell's suggest is measured on the grown dictionary
+		// for comparison.
+		if (options.filter.empty() || std::string("suggest+trigram").find(options.filter) != std::string::npos) {
+			auto start = std::chrono::steady_clock::now();
+			if (engine->useTrigramIndex() == 0) {
+				double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				char line[256];
+				snprintf(line, sizeof(line), "{\"benchmark\":\"trigram/index\",\"dictionary\":\"%s\",\"build_ms\":%.1f,\"index_bytes\":%zu}\n",
+					language.name, buildMs, engine->suggestionBackendBytes());
+				*options.out << line;
+				Run(options, "suggest+trigram", language.name, 3, 1, 0, [&]() {
+					engine->suggest(incorrect[next++ % incorrect.size()]);
+				});
+
+				std::ifstream roots(language.dictionaryFilePath, std::ios::binary);
+				std::string growPath = std::string("grow-") + language.name + ".dic";
+				std::ofstream grown(growPath, std::ios::binary);
+				std::string root;
+				std::getline(roots, root);
+				grown << root << "\n";
+				while (std::getline(roots, root)) {
+					if (!root.empty() && (unsigned char)root[0] < 0x80) {
+						root.insert(root.begin(), root[0]);
+					}
+					grown << root << "\n";
+				}
+				grown.close();
+				if (engine->addDictionary(growPath.c_str()) == 0) {
+					Run(options, "suggest+trigram/grown", language.name, 3, 1, 0, [&]() {
+						engine->suggest(incorrect[next++ % incorrect.size()]);
+					});
+					engine->useHunspellSuggest();
+					Run(options, "suggest/grown", language.name, 3, 1, 0, [&]() {
+						engine->suggest(incorrect[next++ % incorrect.size()]);
+					});
+				}
+				engine->useHunspellSuggest();
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	BenchOptions options;
+	std::ofstream file;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc) {
+			options.filter = argv[++i];
+		}
+		else if (arg == "--min-time-ms" && i + 1 < argc) {
+			options.minTimeMs = atoll(argv[++i]);
+		}
+		else if (arg == "--out" && i + 1 < argc) {
+			file.open(argv[++i]);
+			if (!file) {
+				std::cerr << "Cannot open " << argv[i] << " for writing\n";
+				return 1;
+			}
+			options.out = &file;
+		}
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--min-time-ms <ms>] [--out <file>]\n";
+			return 1;
+		}
+	}
+
+	Language turkmen = {
+		"tk-TM", "lang/tk-TM.aff", "lang/tk-TM.dic",
+		{ u"şagal", u"kitap", u"mekdep", u"okuwçy", u"gowy", u"hemme" },
+		{ u"zanar", u"bazal", u"zatd", u"kitapb" },
+		u"Adamlar bazarak gitdiler. Hemme zatd gowy bolarmyka?", 7
+	};
+	Language english = {
+		"en-US", "lang/en-US.aff", "lang/en-US.dic",
+		{ u"house", u"running", u"beautiful", u"receive" },
+		{ u"recieve", u"definately", u"houze", u"beautifull" },
+		u"The quick brown fox jumps over the lazy dog while recieving mesages.", 12
+	};
+
+	RunLanguage(options, turkmen);
+	RunLanguage(options, english);
+	return 0;
+}
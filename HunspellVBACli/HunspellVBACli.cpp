@@ -0,0 +1,641 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Command-line batch checker built on SpellEngine.
+ *
+ * Usage:
+ *   HunspellVBACli check --aff <file> --dic <file> [--dic <file>...]
+ *                        [--threads <n>] [--ext <.txt,.md,...>] [--out <file>] <path>...
+ *   HunspellVBACli build-corrections --aff <file> --dic <file> [--dic <file>...]
+ *                        [--threads <n>] [--ext <...>] [--min-count <n>] [--max-entries <n>]
+ *                        [--max-suggestions <n>] --out <table> <corpus>...
+ *   HunspellVBACli build-automaton --aff <file> --dic <file> [--dic <file>...]
+ *                        [--threads <n>] [--no-verify] --out <automaton>
+ *   HunspellVBACli compress [--key <key>] --out <file.hz> <file>
+ *
+ * Dictionaries may be hzip-compressed: a name whose file is missing is read
+ * from the same name + ".hz", and --key gives the key of encrypted files.
+ *
+ * Every path may be a file or a directory; directories are walked
+ * recursively and, when --ext is given, only files with one of the listed
+ * extensions are checked. Input is read as UTF-8 (a BOM is skipped).
+ *
+ * Each misspelling is written as one JSON object per line:
+ *
+ *   {"file":"docs/a.txt","line":3,"column":14,"offset":97,"word":"recieve"}
+ *
+ * line and column are 1-based, column counts code points and offset is the
+ * byte offset from the start of the file. A summary with words/sec is printed
+ * to stderr when the run finishes.
+ *
+ * Hunspell instances are not thread-safe, so every worker thread loads its
+ * own SpellEngine and takes the next file from a shared counter. Files are
+ * handed out largest first to keep the workers evenly loaded.
+ *
+ * Exit code: 0 if no misspellings were found, 1 if some were, 2 on errors.
+ *
+ * build-corrections reads a corpus of observed misspellings (any text, split
+ * on whitespace), runs Hunspell's suggest once for every distinct token that
+ * is misspelled and writes the results as a CorrectionTable for
+ * LoadCorrections. The most frequent typos are kept first when --max-entries
+ * limits the table.
+ *
+ * build-automaton expands every dictionary entry into its surface forms with
+ * AffixRules, keeps the forms Hunspell accepts (skip that pass with
+ * --no-verify) and writes them as a minimal automaton for LoadAutomaton.
+ */
+#include "pch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../HunspellVBACore/CorrectionTable.h"
+#include "../HunspellVBACore/DictionaryFile.h"
+#include "../HunspellVBACore/DictionarySegment.h"
+#include "../HunspellVBACore/SpellEngine.h"
+#include "../HunspellVBACore/Tokenizer.h"
+#include "../HunspellVBACore/Utf.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	struct Options {
+		std::string affixFilePath;
+		std::vector<std::string> dictionaryFilePaths;
+		std::vector<std::string> extensions;
+		std::vector<std::string> paths;
+		std::string outFilePath;
+		unsigned threads = 0;
+		unsigned long long minCount = 1;
+		size_t maxEntries = 0;
+		size_t maxSuggestions = 0;
+		bool verify = true;
+		std::string key;
+	};
+
+	struct InputFile {
+		fs::path path;
+		uintmax_t size;
+	};
+
+	struct Totals {
+		std::atomic<uint64_t> files{ 0 };
+		std::atomic<uint64_t> bytes{ 0 };
+		std::atomic<uint64_t> words{ 0 };
+		std::atomic<uint64_t> misspellings{ 0 };
+		std::atomic<bool> failed{ false };
+	};
+
+	void AppendJsonString(std::string& out, std::string_view text) {
+		out += '"';
+		for (char c : text) {
+			switch (c) {
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if ((unsigned char)c < 0x20) {
+					char escaped[8];
+					snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+					out += escaped;
+				}
+				else {
+					out += c;
+				}
+			}
+		}
+		out += '"';
+	}
+
+	/** @return number of code points in UTF-8 text (continuation bytes are skipped). */
+	size_t CountCodePoints(std::string_view text) {
+		size_t count = 0;
+		for (char c : text) {
+			if (((unsigned char)c & 0xC0) != 0x80) {
+				++count;
+			}
+		}
+		return count;
+	}
+
+	bool HasExtension(const fs::path& path, const std::vector<std::string>& extensions) {
+		if (extensions.empty()) {
+			return true;
+		}
+		std::string extension = path.extension().u8string();
+		std::transform(extension.begin(), extension.end(), extension.begin(),
+			[](char c) { return (char)((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c); });
+		return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
+	}
+
+	bool CollectFiles(const Options& options, std::vector<InputFile>& files) {
+		std::error_code error;
+		for (const std::string& argument : options.paths) {
+			fs::path path = fs::u8path(argument);
+			if (fs::is_regular_file(path, error)) {
+				files.push_back({ path, fs::file_size(path, error) });
+				continue;
+			}
+			if (!fs::is_directory(path, error)) {
+				std::cerr << "No such file or directory: " << argument << "\n";
+				return false;
+			}
+			for (fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, error), end;
+				it != end; it.increment(error)) {
+				if (error) {
+					break;
+				}
+				if (it->is_regular_file(error) && HasExtension(it->path(), options.extensions)) {
+					files.push_back({ it->path(), it->file_size(error) });
+				}
+			}
+		}
+		std::sort(files.begin(), files.end(),
+			[](const InputFile& a, const InputFile& b) { return a.size > b.size; });
+		return true;
+	}
+
+	bool ReadFile(const fs::path& path, std::string& content) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		file.seekg(0, std::ios::end);
+		std::streamoff size = file.tellg();
+		file.seekg(0, std::ios::beg);
+		content.resize(size > 0 ? (size_t)size : 0);
+		file.read(&content[0], (std::streamsize)content.size());
+		content.resize((size_t)file.gcount());
+		return true;
+	}
+
+	/** Append one JSON line per misspelling in content to out. */
+	void CheckContent(SpellEngine& engine, const std::string& fileName, std::string_view content, std::string& out) {
+		size_t start = 0;
+		if (content.substr(0, 3) == "\xEF\xBB\xBF") {
+			start = 3;
+		}
+
+		size_t lineNumber = 0;
+		while (start < content.size()) {
+			size_t end = content.find('\n', start);
+			if (end == std::string_view::npos) {
+				end = content.size();
+			}
+			std::string_view line = content.substr(start, end - start);
+			++lineNumber;
+
+			engine.forEachMisspelling(line, [&](const Misspelling& misspelling) {
+				out += "{\"file\":";
+				AppendJsonString(out, fileName);
+				out += ",\"line\":" + std::to_string(lineNumber);
+				out += ",\"column\":" + std::to_string(CountCodePoints(line.substr(0, (size_t)misspelling.offset)) + 1);
+				out += ",\"offset\":" + std::to_string(start + misspelling.offset);
+				out += ",\"word\":";
+				AppendJsonString(out, misspelling.word);
+				out += "}\n";
+				return true;
+			});
+			start = end + 1;
+		}
+	}
+
+	std::unique_ptr<SpellEngine> LoadEngine(const Options& options) {
+		const char* key = options.key.empty() ? nullptr : options.key.c_str();
+		std::unique_ptr<SpellEngine> engine(
+			new SpellEngine(options.affixFilePath.c_str(), options.dictionaryFilePaths[0].c_str(), true, key));
+		for (size_t i = 1; i < options.dictionaryFilePaths.size(); ++i) {
+			engine->addDictionary(options.dictionaryFilePaths[i].c_str(), key);
+		}
+		engine->stats().enabled.store(true, std::memory_order_relaxed);
+		return engine;
+	}
+
+	void CheckWorker(const Options& options, const std::vector<InputFile>& files,
+		std::atomic<size_t>& nextFile, std::ostream& out, std::mutex& outMutex, Totals& totals) {
+		std::unique_ptr<SpellEngine> engine;
+		try {
+			engine = LoadEngine(options);
+		}
+		catch (const std::exception& ex) {
+			std::lock_guard<std::mutex> lock(outMutex);
+			std::cerr << "Failed to load dictionary: " << ex.what() << "\n";
+			totals.failed.store(true);
+			return;
+		}
+
+		std::string content;
+		std::string results;
+		for (size_t index = nextFile.fetch_add(1); index < files.size(); index = nextFile.fetch_add(1)) {
+			const fs::path& path = files[index].path;
+			if (!ReadFile(path, content)) {
+				std::lock_guard<std::mutex> lock(outMutex);
+				std::cerr << "Cannot read " << path.u8string() << "\n";
+				totals.failed.store(true);
+				continue;
+			}
+
+			results.clear();
+			CheckContent(*engine, path.generic_u8string(), content, results);
+			totals.files.fetch_add(1, std::memory_order_relaxed);
+			totals.bytes.fetch_add(content.size(), std::memory_order_relaxed);
+
+			if (!results.empty()) {
+				std::lock_guard<std::mutex> lock(outMutex);
+				out << results;
+			}
+		}
+
+		totals.words.fetch_add(engine->stats().wordsChecked.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		totals.misspellings.fetch_add(engine->stats().misses.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	bool DictionariesExist(const Options& options) {
+		for (const std::string& path : options.dictionaryFilePaths) {
+			if (DictionaryFile::resolve(path.c_str()).empty()) {
+				std::cerr << "Dictionary not found: " << path << "\n";
+				return false;
+			}
+		}
+		if (DictionaryFile::resolve(options.affixFilePath.c_str()).empty()) {
+			std::cerr << "Affix file not found: " << options.affixFilePath << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	unsigned ThreadCount(const Options& options, size_t jobs) {
+		unsigned threads = options.threads;
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		return (unsigned)std::min<size_t>(threads, std::max<size_t>(jobs, 1));
+	}
+
+	int RunCheck(const Options& options) {
+		if (!DictionariesExist(options)) {
+			return 2;
+		}
+
+		std::vector<InputFile> files;
+		if (!CollectFiles(options, files)) {
+			return 2;
+		}
+
+		std::ofstream outFile;
+		std::ostream* out = &std::cout;
+		if (!options.outFilePath.empty()) {
+			outFile.open(fs::u8path(options.outFilePath), std::ios::binary);
+			if (!outFile) {
+				std::cerr << "Cannot open " << options.outFilePath << " for writing\n";
+				return 2;
+			}
+			out = &outFile;
+		}
+
+		unsigned threads = ThreadCount(options, files.size());
+
+		Totals totals;
+		std::atomic<size_t> nextFile(0);
+		std::mutex outMutex;
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::thread> workers;
+		for (unsigned i = 0; i < threads; ++i) {
+			workers.emplace_back(CheckWorker, std::cref(options), std::cref(files), std::ref(nextFile),
+				std::ref(*out), std::ref(outMutex), std::ref(totals));
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		out->flush();
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		uint64_t words = totals.words.load();
+		char summary[256];
+		snprintf(summary, sizeof(summary),
+			"{\"files\":%llu,\"bytes\":%llu,\"words\":%llu,\"misspellings\":%llu,"
+			"\"threads\":%u,\"seconds\":%.3f,\"words_per_sec\":%.1f}",
+			(unsigned long long)totals.files.load(), (unsigned long long)totals.bytes.load(),
+			(unsigned long long)words, (unsigned long long)totals.misspellings.load(),
+			threads, seconds, seconds > 0 ? (double)words / seconds : 0.0);
+		std::cerr << summary << "\n";
+
+		if (totals.failed.load()) {
+			return 2;
+		}
+		return totals.misspellings.load() != 0 ? 1 : 0;
+	}
+
+	struct Typo {
+		std::string word;
+		unsigned long long count;
+		bool misspelled;
+		std::vector<std::string> suggestions;
+	};
+
+	void SuggestWorker(const Options& options, std::vector<Typo>& typos, std::atomic<size_t>& next,
+		std::mutex& errorMutex, std::atomic<bool>& failed) {
+		std::unique_ptr<SpellEngine> engine;
+		try {
+			engine = LoadEngine(options);
+		}
+		catch (const std::exception& ex) {
+			std::lock_guard<std::mutex> lock(errorMutex);
+			std::cerr << "Failed to load dictionary: " << ex.what() << "\n";
+			failed.store(true);
+			return;
+		}
+
+		for (size_t index = next.fetch_add(1); index < typos.size(); index = next.fetch_add(1)) {
+			Typo& typo = typos[index];
+			typo.misspelled = !engine->check(std::string_view(typo.word));
+			if (!typo.misspelled) {
+				continue;
+			}
+			typo.suggestions = engine->suggest(std::string_view(typo.word));
+			if (options.maxSuggestions != 0 && typo.suggestions.size() > options.maxSuggestions) {
+				typo.suggestions.resize(options.maxSuggestions);
+			}
+		}
+	}
+
+	int RunBuildCorrections(const Options& options) {
+		if (!DictionariesExist(options)) {
+			return 2;
+		}
+
+		std::vector<InputFile> files;
+		if (!CollectFiles(options, files)) {
+			return 2;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		std::unordered_map<std::string, unsigned long long> counts;
+		unsigned long long tokens = 0;
+		std::string content;
+		for (const InputFile& file : files) {
+			if (!ReadFile(file.path, content)) {
+				std::cerr << "Cannot read " << file.path.u8string() << "\n";
+				return 2;
+			}
+			std::string_view text(content);
+			if (text.substr(0, 3) == "\xEF\xBB\xBF") {
+				text.remove_prefix(3);
+			}
+			WhitespaceTokenizer<char> tokenizer(text);
+			std::string_view token;
+			size_t offset;
+			while (tokenizer.next(token, offset)) {
+				++counts[std::string(token)];
+				++tokens;
+			}
+		}
+
+		std::vector<Typo> typos;
+		for (auto& entry : counts) {
+			if (entry.second >= options.minCount) {
+				typos.push_back({ entry.first, entry.second, false, {} });
+			}
+		}
+		std::sort(typos.begin(), typos.end(), [](const Typo& a, const Typo& b) {
+			return a.count != b.count ? a.count > b.count : a.word < b.word;
+		});
+
+		unsigned threads = ThreadCount(options, typos.size());
+		std::atomic<size_t> next(0);
+		std::atomic<bool> failed(false);
+		std::mutex errorMutex;
+		std::vector<std::thread> workers;
+		for (unsigned i = 0; i < threads; ++i) {
+			workers.emplace_back(SuggestWorker, std::cref(options), std::ref(typos), std::ref(next),
+				std::ref(errorMutex), std::ref(failed));
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		if (failed.load()) {
+			return 2;
+		}
+
+		CorrectionTable::Entries entries;
+		for (Typo& typo : typos) {
+			if (options.maxEntries != 0 && entries.size() >= options.maxEntries) {
+				break;
+			}
+			if (typo.misspelled && !typo.suggestions.empty()) {
+				entries.emplace_back(std::move(typo.word), std::move(typo.suggestions));
+			}
+		}
+
+		if (!CorrectionTable::write(options.outFilePath.c_str(), entries)) {
+			std::cerr << "Cannot write " << options.outFilePath << "\n";
+			return 2;
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		char summary[256];
+		snprintf(summary, sizeof(summary),
+			"{\"tokens\":%llu,\"distinct\":%llu,\"entries\":%llu,\"threads\":%u,\"seconds\":%.3f}",
+			tokens, (unsigned long long)counts.size(), (unsigned long long)entries.size(), threads, seconds);
+		std::cerr << summary << "\n";
+		return 0;
+	}
+
+	int RunBuildAutomaton(const Options& options) {
+		if (!DictionariesExist(options)) {
+			return 2;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		AutomatonBuildSummary built;
+		std::vector<std::string> keys(options.dictionaryFilePaths.size(), options.key);
+		int result = BuildDictionaryAutomaton(options.affixFilePath, options.dictionaryFilePaths, keys, options.threads,
+			options.verify, options.outFilePath.c_str(), built);
+		switch (result) {
+		case 0:
+			break;
+		case -1:
+			std::cerr << "Cannot read affix file (or unsupported SET): " << options.affixFilePath << "\n";
+			return 2;
+		case -2:
+			std::cerr << "Cannot read dictionary files\n";
+			return 2;
+		case -3:
+			std::cerr << "Failed to load dictionary\n";
+			return 2;
+		default:
+			std::cerr << "Cannot write " << options.outFilePath << "\n";
+			return 2;
+		}
+
+		std::error_code error;
+		unsigned long long fileBytes = (unsigned long long)fs::file_size(fs::u8path(options.outFilePath), error);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		char summary[320];
+		snprintf(summary, sizeof(summary),
+			"{\"entries\":%llu,\"forms\":%llu,\"rejected\":%llu,\"words\":%llu,\"states\":%llu,"
+			"\"arcs\":%llu,\"file_bytes\":%llu,\"threads\":%u,\"seconds\":%.3f}",
+			(unsigned long long)built.entries, (unsigned long long)built.forms, (unsigned long long)built.rejected,
+			(unsigned long long)built.words, (unsigned long long)built.states, (unsigned long long)built.arcs,
+			fileBytes, built.threads, seconds);
+		std::cerr << summary << "\n";
+		return 0;
+	}
+
+	int RunCompress(const Options& options) {
+		const std::string& input = options.paths[0];
+		auto start = std::chrono::steady_clock::now();
+		if (!WriteHzip(input.c_str(), options.outFilePath.c_str(), options.key.empty() ? nullptr : options.key.c_str())) {
+			std::cerr << "Cannot compress " << input << " to " << options.outFilePath << "\n";
+			return 2;
+		}
+
+		std::error_code error;
+		unsigned long long inputBytes = (unsigned long long)fs::file_size(fs::u8path(input), error);
+		unsigned long long outputBytes = (unsigned long long)fs::file_size(fs::u8path(options.outFilePath), error);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		char summary[256];
+		snprintf(summary, sizeof(summary), "{\"input_bytes\":%llu,\"output_bytes\":%llu,\"encrypted\":%s,\"seconds\":%.3f}",
+			inputBytes, outputBytes, options.key.empty() ? "false" : "true", seconds);
+		std::cerr << summary << "\n";
+		return 0;
+	}
+
+	void SplitExtensions(const std::string& list, std::vector<std::string>& extensions) {
+		size_t start = 0;
+		while (start <= list.size()) {
+			size_t end = list.find(',', start);
+			if (end == std::string::npos) {
+				end = list.size();
+			}
+			std::string extension = list.substr(start, end - start);
+			if (!extension.empty()) {
+				if (extension[0] != '.') {
+					extension.insert(extension.begin(), '.');
+				}
+				std::transform(extension.begin(), extension.end(), extension.begin(),
+					[](char c) { return (char)((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c); });
+				extensions.push_back(extension);
+			}
+			start = end + 1;
+		}
+	}
+
+	int Usage(const char* program) {
+		std::cerr << "Usage: " << program << " check --aff <file> --dic <file> [--dic <file>...]\n"
+			"           [--threads <n>] [--ext <.txt,.md,...>] [--out <file>] <path>...\n"
+			"       " << program << " build-corrections --aff <file> --dic <file> [--dic <file>...]\n"
+			"           [--threads <n>] [--ext <...>] [--min-count <n>] [--max-entries <n>]\n"
+			"           [--max-suggestions <n>] --out <table> <corpus>...\n"
+			"       " << program << " build-automaton --aff <file> --dic <file> [--dic <file>...]\n"
+			"           [--threads <n>] [--no-verify] --out <automaton>\n"
+			"       " << program << " compress [--key <key>] --out <file.hz> <file>\n";
+		return 2;
+	}
+
+	bool ParseOptions(int argc, char** argv, Options& options) {
+		for (int i = 2; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--aff" && i + 1 < argc) {
+				options.affixFilePath = argv[++i];
+			}
+			else if (arg == "--dic" && i + 1 < argc) {
+				options.dictionaryFilePaths.push_back(argv[++i]);
+			}
+			else if (arg == "--threads" && i + 1 < argc) {
+				options.threads = (unsigned)std::max(0, atoi(argv[++i]));
+			}
+			else if (arg == "--ext" && i + 1 < argc) {
+				SplitExtensions(argv[++i], options.extensions);
+			}
+			else if (arg == "--out" && i + 1 < argc) {
+				options.outFilePath = argv[++i];
+			}
+			else if (arg == "--min-count" && i + 1 < argc) {
+				options.minCount = strtoull(argv[++i], nullptr, 10);
+			}
+			else if (arg == "--max-entries" && i + 1 < argc) {
+				options.maxEntries = (size_t)strtoull(argv[++i], nullptr, 10);
+			}
+			else if (arg == "--max-suggestions" && i + 1 < argc) {
+				options.maxSuggestions = (size_t)strtoull(argv[++i], nullptr, 10);
+			}
+			else if (arg == "--no-verify") {
+				options.verify = false;
+			}
+			else if (arg == "--key" && i + 1 < argc) {
+				options.key = argv[++i];
+			}
+			else if (!arg.empty() && arg[0] == '-') {
+				return false;
+			}
+			else {
+				options.paths.push_back(arg);
+			}
+		}
+		return true;
+	}
+
+	bool HasDictionary(const Options& options) {
+		return !options.affixFilePath.empty() && !options.dictionaryFilePaths.empty();
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string command = argc >= 2 ? argv[1] : "";
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		return Usage(argv[0]);
+	}
+	if (command == "check" && HasDictionary(options) && !options.paths.empty()) {
+		return RunCheck(options);
+	}
+	if (command == "build-corrections" && HasDictionary(options) && !options.paths.empty()
+		&& !options.outFilePath.empty()) {
+		return RunBuildCorrections(options);
+	}
+	if (command == "build-automaton" && HasDictionary(options) && options.paths.empty()
+		&& !options.outFilePath.empty()) {
+		return RunBuildAutomaton(options);
+	}
+	if (command == "compress" && options.paths.size() == 1 && !options.outFilePath.empty()) {
+		return RunCompress(options);
+	}
+	return Usage(argv[0]);
+}
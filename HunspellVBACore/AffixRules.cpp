@@ -0,0 +1,426 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AffixRules.h"
+#include <algorithm>
+#include "DictionaryFile.h"
+#include "Utf.h"
+
+namespace
+{
+	bool IsSpace(char32_t c) {
+		return c == U' ' || c == U'\t' || c == U'\r' || c == U'\n';
+	}
+
+	/** Split a line on spaces and tabs. */
+	std::vector<std::u32string_view> SplitFields(std::u32string_view line) {
+		std::vector<std::u32string_view> fields;
+		size_t i = 0;
+		while (i < line.size()) {
+			while (i < line.size() && IsSpace(line[i])) {
+				++i;
+			}
+			size_t start = i;
+			while (i < line.size() && !IsSpace(line[i])) {
+				++i;
+			}
+			if (i > start) {
+				fields.push_back(line.substr(start, i - start));
+			}
+		}
+		return fields;
+	}
+
+	bool Equals(std::u32string_view text, const char* ascii) {
+		size_t i = 0;
+		for (; ascii[i] != '\0'; ++i) {
+			if (i >= text.size() || text[i] != (char32_t)(unsigned char)ascii[i]) {
+				return false;
+			}
+		}
+		return i == text.size();
+	}
+
+	std::vector<AffixRules::ConditionChar> ParseCondition(std::u32string_view text) {
+		std::vector<AffixRules::ConditionChar> condition;
+		for (size_t i = 0; i < text.size(); ++i) {
+			AffixRules::ConditionChar position;
+			if (text[i] == U'.') {
+				position.any = true;
+			}
+			else if (text[i] == U'[') {
+				size_t end = text.find(U']', i);
+				if (end == std::u32string_view::npos) {
+					end = text.size();
+				}
+				size_t first = i + 1;
+				if (first < end && text[first] == U'^') {
+					position.negate = true;
+					++first;
+				}
+				position.chars.assign(text.substr(first, end - first));
+				i = end;
+			}
+			else {
+				position.chars.assign(1, text[i]);
+			}
+			condition.push_back(std::move(position));
+		}
+		if (condition.size() == 1 && condition[0].any) {
+			condition.clear();
+		}
+		return condition;
+	}
+
+	bool MatchesAt(const std::vector<AffixRules::ConditionChar>& condition, std::u32string_view text, size_t start) {
+		for (size_t i = 0; i < condition.size(); ++i) {
+			const AffixRules::ConditionChar& position = condition[i];
+			if (position.any) {
+				continue;
+			}
+			bool found = position.chars.find(text[start + i]) != std::u32string::npos;
+			if (found == position.negate) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ReadLines(const char* path, const char* key, std::vector<std::string>& lines) {
+		DictionaryFile file;
+		if (!file.open(path, key)) {
+			return false;
+		}
+		std::string line;
+		while (file.getline(line)) {
+			if (lines.empty() && line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+				line.erase(0, 3);
+			}
+			lines.push_back(std::move(line));
+		}
+		return true;
+	}
+}
+
+bool AffixRules::decode(std::string_view bytes, std::u32string& out) const {
+	if (utf8) {
+		DecodeUtf8(bytes, out);
+	}
+	else {
+		out.assign(bytes.begin(), bytes.end());
+		for (char32_t& c : out) {
+			c &= 0xFF;
+		}
+	}
+	return true;
+}
+
+uint32_t AffixRules::parseFlag(std::u32string_view text) const {
+	std::vector<uint32_t> flags;
+	parseFlags(text, flags);
+	return flags.empty() ? 0 : flags[0];
+}
+
+void AffixRules::parseFlags(std::u32string_view text, std::vector<uint32_t>& flags) const {
+	switch (flagMode) {
+	case FlagMode::Num: {
+		uint32_t value = 0;
+		bool digits = false;
+		for (char32_t c : text) {
+			if (c >= U'0' && c <= U'9') {
+				value = value * 10 + (c - U'0');
+				digits = true;
+			}
+			else if (c == U',') {
+				if (digits) {
+					flags.push_back(value);
+				}
+				value = 0;
+				digits = false;
+			}
+			else {
+				break;
+			}
+		}
+		if (digits) {
+			flags.push_back(value);
+		}
+		break;
+	}
+	case FlagMode::Long:
+		for (size_t i = 0; i + 1 < text.size(); i += 2) {
+			flags.push_back(((uint32_t)text[i] << 16) | (uint32_t)text[i + 1]);
+		}
+		break;
+	default:
+		for (char32_t c : text) {
+			flags.push_back((uint32_t)c);
+		}
+		break;
+	}
+}
+
+bool AffixRules::load(const char* affixFilePath, const char* key) {
+	std::vector<std::string> lines;
+	if (!ReadLines(affixFilePath, key, lines)) {
+		return false;
+	}
+
+	utf8 = false;
+	asciiCaseFolding = true;
+	tryCharacters = 0;
+	flagMode = FlagMode::Char;
+	needAffixFlag = 0;
+	onlyInCompoundFlag = 0;
+	forbiddenWordFlag = 0;
+	aliases.clear();
+	suffixTable.clear();
+	prefixTable.clear();
+	affixStrings.clear();
+
+	// SET and FLAG decide how everything else is read, so find them first.
+	for (const std::string& line : lines) {
+		if (line.compare(0, 4, "SET ") == 0) {
+			std::string set = line.substr(4);
+			set.erase(set.find_last_not_of(" \t\r") + 1);
+			if (set == "UTF-8") {
+				utf8 = true;
+			}
+			else if (set != "ISO8859-1" && set != "ISO-8859-1") {
+				return false;
+			}
+		}
+		else if (line.compare(0, 5, "FLAG ") == 0) {
+			std::string mode = line.substr(5);
+			mode.erase(mode.find_last_not_of(" \t\r") + 1);
+			flagMode = mode == "long" ? FlagMode::Long : mode == "num" ? FlagMode::Num : mode == "UTF-8" ? FlagMode::Utf8 : FlagMode::Char;
+		}
+		else if (line.compare(0, 9, "KEEPCASE ") == 0 || line.compare(0, 14, "FORBIDDENWORD ") == 0
+			|| line.compare(0, 11, "CHECKSHARPS") == 0) {
+			asciiCaseFolding = false;
+		}
+		else if (line.compare(0, 5, "LANG ") == 0) {
+			std::string lang = line.substr(5, 3);
+			if (lang.compare(0, 2, "tr") == 0 || lang.compare(0, 2, "az") == 0 || lang == "crh") {
+				asciiCaseFolding = false;
+			}
+		}
+	}
+
+	std::u32string text;
+	std::unordered_map<std::u32string, uint32_t> affixIndex;
+	bool aliasHeader = false;
+	for (const std::string& line : lines) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		decode(line, text);
+		std::vector<std::u32string_view> fields = SplitFields(text);
+		if (fields.size() < 2) {
+			continue;
+		}
+
+		if (Equals(fields[0], "NEEDAFFIX")) {
+			needAffixFlag = parseFlag(fields[1]);
+			continue;
+		}
+		if (Equals(fields[0], "ONLYINCOMPOUND")) {
+			onlyInCompoundFlag = parseFlag(fields[1]);
+			continue;
+		}
+		if (Equals(fields[0], "FORBIDDENWORD")) {
+			forbiddenWordFlag = parseFlag(fields[1]);
+			continue;
+		}
+		if (Equals(fields[0], "TRY")) {
+			tryCharacters = fields[1].size();
+			continue;
+		}
+
+		if (Equals(fields[0], "AF")) {
+			// The first AF line holds the count, every later one a flag set.
+			if (aliasHeader) {
+				aliases.emplace_back();
+				parseFlags(fields[1], aliases.back());
+			}
+			aliasHeader = true;
+			continue;
+		}
+
+		bool suffix = Equals(fields[0], "SFX");
+		if (!suffix && !Equals(fields[0], "PFX")) {
+			continue;
+		}
+		if (fields.size() < 4) {
+			continue;
+		}
+
+		std::unordered_map<uint32_t, AffixClass>& table = suffix ? suffixTable : prefixTable;
+		uint32_t flag = parseFlag(fields[1]);
+		bool header = (Equals(fields[2], "Y") || Equals(fields[2], "N"))
+			&& fields[3].find_first_not_of(U"0123456789") == std::u32string_view::npos
+			&& (fields.size() == 4 || fields[4][0] == U'#');
+		if (header) {
+			table[flag].crossProduct = Equals(fields[2], "Y");
+			continue;
+		}
+
+		Rule rule;
+		if (!Equals(fields[2], "0")) {
+			rule.strip.assign(fields[2]);
+		}
+		std::u32string_view add = fields[3].substr(0, fields[3].find(U'/'));
+		if (!Equals(add, "0")) {
+			rule.add.assign(add);
+		}
+		auto affix = affixIndex.emplace(rule.add, (uint32_t)affixStrings.size());
+		if (affix.second) {
+			affixStrings.push_back(rule.add);
+		}
+		rule.affix = affix.first->second;
+		if (fields.size() >= 5) {
+			rule.condition = ParseCondition(fields[4]);
+		}
+		table[flag].rules.push_back(std::move(rule));
+	}
+
+	for (auto* table : { &suffixTable, &prefixTable }) {
+		for (auto& affixClass : *table) {
+			std::stable_sort(affixClass.second.rules.begin(), affixClass.second.rules.end(), [](const Rule& a, const Rule& b) {
+				return a.add.size() < b.add.size();
+			});
+			for (const Rule& rule : affixClass.second.rules) {
+				affixClass.second.maxStrip = std::max(affixClass.second.maxStrip, rule.strip.size());
+			}
+		}
+	}
+	return true;
+}
+
+bool AffixRules::readDictionary(const char* dictionaryFilePath, std::vector<Entry>& entries, const char* key) const {
+	std::vector<std::string> lines;
+	if (!ReadLines(dictionaryFilePath, key, lines)) {
+		return false;
+	}
+
+	std::u32string text;
+	for (size_t i = 0; i < lines.size(); ++i) {
+		const std::string& line = lines[i];
+		if (line.empty() || (i == 0 && line.find_first_not_of("0123456789 \t\r") == std::string::npos)) {
+			continue;
+		}
+		decode(line, text);
+
+		// The word ends at the first tab, or at the first space when there is
+		// no tab; a '/' that is not escaped starts the flags.
+		size_t end = text.find(U'\t');
+		if (end == std::u32string::npos) {
+			end = text.find(U' ');
+		}
+		std::u32string_view field = std::u32string_view(text).substr(0, end);
+		while (!field.empty() && IsSpace(field.back())) {
+			field.remove_suffix(1);
+		}
+
+		Entry entry;
+		size_t slash = std::u32string_view::npos;
+		for (size_t k = 1; k < field.size(); ++k) {
+			if (field[k] == U'/' && field[k - 1] != U'\\') {
+				slash = k;
+				break;
+			}
+		}
+		std::u32string_view word = field.substr(0, slash);
+		entry.stem.reserve(word.size());
+		for (size_t k = 0; k < word.size(); ++k) {
+			if (word[k] == U'\\' && k + 1 < word.size() && word[k + 1] == U'/') {
+				continue;
+			}
+			entry.stem += word[k];
+		}
+		if (entry.stem.empty()) {
+			continue;
+		}
+
+		if (slash != std::u32string_view::npos) {
+			std::u32string_view flags = field.substr(slash + 1);
+			if (!aliases.empty() && !flags.empty() && flags.find_first_not_of(U"0123456789") == std::u32string_view::npos) {
+				size_t alias = std::stoul(std::string(flags.begin(), flags.end()));
+				if (alias >= 1 && alias <= aliases.size()) {
+					entry.flags = aliases[alias - 1];
+				}
+			}
+			else {
+				parseFlags(flags, entry.flags);
+			}
+		}
+		entries.push_back(std::move(entry));
+	}
+	return true;
+}
+
+bool AffixRules::hasFlag(const Entry& entry, uint32_t flag) {
+	return flag != 0 && std::find(entry.flags.begin(), entry.flags.end(), flag) != entry.flags.end();
+}
+
+const AffixRules::AffixClass* AffixRules::suffixes(uint32_t flag) const {
+	auto found = suffixTable.find(flag);
+	return found == suffixTable.end() ? nullptr : &found->second;
+}
+
+const AffixRules::AffixClass* AffixRules::prefixes(uint32_t flag) const {
+	auto found = prefixTable.find(flag);
+	return found == prefixTable.end() ? nullptr : &found->second;
+}
+
+bool AffixRules::suffixApplies(const Rule& rule, std::u32string_view stem) {
+	if (stem.size() < rule.strip.size() || stem.size() < rule.condition.size()) {
+		return false;
+	}
+	if (stem.compare(stem.size() - rule.strip.size(), rule.strip.size(), rule.strip) != 0) {
+		return false;
+	}
+	return MatchesAt(rule.condition, stem, stem.size() - rule.condition.size());
+}
+
+bool AffixRules::prefixApplies(const Rule& rule, std::u32string_view stem) {
+	if (stem.size() < rule.strip.size() || stem.size() < rule.condition.size()) {
+		return false;
+	}
+	if (stem.compare(0, rule.strip.size(), rule.strip) != 0) {
+		return false;
+	}
+	return MatchesAt(rule.condition, stem, 0);
+}
+
+size_t AffixRules::ruleCount() const {
+	size_t count = 0;
+	for (const auto& affixClass : suffixTable) {
+		count += affixClass.second.rules.size();
+	}
+	for (const auto& affixClass : prefixTable) {
+		count += affixClass.second.rules.size();
+	}
+	return count;
+}
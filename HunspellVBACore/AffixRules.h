@@ -0,0 +1,240 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Affix tables of a Hunspell .aff file and the entries of .dic files.
+ *
+ * Only what is needed to enumerate surface forms is read: SET, FLAG, AF,
+ * NEEDAFFIX, ONLYINCOMPOUND, FORBIDDENWORD and the PFX/SFX tables, plus
+ * whether KEEPCASE, CHECKSHARPS or a Turkic LANG is declared (foldsAsciiCase)
+ * and the length of TRY (tryLength).
+ * Continuation classes (twofold affixes), compounding and morphological
+ * fields are ignored, so the forms produced by expand() are meant to be a
+ * subset of the words Hunspell accepts. Text is decoded to code points;
+ * SET UTF-8 and ISO8859-1 are supported.
+ */
+class AffixRules {
+public:
+	/** One position of an affix condition: ".", "x", "[xy]" or "[^xy]". */
+	struct ConditionChar {
+		bool any = false;
+		bool negate = false;
+		std::u32string chars;
+	};
+
+	struct Rule {
+		std::u32string strip;
+		std::u32string add;
+		std::vector<ConditionChar> condition;
+		uint32_t affix = 0; ///< index of add in affixes()
+	};
+
+	/** Rules of one flag, ordered by the length of add. */
+	struct AffixClass {
+		bool crossProduct = false;
+		size_t maxStrip = 0; ///< longest strip of any rule
+		std::vector<Rule> rules;
+	};
+
+	struct Entry {
+		std::u32string stem;
+		std::vector<uint32_t> flags;
+	};
+
+	/**
+	 * @param key - key of an encrypted .hz file (see DictionaryFile), NULL otherwise
+	 * @return false if the file cannot be read or declares an unsupported SET
+	 */
+	bool load(const char* affixFilePath, const char* key = nullptr);
+
+	/** Append the entries of a .dic (or .dic.hz) file. @return false if it cannot be read */
+	bool readDictionary(const char* dictionaryFilePath, std::vector<Entry>& entries, const char* key = nullptr) const;
+
+	const AffixClass* suffixes(uint32_t flag) const;
+	const AffixClass* prefixes(uint32_t flag) const;
+
+	/** @return true if a suffix rule may be applied to stem (strip and condition match) */
+	static bool suffixApplies(const Rule& rule, std::u32string_view stem);
+	static bool prefixApplies(const Rule& rule, std::u32string_view stem);
+
+	/**
+	 * @brief Call form(std::u32string_view) for the stem and every word one
+	 * suffix, one prefix or a cross-product pair of them derives from it.
+	 *
+	 * Forbidden and compound-only entries produce nothing, and stems that
+	 * need an affix are not produced on their own.
+	 */
+	template <typename Fn>
+	void expand(const Entry& entry, Fn&& form) const { expand(entry, 0, SIZE_MAX, form); }
+
+	/**
+	 * @brief expand() limited to forms of minLength to maxLength code points.
+	 *
+	 * Rules that would produce a form of another length are skipped before
+	 * their conditions are tested or the form is built.
+	 * @param memory - where the form being built is kept
+	 */
+	template <typename Fn>
+	void expand(const Entry& entry, size_t minLength, size_t maxLength, Fn&& form,
+		std::pmr::memory_resource* memory = std::pmr::get_default_resource()) const;
+
+	size_t ruleCount() const;
+
+	/**
+	 * @brief Whether Hunspell accepts a capitalised ASCII word ("Word",
+	 * "WORD") whenever it accepts the word in lowercase.
+	 *
+	 * False when the file declares KEEPCASE or FORBIDDENWORD (a cased form
+	 * may be rejected on its own), CHECKSHARPS, or a Turkic LANG, where I
+	 * does not lowercase to i.
+	 */
+	bool foldsAsciiCase() const { return asciiCaseFolding; }
+
+	/** Characters of the TRY line, which Hunspell's suggest inserts and substitutes. */
+	size_t tryLength() const { return tryCharacters; }
+
+	/** Distinct add strings of all rules; many rules share one. */
+	const std::vector<std::u32string>& affixes() const { return affixStrings; }
+
+private:
+	enum class FlagMode { Char, Long, Num, Utf8 };
+
+	bool decode(std::string_view bytes, std::u32string& out) const;
+	void parseFlags(std::u32string_view text, std::vector<uint32_t>& flags) const;
+	uint32_t parseFlag(std::u32string_view text) const;
+	static bool hasFlag(const Entry& entry, uint32_t flag);
+
+	bool utf8 = false;
+	bool asciiCaseFolding = true;
+	size_t tryCharacters = 0;
+	FlagMode flagMode = FlagMode::Char;
+	uint32_t needAffixFlag = 0;      // 0 when not declared
+	uint32_t onlyInCompoundFlag = 0;
+	uint32_t forbiddenWordFlag = 0;
+	std::vector<std::vector<uint32_t>> aliases; // AF lines, referenced from .dic as 1-based numbers
+	std::unordered_map<uint32_t, AffixClass> suffixTable;
+	std::unordered_map<uint32_t, AffixClass> prefixTable;
+	std::vector<std::u32string> affixStrings;
+};
+
+template <typename Fn>
+void AffixRules::expand(const Entry& entry, size_t minLength, size_t maxLength, Fn&& form,
+	std::pmr::memory_resource* memory) const {
+	if (hasFlag(entry, forbiddenWordFlag) || hasFlag(entry, onlyInCompoundFlag)) {
+		return;
+	}
+
+	const std::u32string& stem = entry.stem;
+	auto inRange = [&](size_t length) { return length >= minLength && length <= maxLength; };
+	if (!hasFlag(entry, needAffixFlag) && inRange(stem.size())) {
+		form(std::u32string_view(stem));
+	}
+
+	// Only a cross-product prefix can bring a suffixed form back into range.
+	bool crossPrefixes = false;
+	for (uint32_t prefixFlag : entry.flags) {
+		const AffixClass* prefixClass = prefixes(prefixFlag);
+		crossPrefixes = crossPrefixes || (prefixClass != nullptr && prefixClass->crossProduct);
+	}
+
+	std::pmr::u32string word(memory);
+	std::pmr::u32string both(memory);
+	for (uint32_t suffixFlag : entry.flags) {
+		const AffixClass* suffixClass = suffixes(suffixFlag);
+		if (suffixClass == nullptr) {
+			continue;
+		}
+		const bool combines = suffixClass->crossProduct && crossPrefixes;
+		auto first = suffixClass->rules.begin();
+		auto last = suffixClass->rules.end();
+		if (!combines) {
+			// Rules are ordered by add length, so the ones that can reach the
+			// length range are a contiguous run.
+			size_t minAdd = minLength > stem.size() ? minLength - stem.size() : 0;
+			first = std::partition_point(first, last, [&](const Rule& rule) { return rule.add.size() < minAdd; });
+			if (maxLength != SIZE_MAX) {
+				if (maxLength + suffixClass->maxStrip < stem.size()) {
+					continue;
+				}
+				size_t maxAdd = maxLength + suffixClass->maxStrip - stem.size();
+				last = std::partition_point(first, last, [&](const Rule& rule) { return rule.add.size() <= maxAdd; });
+			}
+		}
+		for (auto rule = first; rule != last; ++rule) {
+			const Rule& suffix = *rule;
+			size_t length = stem.size() - suffix.strip.size() + suffix.add.size();
+			if ((!combines && !inRange(length)) || !suffixApplies(suffix, stem)) {
+				continue;
+			}
+			word.assign(stem, 0, stem.size() - suffix.strip.size());
+			word += suffix.add;
+			if (inRange(length)) {
+				form(std::u32string_view(word));
+			}
+
+			if (!suffixClass->crossProduct) {
+				continue;
+			}
+			for (uint32_t prefixFlag : entry.flags) {
+				const AffixClass* prefixClass = prefixes(prefixFlag);
+				if (prefixClass == nullptr || !prefixClass->crossProduct) {
+					continue;
+				}
+				for (const Rule& prefix : prefixClass->rules) {
+					if (inRange(length - prefix.strip.size() + prefix.add.size()) && prefixApplies(prefix, stem)
+						&& prefix.strip.size() + suffix.strip.size() <= stem.size()) {
+						both.assign(prefix.add);
+						both.append(word, prefix.strip.size(), std::u32string::npos);
+						form(std::u32string_view(both));
+					}
+				}
+			}
+		}
+	}
+
+	for (uint32_t prefixFlag : entry.flags) {
+		const AffixClass* prefixClass = prefixes(prefixFlag);
+		if (prefixClass == nullptr) {
+			continue;
+		}
+		for (const Rule& prefix : prefixClass->rules) {
+			if (inRange(stem.size() - prefix.strip.size() + prefix.add.size()) && prefixApplies(prefix, stem)) {
+				word.assign(prefix.add);
+				word.append(stem, prefix.strip.size(), std::u32string::npos);
+				form(std::u32string_view(word));
+			}
+		}
+	}
+}
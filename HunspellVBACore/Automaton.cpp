@@ -0,0 +1,218 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Automaton.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	const char kMagic[8] = { 'H', 'V', 'D', 'A', 'W', 'G', '0', '1' };
+	const size_t kHeaderSize = 8 + 8 + 3 * 4;
+
+	void PutUInt32(std::string& out, uint32_t value) {
+		for (int i = 0; i < 4; ++i) {
+			out += (char)((value >> (8 * i)) & 0xFF);
+		}
+	}
+
+	uint32_t GetUInt32(const char* data) {
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+
+	size_t Align4(size_t size) {
+		return (size + 3) & ~(size_t)3;
+	}
+}
+
+bool Automaton::load(const char* path, uint64_t offset) {
+	states = 0;
+	file.close();
+	if (!file.open(path) || offset % 4 != 0 || file.size() < offset || file.size() - offset < kHeaderSize
+		|| memcmp(file.data() + offset, kMagic, sizeof(kMagic)) != 0) {
+		file.close();
+		return false;
+	}
+
+	const char* data = file.data() + offset;
+	const size_t size = file.size() - (size_t)offset;
+	uint64_t wordCount = (uint64_t)GetUInt32(data + 8) | ((uint64_t)GetUInt32(data + 12) << 32);
+	uint32_t stateCount = GetUInt32(data + 16);
+	uint32_t arcCount = GetUInt32(data + 20);
+	uint32_t rootState = GetUInt32(data + 24);
+
+	uint64_t labelsOffset = kHeaderSize + 4 * ((uint64_t)stateCount + 1) + ((uint64_t)stateCount + 7) / 8;
+	uint64_t targetsOffset = (labelsOffset + arcCount + 3) & ~(uint64_t)3;
+	if (stateCount == 0 || rootState >= stateCount || size < targetsOffset + 4 * (uint64_t)arcCount
+		|| GetUInt32(data + kHeaderSize + 4 * (size_t)stateCount) != arcCount) {
+		file.close();
+		return false;
+	}
+
+	// contains() follows arcs without bounds checks, so a damaged file (or
+	// shared segment) is rejected here rather than read out of bounds.
+	const char* arcStarts = data + kHeaderSize;
+	for (uint32_t state = 0, previous = 0; state <= stateCount; ++state) {
+		uint32_t start = GetUInt32(arcStarts + 4 * (size_t)state);
+		if (start < previous || start > arcCount) {
+			file.close();
+			return false;
+		}
+		previous = start;
+	}
+	for (uint32_t arc = 0; arc < arcCount; ++arc) {
+		if (GetUInt32(data + targetsOffset + 4 * (size_t)arc) >= stateCount) {
+			file.close();
+			return false;
+		}
+	}
+
+	words = wordCount;
+	states = stateCount;
+	root = rootState;
+	firstArc = reinterpret_cast<const uint32_t*>(data + kHeaderSize);
+	finals = reinterpret_cast<const uint8_t*>(data + kHeaderSize + 4 * ((size_t)stateCount + 1));
+	labels = reinterpret_cast<const uint8_t*>(data + (size_t)labelsOffset);
+	targets = reinterpret_cast<const uint32_t*>(data + (size_t)targetsOffset);
+	return true;
+}
+
+bool Automaton::contains(std::string_view word) const {
+	if (states == 0) {
+		return false;
+	}
+
+	uint32_t state = root;
+	for (char c : word) {
+		uint8_t label = (uint8_t)c;
+		const uint8_t* begin = labels + firstArc[state];
+		const uint8_t* end = labels + firstArc[state + 1];
+		// Most states have a handful of arcs; the root and a few others
+		// have dozens, where a binary search pays off.
+		const uint8_t* arc = end - begin > 8 ? std::lower_bound(begin, end, label) : std::find(begin, end, label);
+		if (arc == end || *arc != label) {
+			return false;
+		}
+		state = targets[arc - labels];
+	}
+	return (finals[state >> 3] >> (state & 7)) & 1;
+}
+
+bool AutomatonBuilder::build(std::vector<std::string_view>& input, const char* outputPath) {
+	std::sort(input.begin(), input.end());
+	input.erase(std::unique(input.begin(), input.end()), input.end());
+
+	path.assign(1, OpenState());
+	previous.clear();
+	registry.clear();
+	firstArc.assign(1, 0);
+	finals.clear();
+	labels.clear();
+	targets.clear();
+	words = 0;
+
+	for (std::string_view word : input) {
+		add(word);
+	}
+	freezeTo(0);
+	uint32_t rootState = freeze(path[0]);
+	registry.clear();
+	return write(outputPath, rootState);
+}
+
+void AutomatonBuilder::add(std::string_view word) {
+	size_t common = 0;
+	while (common < word.size() && common < previous.size() && word[common] == previous[common]) {
+		++common;
+	}
+	freezeTo(common);
+
+	for (size_t i = common; i < word.size(); ++i) {
+		path.emplace_back();
+	}
+	path[word.size()].final = true;
+	previous.assign(word.data(), word.size());
+	++words;
+}
+
+void AutomatonBuilder::freezeTo(size_t depth) {
+	while (path.size() > depth + 1) {
+		uint32_t state = freeze(path.back());
+		path.pop_back();
+		path.back().arcs.emplace_back((uint8_t)previous[path.size() - 1], state);
+	}
+}
+
+uint32_t AutomatonBuilder::freeze(const OpenState& state) {
+	std::string signature(1, state.final ? '\1' : '\0');
+	for (const auto& arc : state.arcs) {
+		signature += (char)arc.first;
+		PutUInt32(signature, arc.second);
+	}
+
+	auto found = registry.emplace(std::move(signature), (uint32_t)finals.size());
+	if (!found.second) {
+		return found.first->second;
+	}
+
+	for (const auto& arc : state.arcs) {
+		labels.push_back(arc.first);
+		targets.push_back(arc.second);
+	}
+	firstArc.push_back((uint32_t)labels.size());
+	finals.push_back(state.final);
+	return found.first->second;
+}
+
+bool AutomatonBuilder::write(const char* outputPath, uint32_t rootState) const {
+	uint32_t stateCount = (uint32_t)finals.size();
+	std::string data(kMagic, sizeof(kMagic));
+	PutUInt32(data, (uint32_t)words);
+	PutUInt32(data, (uint32_t)(words >> 32));
+	PutUInt32(data, stateCount);
+	PutUInt32(data, (uint32_t)labels.size());
+	PutUInt32(data, rootState);
+	for (uint32_t first : firstArc) {
+		PutUInt32(data, first);
+	}
+
+	std::string bits(((size_t)stateCount + 7) / 8, '\0');
+	for (uint32_t i = 0; i < stateCount; ++i) {
+		if (finals[i]) {
+			bits[i >> 3] |= (char)(1 << (i & 7));
+		}
+	}
+	data += bits;
+	data.append(reinterpret_cast<const char*>(labels.data()), labels.size());
+	data.resize(Align4(data.size()), '\0');
+	for (uint32_t target : targets) {
+		PutUInt32(data, target);
+	}
+
+	std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+	file.write(data.data(), (std::streamsize)data.size());
+	return (bool)file;
+}
@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.h"
+
+/**
+ * @brief Minimal acyclic automaton (DAWG) over UTF-8 words, memory-mapped.
+ *
+ * A lookup is one walk over the bytes of the word, which is much cheaper
+ * than Hunspell's affix stripping on dictionaries with thousands of suffix
+ * rules. The file is used in place, so several processes share its pages.
+ *
+ * File layout, little-endian:
+ *   char[8]  "HVDAWG01"
+ *   uint64   word count
+ *   uint32   state count, arc count, root state
+ *   uint32   firstArc[stateCount + 1]; arcs of s are [firstArc[s], firstArc[s + 1])
+ *   uint8    final[(stateCount + 7) / 8], one bit per state
+ *   uint8    labels[arcCount], sorted within each state
+ *   padding  to a multiple of 4 bytes
+ *   uint32   targets[arcCount]
+ */
+class Automaton {
+public:
+	/**
+	 * @param offset - where the automaton starts in the file, a multiple of 4,
+	 *        for automatons embedded in another file (see EngineSnapshot)
+	 * @return false if the file is missing or malformed
+	 */
+	bool load(const char* path, uint64_t offset = 0);
+
+	bool contains(std::string_view word) const;
+
+	uint64_t wordCount() const { return words; }
+	size_t fileBytes() const { return file.size(); }
+
+private:
+	MappedFile file;
+	uint64_t words = 0;
+	uint32_t states = 0;
+	uint32_t root = 0;
+	const uint32_t* firstArc = nullptr;
+	const uint8_t* finals = nullptr;
+	const uint8_t* labels = nullptr;
+	const uint32_t* targets = nullptr;
+};
+
+/**
+ * @brief Builds the minimal automaton for a set of words and writes it.
+ *
+ * Words are added in sorted order and states are merged with an equivalent
+ * one as soon as they can no longer change (Daciuk et al., incremental
+ * construction from sorted data), so memory grows with the size of the
+ * minimal automaton rather than with the number of words.
+ */
+class AutomatonBuilder {
+public:
+	/** Sort words, drop duplicates and write the automaton. @return false on I/O errors */
+	bool build(std::vector<std::string_view>& words, const char* outputPath);
+
+	uint64_t wordCount() const { return words; }
+	size_t stateCount() const { return finals.size(); }
+	size_t arcCount() const { return labels.size(); }
+
+private:
+	struct OpenState {
+		bool final = false;
+		std::vector<std::pair<uint8_t, uint32_t>> arcs;
+	};
+
+	void add(std::string_view word);
+	void freezeTo(size_t depth);
+	uint32_t freeze(const OpenState& state);
+	bool write(const char* outputPath, uint32_t rootState) const;
+
+	std::vector<OpenState> path; // path[d] follows the first d bytes of previous
+	std::string previous;
+	std::unordered_map<std::string, uint32_t> registry;
+	std::vector<uint32_t> firstArc;
+	std::vector<bool> finals;
+	std::vector<uint8_t> labels;
+	std::vector<uint32_t> targets;
+	uint64_t words = 0;
+};
@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "CorrectionTable.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	const char kMagic[8] = { 'H', 'V', 'C', 'T', '0', '0', '0', '2' };
+
+	void PutUInt32(std::string& out, uint32_t value) {
+		for (int i = 0; i < 4; ++i) {
+			out += (char)((value >> (8 * i)) & 0xFF);
+		}
+	}
+
+	uint32_t GetUInt32(const char* data) {
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+}
+
+bool CorrectionTable::write(const char* path, const Entries& table) {
+	std::vector<std::string_view> keys;
+	keys.reserve(table.size());
+	for (const auto& entry : table) {
+		keys.push_back(entry.first);
+	}
+	PerfectHash tableHash;
+	if (!tableHash.build(keys)) {
+		return false;
+	}
+
+	std::vector<std::string> records(table.size());
+	std::string strings;
+	for (const auto& entry : table) {
+		std::string& record = records[tableHash.lookup(entry.first)];
+		PutUInt32(record, (uint32_t)strings.size());
+		PutUInt32(record, (uint32_t)entry.first.size());
+		strings += entry.first;
+
+		std::string value;
+		for (const std::string& suggestion : entry.second) {
+			if (!value.empty()) {
+				value += '\n';
+			}
+			value += suggestion;
+		}
+		PutUInt32(record, (uint32_t)strings.size());
+		PutUInt32(record, (uint32_t)value.size());
+		strings += value;
+	}
+
+	std::string header(kMagic, sizeof(kMagic));
+	PutUInt32(header, (uint32_t)table.size());
+	PutUInt32(header, (uint32_t)strings.size());
+	PutUInt32(header, (uint32_t)tableHash.getBucketSeed());
+	PutUInt32(header, (uint32_t)tableHash.getSeeds().size());
+	for (uint32_t seed : tableHash.getSeeds()) {
+		PutUInt32(header, seed);
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << header;
+	for (const std::string& record : records) {
+		file << record;
+	}
+	file << strings;
+	return (bool)file;
+}
+
+bool CorrectionTable::load(const char* path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (data.size() < 24 || memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+		return false;
+	}
+	uint32_t count = GetUInt32(data.data() + 8);
+	uint32_t poolSize = GetUInt32(data.data() + 12);
+	uint32_t bucketSeed = GetUInt32(data.data() + 16);
+	uint32_t bucketCount = GetUInt32(data.data() + 20);
+	size_t seedsEnd = 24 + (size_t)bucketCount * 4;
+	size_t recordsEnd = seedsEnd + (size_t)count * 16;
+	if ((uint64_t)data.size() != 24 + (uint64_t)bucketCount * 4 + (uint64_t)count * 16 + poolSize) {
+		return false;
+	}
+
+	std::vector<uint32_t> seeds(bucketCount);
+	for (uint32_t i = 0; i < bucketCount; ++i) {
+		seeds[i] = GetUInt32(data.data() + 24 + (size_t)i * 4);
+	}
+	PerfectHash loadedHash;
+	if (!loadedHash.assign(count, bucketSeed, std::move(seeds))) {
+		return false;
+	}
+
+	std::string loadedPool = data.substr(recordsEnd);
+	std::vector<Entry> loaded(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		const char* record = data.data() + seedsEnd + (size_t)i * 16;
+		Entry& entry = loaded[i];
+		entry.keyOffset = GetUInt32(record);
+		entry.keyLength = GetUInt32(record + 4);
+		entry.valueOffset = GetUInt32(record + 8);
+		entry.valueLength = GetUInt32(record + 12);
+		if ((uint64_t)entry.keyOffset + entry.keyLength > poolSize ||
+			(uint64_t)entry.valueOffset + entry.valueLength > poolSize) {
+			return false;
+		}
+		// Every key in its own slot also rules out duplicates.
+		if (loadedHash.lookup(std::string_view(loadedPool.data() + entry.keyOffset, entry.keyLength)) != i) {
+			return false;
+		}
+	}
+
+	hash = std::move(loadedHash);
+	entries = std::move(loaded);
+	pool = std::move(loadedPool);
+	return true;
+}
+
+bool CorrectionTable::lookup(std::string_view misspelling, std::vector<std::string>& suggestions) const {
+	if (entries.empty()) {
+		return false;
+	}
+	const Entry& entry = entries[hash.lookup(misspelling)];
+	if (key(entry) != misspelling) {
+		return false;
+	}
+
+	suggestions.clear();
+	std::string_view value(pool.data() + entry.valueOffset, entry.valueLength);
+	while (!value.empty()) {
+		size_t end = value.find('\n');
+		suggestions.emplace_back(value.substr(0, end));
+		if (end == std::string_view::npos) {
+			break;
+		}
+		value.remove_prefix(end + 1);
+	}
+	return true;
+}
+
+size_t CorrectionTable::memoryBytes() const {
+	return pool.capacity() + entries.capacity() * sizeof(Entry) + hash.memoryBytes();
+}
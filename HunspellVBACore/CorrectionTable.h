@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "PerfectHash.h"
+
+/**
+ * @brief Precomputed misspelling -> suggestions table.
+ *
+ * Built offline (HunspellVBACli build-corrections) from misspellings seen in
+ * real documents, and looked up through a minimal perfect hash, so known
+ * typos are answered without running Hunspell's suggest.
+ *
+ * The hash is built once by write() and stored with the table; load() only
+ * checks that every key hashes to its own slot.
+ *
+ * File layout, little-endian:
+ *   char[8]  "HVCT0002"
+ *   uint32   entry count
+ *   uint32   string pool size
+ *   uint32   bucket seed of the perfect hash
+ *   uint32   bucket count of the perfect hash (entry count / 4 + 1)
+ *   seeds    uint32 per bucket
+ *   entries  { uint32 keyOffset, keyLength, valueOffset, valueLength } * count, in slot order
+ *   pool     UTF-8 keys and values; a value is its suggestions joined by '\n'
+ */
+class CorrectionTable {
+public:
+	typedef std::vector<std::pair<std::string, std::vector<std::string>>> Entries;
+
+	/** @return false if the file is missing or malformed */
+	bool load(const char* path);
+
+	/** @return true and fills suggestions if misspelling is in the table */
+	bool lookup(std::string_view misspelling, std::vector<std::string>& suggestions) const;
+
+	size_t size() const { return entries.size(); }
+	size_t memoryBytes() const;
+
+	/** @return false if the file cannot be written or entries has duplicate keys */
+	static bool write(const char* path, const Entries& entries);
+
+private:
+	struct Entry {
+		uint32_t keyOffset;
+		uint32_t keyLength;
+		uint32_t valueOffset;
+		uint32_t valueLength;
+	};
+
+	std::string_view key(const Entry& entry) const {
+		return std::string_view(pool.data() + entry.keyOffset, entry.keyLength);
+	}
+
+	PerfectHash hash;
+	std::vector<Entry> entries; // indexed by perfect hash slot
+	std::string pool;
+};
@@ -0,0 +1,559 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "DictionaryFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <utility>
+
+// hzip format, as written by Hunspell's hzip tool and read by its Hunzip class:
+//   "hz0", or "hz1" and one byte of key checksum (XOR of the key bytes)
+//   uint16 big-endian number of codes
+//   per code: 2 decoded bytes, 1 byte code length in bits, length / 8 + 1 bytes of code, MSB first
+//   the Huffman-coded text; the last code is the terminator, which also holds
+//   the odd last byte (first byte 1) or nothing (first byte 0)
+// With a key, every header byte after the checksum is XORed with the next key
+// byte, cycling. The decoded text stores each line as: the bytes that differ
+// from the previous line (bytes below 47 other than tab and space escaped by
+// 31), an optional byte 31 + n meaning "and the last n bytes of the previous
+// line", and one byte with the length of the prefix shared with the previous
+// line (30 stands for 9), which also ends the line.
+
+namespace
+{
+	const size_t kBlockSize = 65536;
+	const unsigned char kEscape = 31;
+
+	bool Exists(const std::string& path) {
+		return std::ifstream(path, std::ios::binary).is_open();
+	}
+
+	bool EndsWithHz(const std::string& path) {
+		return path.size() > 3 && path.compare(path.size() - 3, 3, ".hz") == 0;
+	}
+
+	/** Cycles through the key the way hzip does; a null key leaves bytes unchanged. */
+	class KeyStream {
+	public:
+		explicit KeyStream(const char* key) : key(key != nullptr && *key != '\0' ? key : nullptr), position(key) {
+		}
+
+		unsigned char first() const { return key ? (unsigned char)*key : 0; }
+
+		unsigned char next() {
+			if (!key) {
+				return 0;
+			}
+			if (*(++position) == '\0') {
+				position = key;
+			}
+			return (unsigned char)*position;
+		}
+
+	private:
+		const char* key;
+		const char* position;
+	};
+
+	unsigned char Checksum(const char* key) {
+		unsigned char sum = 0;
+		for (; *key != '\0'; ++key) {
+			sum ^= (unsigned char)*key;
+		}
+		return sum;
+	}
+
+	/** Lines as differences to the previous line; see the format description above. */
+	void PrefixCompress(const std::string& text, std::string& out) {
+		std::string previous;
+		size_t start = 0;
+		while (start < text.size()) {
+			size_t end = text.find('\n', start);
+			bool newline = end != std::string::npos;
+			end = newline ? end + 1 : text.size();
+			std::string line = text.substr(start, end - start);
+			start = end;
+
+			size_t length = line.size();
+			size_t prefix = 0;
+			while (prefix < length && prefix < previous.size() && line[prefix] == previous[prefix]) {
+				++prefix;
+			}
+			size_t suffix = 0;
+			unsigned char prefixByte = 0;
+			size_t literalEnd = length;
+			if (newline) {
+				if (prefix == length) {
+					--prefix;
+				}
+				prefix = std::min<size_t>(prefix, 29);
+				prefixByte = prefix == '\t' ? 30 : (unsigned char)prefix;
+				while (suffix + 2 <= length && suffix + 2 <= previous.size()
+					&& line[length - suffix - 2] == previous[previous.size() - suffix - 2]
+					&& suffix + prefix + 1 < length && suffix < 15) {
+					++suffix;
+				}
+				if (suffix == 1) {
+					suffix = 0;
+				}
+				literalEnd = length - suffix - 1;
+			}
+			else {
+				prefix = 0;
+			}
+
+			for (size_t i = prefix; i < literalEnd; ++i) {
+				unsigned char c = (unsigned char)line[i];
+				if (c < 47 && c != '\t' && c != ' ') {
+					out += (char)kEscape;
+				}
+				out += (char)c;
+			}
+			if (suffix > 0) {
+				out += (char)(suffix + 31);
+			}
+			if (newline) {
+				out += (char)prefixByte;
+			}
+			previous = std::move(line);
+		}
+	}
+
+	/** Huffman code lengths for the symbols with a non-zero count. */
+	bool CodeLengths(const std::vector<uint64_t>& counts, std::vector<int>& lengths) {
+		struct Item {
+			uint64_t count;
+			int node;
+		};
+		auto heavier = [](const Item& a, const Item& b) { return a.count > b.count; };
+		std::priority_queue<Item, std::vector<Item>, decltype(heavier)> queue(heavier);
+		std::vector<int> parent;
+		for (size_t i = 0; i < counts.size(); ++i) {
+			if (counts[i] != 0) {
+				queue.push({ counts[i], (int)i });
+			}
+		}
+		parent.assign(counts.size(), -1);
+		while (queue.size() > 1) {
+			Item a = queue.top();
+			queue.pop();
+			Item b = queue.top();
+			queue.pop();
+			int node = (int)parent.size();
+			parent.push_back(-1);
+			parent[a.node] = node;
+			parent[b.node] = node;
+			queue.push({ a.count + b.count, node });
+		}
+
+		lengths.assign(counts.size(), 0);
+		for (size_t i = 0; i < counts.size(); ++i) {
+			if (counts[i] == 0) {
+				continue;
+			}
+			int depth = 0;
+			for (int node = parent[i]; node != -1; node = parent[node]) {
+				++depth;
+			}
+			// The code length is stored in one byte.
+			if (depth > 255) {
+				return false;
+			}
+			lengths[i] = std::max(depth, 1);
+		}
+		return true;
+	}
+
+	/** Canonical codes for the lengths, shortest first. */
+	void AssignCodes(const std::vector<int>& lengths, std::vector<std::vector<bool>>& codes) {
+		std::vector<size_t> order;
+		for (size_t i = 0; i < lengths.size(); ++i) {
+			if (lengths[i] != 0) {
+				order.push_back(i);
+			}
+		}
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return lengths[a] < lengths[b]; });
+		codes.assign(lengths.size(), std::vector<bool>());
+		std::vector<bool> code;
+		for (size_t i = 0; i < order.size(); ++i) {
+			size_t length = (size_t)lengths[order[i]];
+			if (i > 0) {
+				// Next code: increment, then extend with zeros.
+				size_t bit = code.size();
+				while (bit > 0 && code[bit - 1]) {
+					code[--bit] = false;
+				}
+				if (bit > 0) {
+					code[bit - 1] = true;
+				}
+			}
+			code.resize(length, false);
+			codes[order[i]] = code;
+		}
+	}
+
+	class BitWriter {
+	public:
+		explicit BitWriter(std::ofstream& out) : out(out), buffer(kBlockSize, 0), bits(0) {
+		}
+
+		void write(const std::vector<bool>& code) {
+			for (bool bit : code) {
+				size_t index = bits / 8;
+				if (bits % 8 == 0) {
+					buffer[index] = 0;
+				}
+				if (bit) {
+					buffer[index] |= (unsigned char)(0x80 >> (bits % 8));
+				}
+				if (++bits == kBlockSize * 8) {
+					out.write(reinterpret_cast<const char*>(buffer.data()), (std::streamsize)kBlockSize);
+					bits = 0;
+				}
+			}
+		}
+
+		/** Hunzip finds the terminator on the bit after it, so a byte more than needed is written. */
+		void finish() {
+			if (bits > 0) {
+				if (bits % 8 == 0) {
+					buffer[bits / 8] = 0;
+				}
+				out.write(reinterpret_cast<const char*>(buffer.data()), (std::streamsize)(bits / 8 + 1));
+			}
+		}
+
+	private:
+		std::ofstream& out;
+		std::vector<unsigned char> buffer;
+		size_t bits;
+	};
+}
+
+std::string DictionaryFile::resolve(const char* path) {
+	std::string name = hunspellPath(path);
+	if (Exists(name)) {
+		return name;
+	}
+	name += ".hz";
+	return Exists(name) ? name : std::string();
+}
+
+std::string DictionaryFile::hunspellPath(const char* path) {
+	std::string name = path;
+	if (EndsWithHz(name)) {
+		name.resize(name.size() - 3);
+	}
+	return name;
+}
+
+bool DictionaryFile::open(const char* path, const char* key) {
+	std::string name = resolve(path);
+	if (name.empty()) {
+		return false;
+	}
+	file.open(name, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	compressed = EndsWithHz(name);
+	if (!compressed) {
+		return true;
+	}
+
+	finished = false;
+	failed = false;
+	previous.clear();
+	if (!readCodes(key)) {
+		file.close();
+		return false;
+	}
+	input.assign(kBlockSize, 0);
+	output.assign(kBlockSize, 0);
+	inputBits = inputPosition = 0;
+	outputSize = outputPosition = 0;
+	return true;
+}
+
+bool DictionaryFile::readCodes(const char* key) {
+	char magic[3];
+	if (!file.read(magic, 3) || magic[0] != 'h' || magic[1] != 'z' || (magic[2] != '0' && magic[2] != '1')) {
+		return false;
+	}
+	bool encrypted = magic[2] == '1';
+	if (encrypted) {
+		char sum;
+		if (key == nullptr || *key == '\0' || !file.read(&sum, 1) || (unsigned char)sum != Checksum(key)) {
+			return false;
+		}
+	}
+	KeyStream keys(encrypted ? key : nullptr);
+
+	unsigned char count[2];
+	if (!file.read(reinterpret_cast<char*>(count), 2)) {
+		return false;
+	}
+	count[0] ^= keys.first();
+	count[1] ^= keys.next();
+	int codes = (count[0] << 8) | count[1];
+
+	nodes.assign(1, Node{ { 0, 0 }, { 0, 0 } });
+	lastNode = 0;
+	unsigned char code[33];
+	for (int i = 0; i < codes; ++i) {
+		unsigned char bytes[2];
+		unsigned char length;
+		if (!file.read(reinterpret_cast<char*>(bytes), 2)) {
+			return false;
+		}
+		bytes[0] ^= keys.next();
+		bytes[1] ^= keys.next();
+		if (!file.read(reinterpret_cast<char*>(&length), 1)) {
+			return false;
+		}
+		length ^= keys.next();
+		if (!file.read(reinterpret_cast<char*>(code), length / 8 + 1)) {
+			return false;
+		}
+		for (int j = 0; j <= length / 8; ++j) {
+			code[j] ^= keys.next();
+		}
+
+		int node = 0;
+		for (int j = 0; j < length; ++j) {
+			int bit = (code[j / 8] >> (7 - j % 8)) & 1;
+			int next = nodes[node].next[bit];
+			if (next == 0) {
+				next = (int)nodes.size();
+				nodes.push_back(Node{ { 0, 0 }, { 0, 0 } });
+				nodes[node].next[bit] = next;
+				lastNode = next;
+			}
+			node = next;
+		}
+		nodes[node].bytes[0] = bytes[0];
+		nodes[node].bytes[1] = bytes[1];
+	}
+	return true;
+}
+
+bool DictionaryFile::decodeBlock() {
+	outputSize = 0;
+	outputPosition = 0;
+	int node = 0;
+	for (;;) {
+		if (inputPosition == inputBits) {
+			// Only a full block can be followed by more data.
+			if (inputBits != 0 && inputBits < kBlockSize * 8) {
+				return false;
+			}
+			file.read(reinterpret_cast<char*>(input.data()), (std::streamsize)kBlockSize);
+			inputBits = (size_t)file.gcount() * 8;
+			inputPosition = 0;
+			if (inputBits == 0) {
+				return false;
+			}
+		}
+		for (; inputPosition < inputBits; ++inputPosition) {
+			int bit = (input[inputPosition / 8] >> (7 - inputPosition % 8)) & 1;
+			int leaf = node;
+			node = nodes[node].next[bit];
+			if (node != 0) {
+				continue;
+			}
+			if (leaf == lastNode) {
+				if (nodes[leaf].bytes[0] != 0) {
+					output[outputSize++] = nodes[leaf].bytes[1];
+				}
+				finished = true;
+				file.close();
+				return true;
+			}
+			output[outputSize++] = nodes[leaf].bytes[0];
+			output[outputSize++] = nodes[leaf].bytes[1];
+			if (outputSize == kBlockSize) {
+				// This bit starts the next code; it is read again next time.
+				return true;
+			}
+			node = nodes[0].next[bit];
+		}
+	}
+}
+
+int DictionaryFile::nextByte() {
+	if (outputPosition == outputSize) {
+		if (finished || failed) {
+			return -1;
+		}
+		if (!decodeBlock()) {
+			failed = true;
+			return -1;
+		}
+		if (outputSize == 0) {
+			return -1;
+		}
+	}
+	return output[outputPosition++];
+}
+
+bool DictionaryFile::getline(std::string& line) {
+	if (!compressed) {
+		return file.is_open() && (bool)std::getline(file, line);
+	}
+
+	std::string& text = pending;
+	text.clear();
+	bool endOfLine = false;
+	size_t prefix = 0;
+	size_t suffix = 0;
+	int c;
+	while ((c = nextByte()) != -1) {
+		if (c == kEscape) {
+			if ((c = nextByte()) == -1) {
+				break;
+			}
+		}
+		else if (c < 47 && c != '\t' && c != ' ') {
+			if (c > 32) {
+				suffix = (size_t)c - 31;
+				if ((c = nextByte()) == -1) {
+					break;
+				}
+			}
+			prefix = c == 30 ? 9 : (size_t)c;
+			endOfLine = true;
+			break;
+		}
+		text += (char)c;
+	}
+	if (!endOfLine && text.empty()) {
+		return false;
+	}
+
+	// Built in place so the buffers of line, previous and pending are reused.
+	line.assign(previous, 0, std::min(prefix, previous.size()));
+	line += text;
+	if (endOfLine) {
+		if (suffix > 0 && suffix < previous.size()) {
+			line.append(previous, previous.size() - suffix - 1, std::string::npos);
+		}
+		else {
+			line += '\n';
+		}
+	}
+	previous = line;
+	if (!line.empty() && line.back() == '\n') {
+		line.pop_back();
+	}
+	return true;
+}
+
+bool WriteHzip(const char* inputPath, const char* outputPath, const char* key) {
+	std::ifstream in(inputPath, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+	std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	std::string packed;
+	PrefixCompress(text, packed);
+
+	// Symbols are byte pairs; one more symbol ends the text and carries an odd last byte.
+	const size_t kTerminator = 65536;
+	std::vector<uint64_t> counts(kTerminator + 1, 0);
+	size_t pairs = packed.size() / 2;
+	for (size_t i = 0; i < pairs; ++i) {
+		++counts[((unsigned char)packed[2 * i] << 8) | (unsigned char)packed[2 * i + 1]];
+	}
+	counts[kTerminator] = 1;
+	unsigned char terminator[2] = { 0, 0 };
+	if (packed.size() % 2 != 0) {
+		terminator[0] = 1;
+		terminator[1] = (unsigned char)packed.back();
+	}
+
+	std::vector<int> lengths;
+	if (!CodeLengths(counts, lengths)) {
+		return false;
+	}
+	std::vector<std::vector<bool>> codes;
+	AssignCodes(lengths, codes);
+
+	size_t codeCount = 0;
+	for (int length : lengths) {
+		codeCount += length != 0 ? 1 : 0;
+	}
+	if (codeCount > 0xFFFF) {
+		return false;
+	}
+
+	std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+	if (!out) {
+		return false;
+	}
+	bool encrypted = key != nullptr && *key != '\0';
+	out.write(encrypted ? "hz1" : "hz0", 3);
+	if (encrypted) {
+		out.put((char)Checksum(key));
+	}
+	KeyStream keys(encrypted ? key : nullptr);
+
+	out.put((char)((codeCount >> 8) ^ keys.first()));
+	out.put((char)((codeCount & 0xFF) ^ keys.next()));
+
+	// Hunzip takes the last code read as the terminator, so it goes last.
+	unsigned char code[33];
+	for (size_t symbol = 0; symbol <= kTerminator; ++symbol) {
+		if (lengths[symbol] == 0) {
+			continue;
+		}
+		unsigned char bytes[2] = { (unsigned char)(symbol >> 8), (unsigned char)symbol };
+		if (symbol == kTerminator) {
+			bytes[0] = terminator[0];
+			bytes[1] = terminator[1];
+		}
+		const std::vector<bool>& bits = codes[symbol];
+		std::fill(std::begin(code), std::end(code), 0);
+		for (size_t j = 0; j < bits.size(); ++j) {
+			if (bits[j]) {
+				code[j / 8] |= (unsigned char)(0x80 >> (j % 8));
+			}
+		}
+		out.put((char)(bytes[0] ^ keys.next()));
+		out.put((char)(bytes[1] ^ keys.next()));
+		out.put((char)((unsigned char)bits.size() ^ keys.next()));
+		for (size_t j = 0; j <= bits.size() / 8; ++j) {
+			out.put((char)(code[j] ^ keys.next()));
+		}
+	}
+
+	BitWriter writer(out);
+	for (size_t i = 0; i < pairs; ++i) {
+		writer.write(codes[((unsigned char)packed[2 * i] << 8) | (unsigned char)packed[2 * i + 1]]);
+	}
+	writer.write(codes[kTerminator]);
+	writer.finish();
+	return (bool)out;
+}
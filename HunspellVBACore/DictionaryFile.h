@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads a Hunspell .aff or .dic file line by line, plain or hzip-compressed.
+ *
+ * Paths are resolved like Hunspell does: the file itself if it exists,
+ * otherwise the same name with ".hz" appended; a path given with ".hz" is
+ * resolved without it first, so the plain file wins when both exist. Compressed files (made by
+ * Hunspell's hzip tool or WriteHzip, optionally encrypted with a key) are
+ * decoded one 64 KB block at a time while lines are read, so a file is never
+ * held in memory as a whole.
+ */
+class DictionaryFile {
+public:
+	/**
+	 * @param key - key of an encrypted .hz file; ignored for other files
+	 * @return false if no file can be opened, the .hz header is malformed or the key is wrong
+	 */
+	bool open(const char* path, const char* key = nullptr);
+
+	/** Read the next line without its line break. @return false at the end or on corrupt data */
+	bool getline(std::string& line);
+
+	bool isCompressed() const { return compressed; }
+
+	/**
+	 * @return the file Hunspell reads for hunspellPath(path): that file, or the
+	 *         same name + ".hz" when only that exists; empty if neither exists
+	 */
+	static std::string resolve(const char* path);
+
+	/**
+	 * @return path as Hunspell must be given it: a trailing ".hz" is removed,
+	 *         since Hunspell looks for the compressed file itself
+	 */
+	static std::string hunspellPath(const char* path);
+
+private:
+	struct Node {
+		int next[2];
+		unsigned char bytes[2];
+	};
+
+	bool readCodes(const char* key);
+	bool decodeBlock();
+	int nextByte();
+
+	std::ifstream file;
+	bool compressed = false;
+	bool finished = false;
+	bool failed = false;
+	std::vector<Node> nodes;
+	int lastNode = 0;
+	std::vector<unsigned char> input;
+	size_t inputBits = 0;
+	size_t inputPosition = 0;
+	std::vector<unsigned char> output;
+	size_t outputSize = 0;
+	size_t outputPosition = 0;
+	std::string previous; // last decoded line with its '\n'; the next one may share its ends
+	std::string pending; // bytes of the line being decoded
+};
+
+/**
+ * @brief Compress a dictionary file in Hunspell's hzip format.
+ *
+ * Lines are stored as their difference to the previous line (shared prefix
+ * and suffix), then Huffman-coded two bytes at a time. With a key the code
+ * table is encrypted, so the file cannot be read without it. Hunspell and
+ * DictionaryFile read the result.
+ * @param key - NULL or empty for no encryption
+ * @return false if the input cannot be read or the output cannot be written
+ */
+bool WriteHzip(const char* inputPath, const char* outputPath, const char* key);
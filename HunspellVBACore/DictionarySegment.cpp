@@ -0,0 +1,324 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "DictionarySegment.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <sys/stat.h>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "AffixRules.h"
+#include "Automaton.h"
+#include "DictionaryFile.h"
+#include "SpellEngine.h"
+#include "Trace.h"
+#include "Utf.h"
+
+namespace
+{
+	/** Surface forms produced by one worker, packed into a single string. */
+	struct FormPool {
+		std::string text;
+		std::vector<std::pair<size_t, size_t>> forms;
+		uint64_t generated = 0;
+		uint64_t rejected = 0;
+	};
+
+	/** A POSIX lock file older than this was left behind by a builder that died. */
+	const time_t kStaleLockSeconds = 600;
+
+	/** Lock file that only one process at a time can create. */
+	class BuildLock {
+	public:
+		explicit BuildLock(const std::string& lockPath) : path(lockPath) {
+#ifdef _WIN32
+			// Deleted when closed, also when the process dies.
+			file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+				FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+#else
+			file = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+			struct stat info;
+			if (file < 0 && stat(path.c_str(), &info) == 0 && time(nullptr) - info.st_mtime > kStaleLockSeconds) {
+				std::remove(path.c_str());
+				file = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+			}
+#endif
+		}
+
+		~BuildLock() {
+#ifdef _WIN32
+			if (file != INVALID_HANDLE_VALUE) {
+				CloseHandle(file);
+			}
+#else
+			if (file >= 0) {
+				std::remove(path.c_str());
+				close(file);
+			}
+#endif
+		}
+
+		BuildLock(const BuildLock&) = delete;
+		BuildLock& operator=(const BuildLock&) = delete;
+
+#ifdef _WIN32
+		bool held() const { return file != INVALID_HANDLE_VALUE; }
+#else
+		bool held() const { return file >= 0; }
+#endif
+
+	private:
+		std::string path;
+#ifdef _WIN32
+		HANDLE file;
+#else
+		int file;
+#endif
+	};
+
+	const char* KeyOf(const std::vector<std::string>& keys, size_t index) {
+		return index < keys.size() && !keys[index].empty() ? keys[index].c_str() : nullptr;
+	}
+
+	void ExpandWorker(const std::string& affixPath, const std::vector<std::string>& dictionaryPaths,
+		const std::vector<std::string>& dictionaryKeys, bool verify, const AffixRules& rules, const std::vector<AffixRules::Entry>& entries, std::atomic<size_t>& next,
+		FormPool& pool, std::atomic<bool>& failed) {
+		std::unique_ptr<SpellEngine> engine;
+		if (verify) {
+			try {
+				engine.reset(new SpellEngine(affixPath.c_str(), dictionaryPaths[0].c_str(), true, KeyOf(dictionaryKeys, 0)));
+				for (size_t i = 1; i < dictionaryPaths.size(); ++i) {
+					engine->addDictionary(dictionaryPaths[i].c_str(), KeyOf(dictionaryKeys, i));
+				}
+			}
+			catch (const std::exception&) {
+				failed.store(true);
+				return;
+			}
+		}
+
+		// Entries are handed out in blocks; one entry is far too little work.
+		const size_t kBlock = 64;
+		std::string form;
+		for (size_t first = next.fetch_add(kBlock); first < entries.size(); first = next.fetch_add(kBlock)) {
+			size_t last = std::min(entries.size(), first + kBlock);
+			for (size_t index = first; index < last; ++index) {
+				rules.expand(entries[index], [&](std::u32string_view surface) {
+					form.clear();
+					AppendUtf8(surface, form);
+					++pool.generated;
+					if (engine && !engine->check(std::string_view(form))) {
+						++pool.rejected;
+						return;
+					}
+					pool.forms.emplace_back(pool.text.size(), form.size());
+					pool.text += form;
+				});
+			}
+		}
+	}
+
+	bool FileStamp(const std::string& path, uint64_t& size, int64_t& modified) {
+#ifdef _WIN32
+		struct _stat64 info;
+		if (_stat64(path.c_str(), &info) != 0) {
+			return false;
+		}
+#else
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0) {
+			return false;
+		}
+#endif
+		size = (uint64_t)info.st_size;
+		modified = (int64_t)info.st_mtime;
+		return true;
+	}
+
+	/** 64-bit FNV-1a */
+	void Hash(uint64_t& hash, const void* data, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; ++i) {
+			hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+		}
+	}
+
+	bool HashFile(uint64_t& hash, const std::string& path) {
+		uint64_t size;
+		int64_t modified;
+		std::string file = DictionaryFile::resolve(path.c_str());
+		if (file.empty() || !FileStamp(file, size, modified)) {
+			return false;
+		}
+		Hash(hash, file.c_str(), file.size() + 1);
+		Hash(hash, &size, sizeof(size));
+		Hash(hash, &modified, sizeof(modified));
+		return true;
+	}
+}
+
+int BuildDictionaryAutomaton(const std::string& affixPath, const std::vector<std::string>& dictionaryPaths,
+	const std::vector<std::string>& dictionaryKeys, unsigned threads, bool verify, const char* outputPath,
+	AutomatonBuildSummary& summary, const std::vector<std::string>* extraWords) {
+	TraceSpan span("build", "automaton");
+	AffixRules rules;
+	if (!rules.load(affixPath.c_str(), KeyOf(dictionaryKeys, 0))) {
+		return -1;
+	}
+	std::vector<AffixRules::Entry> entries;
+	for (size_t i = 0; i < dictionaryPaths.size(); ++i) {
+		if (!rules.readDictionary(dictionaryPaths[i].c_str(), entries, KeyOf(dictionaryKeys, i))) {
+			return -2;
+		}
+	}
+
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = (unsigned)std::min<size_t>(threads, entries.size() / 1024 + 1);
+	std::vector<FormPool> pools(threads);
+	std::atomic<size_t> next(0);
+	std::atomic<bool> failed(false);
+	std::vector<std::thread> workers;
+	for (unsigned i = 0; i < threads; ++i) {
+		workers.emplace_back(ExpandWorker, std::cref(affixPath), std::cref(dictionaryPaths), std::cref(dictionaryKeys),
+			verify, std::cref(rules), std::cref(entries), std::ref(next), std::ref(pools[i]), std::ref(failed));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	if (failed.load()) {
+		return -3;
+	}
+
+	summary = AutomatonBuildSummary();
+	summary.entries = entries.size();
+	summary.threads = threads;
+	size_t total = 0;
+	for (const FormPool& pool : pools) {
+		summary.forms += pool.generated;
+		summary.rejected += pool.rejected;
+		total += pool.forms.size();
+	}
+	std::vector<std::string_view> words;
+	words.reserve(total + (extraWords ? extraWords->size() : 0));
+	for (const FormPool& pool : pools) {
+		for (const auto& form : pool.forms) {
+			words.emplace_back(pool.text.data() + form.first, form.second);
+		}
+	}
+	if (extraWords) {
+		words.insert(words.end(), extraWords->begin(), extraWords->end());
+	}
+
+	AutomatonBuilder builder;
+	if (!builder.build(words, outputPath)) {
+		return -4;
+	}
+	summary.words = builder.wordCount();
+	summary.states = builder.stateCount();
+	summary.arcs = builder.arcCount();
+	return 0;
+}
+
+std::string DictionarySegmentPath(const std::string& directory, const std::string& affixPath,
+	const std::vector<std::string>& dictionaryPaths) {
+	// The format tag is part of the key, so a new file format never picks up an old segment.
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	Hash(hash, "HVDAWG01", 8);
+	if (!HashFile(hash, affixPath)) {
+		return std::string();
+	}
+	for (const std::string& path : dictionaryPaths) {
+		if (!HashFile(hash, path)) {
+			return std::string();
+		}
+	}
+
+	const std::string& dictionary = dictionaryPaths.empty() ? affixPath : dictionaryPaths[0];
+	size_t nameStart = dictionary.find_last_of("/\\");
+	nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+	size_t nameEnd = dictionary.find_last_of('.');
+	if (nameEnd == std::string::npos || nameEnd < nameStart) {
+		nameEnd = dictionary.size();
+	}
+
+	std::string path = directory;
+	if (!path.empty() && path.back() != '/' && path.back() != '\\') {
+		path += '/';
+	}
+	char key[24];
+	snprintf(key, sizeof(key), "-%016llx", (unsigned long long)hash);
+	path.append(dictionary, nameStart, nameEnd - nameStart);
+	path += key;
+	path += ".dawg";
+	return path;
+}
+
+int PublishDictionarySegment(const std::string& segmentPath, const std::string& affixPath,
+	const std::vector<std::string>& dictionaryPaths, const std::vector<std::string>& dictionaryKeys,
+	AutomatonBuildSummary& summary) {
+	BuildLock lock(segmentPath + ".lock");
+	if (!lock.held()) {
+		return -5;
+	}
+	// The last builder may have published it after this process looked.
+	Automaton published;
+	if (published.load(segmentPath.c_str())) {
+		return 0;
+	}
+
+#ifdef _WIN32
+	int process = _getpid();
+#else
+	int process = (int)getpid();
+#endif
+	std::string temporaryPath = segmentPath + "." + std::to_string(process) + ".tmp";
+	unsigned threads = std::min(std::max(1u, std::thread::hardware_concurrency()), kMaxSegmentThreads);
+	int result = BuildDictionaryAutomaton(affixPath, dictionaryPaths, dictionaryKeys, threads, true, temporaryPath.c_str(), summary);
+	if (result == 0 && std::rename(temporaryPath.c_str(), segmentPath.c_str()) == 0) {
+		return 0;
+	}
+	// Windows does not replace an existing file: a process that took the
+	// lock after a crashed builder published the segment first.
+	std::remove(temporaryPath.c_str());
+	return result;
+}
@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Counts reported by BuildDictionaryAutomaton. */
+struct AutomatonBuildSummary {
+	uint64_t entries = 0;
+	uint64_t forms = 0;
+	uint64_t rejected = 0;
+	uint64_t words = 0;
+	uint64_t states = 0;
+	uint64_t arcs = 0;
+	unsigned threads = 0;
+};
+
+/**
+ * @brief Expand dictionaries into their surface forms and write them as a minimal automaton.
+ *
+ * Every .dic entry is expanded with the suffix and prefix rules of the .aff
+ * file. With verify set, each worker thread loads its own SpellEngine and
+ * only the forms Hunspell accepts are kept, so the automaton never accepts a
+ * word Hunspell would reject.
+ *
+ * @param dictionaryKeys - keys of hzip-encrypted files, one per dictionary
+ *        (empty for none; the first also opens the .aff file), or no keys at all
+ * @param threads - worker threads, 0 for one per hardware thread
+ * @param extraWords - words added at runtime, taken as they are, or NULL
+ * @return 0 on success, -1 affix file unreadable (or unsupported SET),
+ *         -2 a dictionary unreadable, -3 Hunspell could not be loaded,
+ *         -4 the output cannot be written
+ */
+int BuildDictionaryAutomaton(const std::string& affixPath, const std::vector<std::string>& dictionaryPaths,
+	const std::vector<std::string>& dictionaryKeys, unsigned threads, bool verify, const char* outputPath,
+	AutomatonBuildSummary& summary, const std::vector<std::string>* extraWords = nullptr);
+
+/** Worker threads PublishDictionarySegment builds with, at most. */
+const unsigned kMaxSegmentThreads = 4;
+
+/**
+ * @brief File that holds the shared automaton of a set of dictionary files.
+ *
+ * The name is the first dictionary's base name followed by a hash of every
+ * path, size and modification time, so processes using the same files find
+ * the same segment and an edited dictionary gets a new one.
+ *
+ * @param directory - where segments are kept, shared by the processes
+ * @return empty if one of the files does not exist
+ */
+std::string DictionarySegmentPath(const std::string& directory, const std::string& affixPath,
+	const std::vector<std::string>& dictionaryPaths);
+
+/**
+ * @brief Write the automaton to a temporary file and move it to segmentPath.
+ *
+ * Readers never see a half-written segment. Only the process that creates
+ * segmentPath + ".lock" builds; the others return at once instead of
+ * verifying the same forms with Hunspells of their own. The build uses at
+ * most kMaxSegmentThreads workers, since each loads a Hunspell.
+ * @return BuildDictionaryAutomaton's result, or -5 if another process is
+ *         building the segment
+ */
+int PublishDictionarySegment(const std::string& segmentPath, const std::string& affixPath,
+	const std::vector<std::string>& dictionaryPaths, const std::vector<std::string>& dictionaryKeys,
+	AutomatonBuildSummary& summary);
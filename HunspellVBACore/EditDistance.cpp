@@ -0,0 +1,352 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "EditDistance.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HUNSPELLVBA_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles AVX2 intrinsics without a flag; GCC and Clang need the
+// function marked so the rest of the file stays baseline x86-64.
+#if defined(__GNUC__) || defined(__clang__)
+#define HUNSPELLVBA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HUNSPELLVBA_TARGET_AVX2
+#endif
+
+namespace
+{
+	size_t LongestCommonSubsequence(std::u32string_view a, std::u32string_view b) {
+		// Dictionary words fit in the stack buffer, as in EditDistance().
+		size_t stackRow[65];
+		std::vector<size_t> heapRow;
+		size_t* row = stackRow;
+		if (b.size() + 1 > sizeof(stackRow) / sizeof(stackRow[0])) {
+			heapRow.resize(b.size() + 1);
+			row = heapRow.data();
+		}
+		std::fill(row, row + b.size() + 1, 0);
+		for (size_t i = 1; i <= a.size(); ++i) {
+			size_t diagonal = 0;
+			for (size_t j = 1; j <= b.size(); ++j) {
+				size_t above = row[j];
+				row[j] = a[i - 1] == b[j - 1] ? diagonal + 1 : std::max(row[j], row[j - 1]);
+				diagonal = above;
+			}
+		}
+		return row[b.size()];
+	}
+
+	/** Substrings of a of length 1..n that also occur in b. */
+	int Ngram(size_t n, std::u32string_view a, std::u32string_view b) {
+		int score = 0;
+		for (size_t length = 1; length <= n && length <= a.size(); ++length) {
+			for (size_t i = 0; i + length <= a.size(); ++i) {
+				if (b.find(a.substr(i, length)) != std::u32string_view::npos) {
+					++score;
+				}
+			}
+		}
+		return score;
+	}
+}
+
+int EditDistance(std::u32string_view a, std::u32string_view b, int maxDistance) {
+	// Common prefix and suffix never change the distance.
+	while (!a.empty() && !b.empty() && a.front() == b.front()) {
+		a.remove_prefix(1);
+		b.remove_prefix(1);
+	}
+	while (!a.empty() && !b.empty() && a.back() == b.back()) {
+		a.remove_suffix(1);
+		b.remove_suffix(1);
+	}
+	if (a.size() > b.size()) {
+		std::swap(a, b);
+	}
+
+	const int n = (int)a.size();
+	const int m = (int)b.size();
+	if (m - n > maxDistance) {
+		return maxDistance + 1;
+	}
+	if (n == 0) {
+		return m;
+	}
+
+	// Three rolling rows; cells further than maxDistance from the diagonal
+	// cannot lead to a result within the bound and are left at "too large".
+	// Dictionary words fit in the stack buffer.
+	const int tooLarge = maxDistance + 1;
+	const size_t width = (size_t)m + 1;
+	int stackRows[3 * 64];
+	std::vector<int> heapRows;
+	int* rows = stackRows;
+	if (3 * width > sizeof(stackRows) / sizeof(stackRows[0])) {
+		heapRows.resize(3 * width);
+		rows = heapRows.data();
+	}
+	std::fill(rows, rows + 3 * width, tooLarge);
+	int* previous2 = rows;
+	int* previous = previous2 + width;
+	int* current = previous + width;
+	for (int j = 0; j <= std::min(m, maxDistance); ++j) {
+		previous[j] = j;
+	}
+
+	for (int i = 1; i <= n; ++i) {
+		int from = std::max(1, i - maxDistance);
+		int to = std::min(m, i + maxDistance);
+		// Only the band and the cell left of it are read by the next row.
+		std::fill(current + std::max(0, from - 1), current + std::min(m, to + 1) + 1, tooLarge);
+		current[0] = i <= maxDistance ? i : tooLarge;
+		int rowMinimum = current[0];
+		for (int j = from; j <= to; ++j) {
+			int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+			int value = std::min({ previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost });
+			if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+				value = std::min(value, previous2[j - 2] + 1);
+			}
+			current[j] = std::min(value, tooLarge);
+			rowMinimum = std::min(rowMinimum, current[j]);
+		}
+		if (rowMinimum > maxDistance) {
+			return tooLarge;
+		}
+		std::swap(previous2, previous);
+		std::swap(previous, current);
+	}
+	return previous[m];
+}
+
+int Similarity(std::u32string_view word, std::u32string_view candidate) {
+	int lengthDifference = std::abs((int)word.size() - (int)candidate.size());
+	size_t common = 0;
+	while (common < word.size() && common < candidate.size() && word[common] == candidate[common]) {
+		++common;
+	}
+	return Ngram(4, word, candidate) + 2 * (int)LongestCommonSubsequence(word, candidate)
+		- 2 * lengthDifference + (int)common;
+}
+
+DistancePattern::DistancePattern(std::u32string_view word, std::pmr::memory_resource* memory)
+	: word(word, memory), otherMasks(memory) {
+	std::fill(asciiMasks, asciiMasks + 128, 0);
+	if (word.size() > kMaxLength) {
+		return;
+	}
+	for (size_t i = 0; i < word.size(); ++i) {
+		char32_t c = word[i];
+		if (c < 128) {
+			asciiMasks[c] |= 1ull << i;
+			continue;
+		}
+		auto found = std::lower_bound(otherMasks.begin(), otherMasks.end(), std::make_pair(c, (uint64_t)0));
+		if (found == otherMasks.end() || found->first != c) {
+			found = otherMasks.insert(found, std::make_pair(c, (uint64_t)0));
+		}
+		found->second |= 1ull << i;
+	}
+}
+
+int DistancePattern::distance(std::u32string_view candidate, int maxDistance) const {
+	const size_t m = word.size();
+	if (m > kMaxLength || m == 0) {
+		return EditDistance(word, candidate, maxDistance);
+	}
+	const int tooLarge = maxDistance + 1;
+	const int n = (int)candidate.size();
+	if (std::abs(n - (int)m) > maxDistance) {
+		return tooLarge;
+	}
+
+	// vp/vn: vertical +1/-1 deltas of the current column, d0: diagonal
+	// zero-deltas; score tracks the bottom cell, i.e. the distance so far.
+	const uint64_t last = 1ull << (m - 1);
+	uint64_t vp = m == 64 ? ~0ull : (1ull << m) - 1;
+	uint64_t vn = 0;
+	uint64_t d0 = 0;
+	uint64_t previousMatch = 0;
+	int score = (int)m;
+	for (int j = 0; j < n; ++j) {
+		uint64_t match = matchMask(candidate[j]);
+		uint64_t transposed = ((~d0 & match) << 1) & previousMatch;
+		d0 = (((match & vp) + vp) ^ vp) | match | vn | transposed;
+		uint64_t hp = vn | ~(d0 | vp);
+		uint64_t hn = d0 & vp;
+		score += (hp & last) ? 1 : 0;
+		score -= (hn & last) ? 1 : 0;
+		hp = (hp << 1) | 1;
+		hn <<= 1;
+		vp = hn | ~(d0 | hp);
+		vn = hp & d0;
+		previousMatch = match;
+		// Each remaining character can lower the distance by one at most.
+		if (score - (n - j - 1) > maxDistance) {
+			return tooLarge;
+		}
+	}
+	return std::min(score, tooLarge);
+}
+
+#ifdef HUNSPELLVBA_X86
+namespace
+{
+	/** distance() for four candidates at a time, one per 64-bit lane. */
+	HUNSPELLVBA_TARGET_AVX2
+	void DistancesAvx2(const DistancePattern& pattern, size_t m, const std::u32string_view* candidates,
+		size_t count, int maxDistance, int* out) {
+		const __m256i last = _mm256_set1_epi64x((long long)(1ull << (m - 1)));
+		const __m256i one = _mm256_set1_epi64x(1);
+		const __m256i allOnes = _mm256_set1_epi64x(-1);
+		const __m256i full = _mm256_set1_epi64x(m == 64 ? -1ll : (long long)((1ull << m) - 1));
+		const int tooLarge = maxDistance + 1;
+
+		// Candidates whose length alone rules them out never take a lane.
+		std::pmr::vector<size_t> eligible(pattern.memory());
+		eligible.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			if (std::abs((int)candidates[i].size() - (int)m) > maxDistance) {
+				out[i] = tooLarge;
+			}
+			else {
+				eligible.push_back(i);
+			}
+		}
+
+		for (size_t first = 0; first < eligible.size(); first += 4) {
+			size_t lanes = std::min<size_t>(4, eligible.size() - first);
+			std::u32string_view lane[4];
+			size_t longest = 0;
+			for (size_t k = 0; k < lanes; ++k) {
+				lane[k] = candidates[eligible[first + k]];
+				longest = std::max(longest, lane[k].size());
+			}
+			const __m256i lengths = _mm256_set_epi64x((long long)lane[3].size(), (long long)lane[2].size(),
+				(long long)lane[1].size(), (long long)lane[0].size());
+
+			__m256i vp = full;
+			__m256i vn = _mm256_setzero_si256();
+			__m256i d0 = _mm256_setzero_si256();
+			__m256i previousMatch = _mm256_setzero_si256();
+			__m256i score = _mm256_set1_epi64x((long long)m);
+			for (size_t j = 0; j < longest; ++j) {
+				auto maskAt = [&](int k) {
+					return j < lane[k].size() ? (long long)pattern.matchMask(lane[k][j]) : 0ll;
+				};
+				__m256i pm = _mm256_set_epi64x(maskAt(3), maskAt(2), maskAt(1), maskAt(0));
+				__m256i running = _mm256_cmpgt_epi64(lengths, _mm256_set1_epi64x((long long)j));
+
+				__m256i transposed = _mm256_and_si256(_mm256_slli_epi64(_mm256_andnot_si256(d0, pm), 1), previousMatch);
+				__m256i sum = _mm256_add_epi64(_mm256_and_si256(pm, vp), vp);
+				__m256i nextD0 = _mm256_or_si256(_mm256_or_si256(_mm256_xor_si256(sum, vp), pm),
+					_mm256_or_si256(vn, transposed));
+				__m256i hp = _mm256_or_si256(vn, _mm256_andnot_si256(_mm256_or_si256(nextD0, vp), allOnes));
+				__m256i hn = _mm256_and_si256(nextD0, vp);
+				// Compare results are all ones (-1) in lanes whose bottom cell moved.
+				__m256i nextScore = _mm256_sub_epi64(score, _mm256_cmpeq_epi64(_mm256_and_si256(hp, last), last));
+				nextScore = _mm256_add_epi64(nextScore, _mm256_cmpeq_epi64(_mm256_and_si256(hn, last), last));
+				hp = _mm256_or_si256(_mm256_slli_epi64(hp, 1), one);
+				hn = _mm256_slli_epi64(hn, 1);
+				__m256i nextVp = _mm256_or_si256(hn, _mm256_andnot_si256(_mm256_or_si256(nextD0, hp), allOnes));
+				__m256i nextVn = _mm256_and_si256(hp, nextD0);
+
+				// Lanes whose candidate has ended keep their final state.
+				vp = _mm256_blendv_epi8(vp, nextVp, running);
+				vn = _mm256_blendv_epi8(vn, nextVn, running);
+				d0 = _mm256_blendv_epi8(d0, nextD0, running);
+				previousMatch = _mm256_blendv_epi8(previousMatch, pm, running);
+				score = _mm256_blendv_epi8(score, nextScore, running);
+			}
+
+			alignas(32) long long scores[4];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(scores), score);
+			for (size_t k = 0; k < lanes; ++k) {
+				out[eligible[first + k]] = (int)std::min<long long>(scores[k], tooLarge);
+			}
+		}
+	}
+}
+#endif
+
+void DistancePattern::distances(const std::u32string_view* candidates, size_t count, int maxDistance, int* out) const {
+#ifdef HUNSPELLVBA_X86
+	if (count >= 4 && !word.empty() && word.size() <= kMaxLength && hasAvx2()) {
+		DistancesAvx2(*this, word.size(), candidates, count, maxDistance, out);
+		return;
+	}
+#endif
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = distance(candidates[i], maxDistance);
+	}
+}
+
+bool DistancePattern::hasAvx2() {
+#if defined(HUNSPELLVBA_X86) && defined(_MSC_VER)
+	static const bool supported = []() {
+		int info[4];
+		__cpuid(info, 1);
+		bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0
+			&& (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		return osSavesYmm && (info[1] & (1 << 5)) != 0;
+	}();
+	return supported;
+#elif defined(HUNSPELLVBA_X86)
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+#else
+	return false;
+#endif
+}
+
+void RankByDistance(std::u32string_view word, const std::vector<std::u32string_view>& candidates,
+	int* distances, int* order) {
+	size_t longest = word.size();
+	for (std::u32string_view candidate : candidates) {
+		longest = std::max(longest, candidate.size());
+	}
+	// A bound no pair can exceed makes every distance exact.
+	std::vector<int> scores(candidates.size());
+	DistancePattern(word).distances(candidates.data(), candidates.size(), (int)longest, scores.data());
+	if (distances != nullptr) {
+		std::copy(scores.begin(), scores.end(), distances);
+	}
+	if (order != nullptr) {
+		std::vector<int> indexes(candidates.size());
+		for (size_t i = 0; i < indexes.size(); ++i) {
+			indexes[i] = (int)i;
+		}
+		std::stable_sort(indexes.begin(), indexes.end(), [&](int a, int b) { return scores[a] < scores[b]; });
+		std::copy(indexes.begin(), indexes.end(), order);
+	}
+}
@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Optimal string alignment distance between two words.
+ *
+ * Insertions, deletions, substitutions and transpositions of adjacent
+ * characters cost 1 each (restricted Damerau-Levenshtein), which is how
+ * keyboard typos are usually counted.
+ *
+ * @param maxDistance - the computation stops once the distance is known to
+ *        exceed this bound
+ * @return the distance, or maxDistance + 1 if it is larger than maxDistance
+ */
+int EditDistance(std::u32string_view a, std::u32string_view b, int maxDistance);
+
+/**
+ * @brief Similarity in the spirit of the score Hunspell's ngsuggest sorts its
+ * final candidates by.
+ *
+ * Shared n-grams, longest common subsequence and common prefix, minus the
+ * length difference. Higher is more similar.
+ */
+int Similarity(std::u32string_view word, std::u32string_view candidate);
+
+/**
+ * @brief EditDistance() from one word to many candidates, bit-parallel.
+ *
+ * Myers' bit-vector algorithm with Hyyro's transposition extension keeps a
+ * whole column of the distance table in one 64-bit word, so each candidate
+ * character costs a handful of word operations instead of a row of cells.
+ * distances() runs four candidates side by side in AVX2 registers when the
+ * CPU has them. Words longer than kMaxLength fall back to EditDistance().
+ */
+class DistancePattern {
+public:
+	static const size_t kMaxLength = 64;
+
+	/** @param memory - where the pattern and distances() keep their buffers */
+	explicit DistancePattern(std::u32string_view word,
+		std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+	/** Same result as EditDistance(word, candidate, maxDistance). */
+	int distance(std::u32string_view candidate, int maxDistance) const;
+
+	/** distance() of every candidate, written to out[0..count). */
+	void distances(const std::u32string_view* candidates, size_t count, int maxDistance, int* out) const;
+
+	/** @return bit i set where the word has c at position i */
+	uint64_t matchMask(char32_t c) const {
+		if (c < 128) {
+			return asciiMasks[c];
+		}
+		auto found = std::lower_bound(otherMasks.begin(), otherMasks.end(), std::make_pair(c, (uint64_t)0));
+		return found != otherMasks.end() && found->first == c ? found->second : 0;
+	}
+
+	/** @return true if distances() uses AVX2 on this CPU */
+	static bool hasAvx2();
+
+	std::pmr::memory_resource* memory() const { return word.get_allocator().resource(); }
+
+private:
+	std::pmr::u32string word;
+	uint64_t asciiMasks[128];
+	std::pmr::vector<std::pair<char32_t, uint64_t>> otherMasks; // sorted by code point
+};
+
+/**
+ * @brief Order candidates by edit distance from word, closest first.
+ *
+ * Candidates at equal distance keep their relative order, so a list that
+ * is already ranked (such as Hunspell's suggestions) only moves where the
+ * distance disagrees with it.
+ *
+ * @param distances - receives the distance of each candidate; may be null
+ * @param order - receives candidate indexes, closest first; may be null
+ */
+void RankByDistance(std::u32string_view word, const std::vector<std::u32string_view>& candidates,
+	int* distances, int* order);
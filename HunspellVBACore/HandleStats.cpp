@@ -0,0 +1,140 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "HandleStats.h"
+#include <cstdio>
+
+namespace
+{
+	void AppendField(std::string& out, const char* name, const std::atomic<uint64_t>& value, bool comma = true) {
+		out += '"';
+		out += name;
+		out += "\":";
+		out += std::to_string(value.load(std::memory_order_relaxed));
+		if (comma) {
+			out += ',';
+		}
+	}
+
+	/** "name":{"lookups":..,"hits":..,"hit_rate":..}, for a table consulted before Hunspell */
+	void AppendLookups(std::string& out, const char* name, const std::atomic<uint64_t>& lookups, const std::atomic<uint64_t>& hits) {
+		out += '"';
+		out += name;
+		out += "\":{";
+		AppendField(out, "lookups", lookups);
+		AppendField(out, "hits", hits);
+		uint64_t total = lookups.load(std::memory_order_relaxed);
+		char hitRate[32];
+		snprintf(hitRate, sizeof(hitRate), "%.4f",
+			total == 0 ? 0.0 : (double)hits.load(std::memory_order_relaxed) / (double)total);
+		out += "\"hit_rate\":";
+		out += hitRate;
+		out += "},";
+	}
+}
+
+void LatencyHistogram::appendJson(std::string& out) const {
+	out += '{';
+	AppendField(out, "count", count);
+	AppendField(out, "total_ns", totalNs);
+	out += "\"histogram_us\":[";
+	for (int i = 0; i < kBuckets; ++i) {
+		if (i != 0) {
+			out += ',';
+		}
+		out += std::to_string(buckets[i].load(std::memory_order_relaxed));
+	}
+	out += "]}";
+}
+
+void HandleStats::reset() {
+	checkCalls.store(0, std::memory_order_relaxed);
+	misspellingsCalls.store(0, std::memory_order_relaxed);
+	suggestCalls.store(0, std::memory_order_relaxed);
+	suffixSuggestCalls.store(0, std::memory_order_relaxed);
+	addWordCalls.store(0, std::memory_order_relaxed);
+	addDictionaryCalls.store(0, std::memory_order_relaxed);
+	analyzeCalls.store(0, std::memory_order_relaxed);
+	stemCalls.store(0, std::memory_order_relaxed);
+	generateCalls.store(0, std::memory_order_relaxed);
+	stemTextCalls.store(0, std::memory_order_relaxed);
+	wordsChecked.store(0, std::memory_order_relaxed);
+	misses.store(0, std::memory_order_relaxed);
+	bytesConverted.store(0, std::memory_order_relaxed);
+	suggestionsReturned.store(0, std::memory_order_relaxed);
+	correctionLookups.store(0, std::memory_order_relaxed);
+	correctionHits.store(0, std::memory_order_relaxed);
+	automatonLookups.store(0, std::memory_order_relaxed);
+	automatonHits.store(0, std::memory_order_relaxed);
+	filteredDigits.store(0, std::memory_order_relaxed);
+	filteredUrls.store(0, std::memory_order_relaxed);
+	filteredEmails.store(0, std::memory_order_relaxed);
+	filteredUppercase.store(0, std::memory_order_relaxed);
+	skippedLength.store(0, std::memory_order_relaxed);
+	skippedBudget.store(0, std::memory_order_relaxed);
+	skippedTimeout.store(0, std::memory_order_relaxed);
+	spellLatency.reset();
+	suggestLatency.reset();
+}
+
+std::string HandleStats::toJson() const {
+	std::string out;
+	out.reserve(512);
+	out += "{\"enabled\":";
+	out += isEnabled() ? "true" : "false";
+	out += ",\"calls\":{";
+	AppendField(out, "check", checkCalls);
+	AppendField(out, "misspellings", misspellingsCalls);
+	AppendField(out, "suggest", suggestCalls);
+	AppendField(out, "suffix_suggest", suffixSuggestCalls);
+	AppendField(out, "add_word", addWordCalls);
+	AppendField(out, "add_dictionary", addDictionaryCalls);
+	AppendField(out, "analyze", analyzeCalls);
+	AppendField(out, "stem", stemCalls);
+	AppendField(out, "generate", generateCalls);
+	AppendField(out, "stem_text", stemTextCalls, false);
+	out += "},";
+	AppendField(out, "words_checked", wordsChecked);
+	AppendField(out, "misses", misses);
+	AppendField(out, "bytes_converted", bytesConverted);
+	AppendField(out, "suggestions_returned", suggestionsReturned);
+	AppendLookups(out, "corrections", correctionLookups, correctionHits);
+	AppendLookups(out, "automaton", automatonLookups, automatonHits);
+	out += "\"filtered\":{";
+	AppendField(out, "digits", filteredDigits);
+	AppendField(out, "urls", filteredUrls);
+	AppendField(out, "emails", filteredEmails);
+	AppendField(out, "uppercase", filteredUppercase, false);
+	out += "},";
+	out += "\"skipped\":{";
+	AppendField(out, "length", skippedLength);
+	AppendField(out, "budget", skippedBudget);
+	AppendField(out, "timeout", skippedTimeout, false);
+	out += "},";
+	out += "\"spell\":";
+	spellLatency.appendJson(out);
+	out += ",\"suggest\":";
+	suggestLatency.appendJson(out);
+	out += '}';
+	return out;
+}
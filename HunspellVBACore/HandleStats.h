@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Lock-free latency histogram with power-of-two microsecond buckets.
+ *
+ * Bucket 0 counts calls faster than 1 us, bucket i counts calls in
+ * [2^(i-1), 2^i) us, and the last bucket collects everything slower.
+ */
+class LatencyHistogram {
+public:
+	static const int kBuckets = 22;
+
+	LatencyHistogram() { reset(); }
+
+	void record(uint64_t ns) {
+		uint64_t us = ns / 1000;
+		int bucket = 0;
+		while (us != 0 && bucket < kBuckets - 1) {
+			us >>= 1;
+			++bucket;
+		}
+		buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		totalNs.fetch_add(ns, std::memory_order_relaxed);
+	}
+
+	void reset() {
+		for (int i = 0; i < kBuckets; ++i) {
+			buckets[i].store(0, std::memory_order_relaxed);
+		}
+		count.store(0, std::memory_order_relaxed);
+		totalNs.store(0, std::memory_order_relaxed);
+	}
+
+	void appendJson(std::string& out) const;
+
+	std::atomic<uint64_t> buckets[kBuckets];
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> totalNs;
+};
+
+/**
+ * @brief Runtime counters kept by every handle.
+ *
+ * All members are relaxed atomics, so updating them never takes a lock. When
+ * enabled is false the exports skip every update, including the clock reads,
+ * and the only cost left is one relaxed load per call.
+ */
+struct HandleStats {
+	HandleStats() : enabled(false) { reset(); }
+
+	bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	void add(std::atomic<uint64_t>& counter, uint64_t value = 1) {
+		counter.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	void reset();
+	std::string toJson() const;
+
+	std::atomic<bool> enabled;
+
+	std::atomic<uint64_t> checkCalls;
+	std::atomic<uint64_t> misspellingsCalls;
+	std::atomic<uint64_t> suggestCalls;
+	std::atomic<uint64_t> suffixSuggestCalls;
+	std::atomic<uint64_t> addWordCalls;
+	std::atomic<uint64_t> addDictionaryCalls;
+	std::atomic<uint64_t> analyzeCalls;
+	std::atomic<uint64_t> stemCalls;
+	std::atomic<uint64_t> generateCalls;
+	std::atomic<uint64_t> stemTextCalls;
+
+	std::atomic<uint64_t> wordsChecked;
+	std::atomic<uint64_t> misses;
+	std::atomic<uint64_t> bytesConverted;
+	std::atomic<uint64_t> suggestionsReturned;
+	std::atomic<uint64_t> correctionLookups;
+	std::atomic<uint64_t> correctionHits;
+	std::atomic<uint64_t> automatonLookups;
+	std::atomic<uint64_t> automatonHits;
+	std::atomic<uint64_t> filteredDigits;
+	std::atomic<uint64_t> filteredUrls;
+	std::atomic<uint64_t> filteredEmails;
+	std::atomic<uint64_t> filteredUppercase;
+	std::atomic<uint64_t> skippedLength;
+	std::atomic<uint64_t> skippedBudget;
+	std::atomic<uint64_t> skippedTimeout;
+
+	LatencyHistogram spellLatency;
+	LatencyHistogram suggestLatency;
+};
+
+/**
+ * @brief Records the lifetime of the scope into a histogram when stats are enabled.
+ */
+class StatsTimer {
+public:
+	StatsTimer(const HandleStats& stats, LatencyHistogram& histogram)
+		: histogram(stats.isEnabled() ? &histogram : nullptr) {
+		if (this->histogram != nullptr) {
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	~StatsTimer() {
+		if (histogram != nullptr) {
+			auto elapsed = std::chrono::steady_clock::now() - start;
+			histogram->record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		}
+	}
+
+	StatsTimer(const StatsTimer&) = delete;
+	StatsTimer& operator=(const StatsTimer&) = delete;
+
+private:
+	LatencyHistogram* histogram;
+	std::chrono::steady_clock::time_point start;
+};
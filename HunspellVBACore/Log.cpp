@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "Log.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	const char* LevelName(LogLevel level) {
+		switch (level) {
+		case LogLevel::Debug: return "DEBUG";
+		case LogLevel::Info: return "INFO";
+		case LogLevel::Warning: return "WARNING";
+		case LogLevel::Error: return "ERROR";
+		default: return "OFF";
+		}
+	}
+
+	uint64_t SteadySeconds() {
+		return (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	uint64_t WallClockMs() {
+		return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+}
+
+Logger& Logger::instance() {
+	static Logger logger;
+	return logger;
+}
+
+Logger::Logger() : level((int)LogLevel::Warning), next(0), sinkRunning(false), flushed(0) {
+	for (size_t i = 0; i < kCapacity; ++i) {
+		slots[i].sequence.store(0, std::memory_order_relaxed);
+	}
+}
+
+Logger::~Logger() {
+	setFile(nullptr);
+}
+
+void Logger::write(LogSite& site, long long value, const char* detail) {
+	uint64_t second = SteadySeconds();
+	uint64_t windowStart = site.windowStart.load(std::memory_order_relaxed);
+	if (windowStart != second && site.windowStart.compare_exchange_strong(windowStart, second, std::memory_order_relaxed)) {
+		site.windowCount.store(0, std::memory_order_relaxed);
+	}
+	if (site.windowCount.fetch_add(1, std::memory_order_relaxed) >= kMaxPerSecond) {
+		site.suppressed.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	uint64_t sequence = next.fetch_add(1, std::memory_order_relaxed) + 1;
+	Slot& slot = slots[sequence & (kCapacity - 1)];
+
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.timestampMs.store(WallClockMs(), std::memory_order_relaxed);
+	slot.site.store(&site, std::memory_order_relaxed);
+	slot.value.store(value, std::memory_order_relaxed);
+	slot.suppressed.store(site.suppressed.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+
+	// Pack the detail text into whole words so the copy stays race-free.
+	size_t length = detail != nullptr ? strnlen(detail, kDetailSize) : 0;
+	for (size_t word = 0; word < kDetailWords; ++word) {
+		uint64_t packed = 0;
+		size_t offset = word * sizeof(uint64_t);
+		if (offset < length) {
+			memcpy(&packed, detail + offset, length - offset < sizeof(uint64_t) ? length - offset : sizeof(uint64_t));
+		}
+		slot.detail[word].store(packed, std::memory_order_relaxed);
+		if (offset >= length) {
+			break;
+		}
+	}
+	slot.sequence.store(sequence, std::memory_order_release);
+}
+
+bool Logger::read(uint64_t sequence, Entry& entry) const {
+	const Slot& slot = slots[sequence & (kCapacity - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+		return false;
+	}
+
+	entry.sequence = sequence;
+	entry.timestampMs = slot.timestampMs.load(std::memory_order_relaxed);
+	entry.site = slot.site.load(std::memory_order_relaxed);
+	entry.value = slot.value.load(std::memory_order_relaxed);
+	entry.suppressed = slot.suppressed.load(std::memory_order_relaxed);
+	for (size_t word = 0; word < kDetailWords; ++word) {
+		uint64_t packed = slot.detail[word].load(std::memory_order_relaxed);
+		memcpy(entry.detail + word * sizeof(uint64_t), &packed, sizeof(uint64_t));
+		if (memchr(&packed, 0, sizeof(uint64_t)) != nullptr) {
+			break;
+		}
+	}
+	entry.detail[kDetailSize] = '\0';
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+void Logger::format(const Entry& entry, std::string& out) {
+	char prefix[64];
+	snprintf(prefix, sizeof(prefix), "%llu %s ", (unsigned long long)entry.timestampMs, LevelName(entry.site->level));
+	out += prefix;
+	out += entry.site->message;
+	if (entry.detail[0] != '\0') {
+		out += ' ';
+		out += entry.detail;
+	}
+	if (entry.value != 0) {
+		out += ' ';
+		out += std::to_string(entry.value);
+	}
+	if (entry.suppressed != 0) {
+		out += " (";
+		out += std::to_string(entry.suppressed);
+		out += " similar messages suppressed)";
+	}
+	out += '\n';
+}
+
+bool Logger::setFile(const char* path) {
+	std::lock_guard<std::mutex> lock(sinkMutex);
+
+	if (sinkThread.joinable()) {
+		sinkRunning.store(false, std::memory_order_relaxed);
+		sinkThread.join();
+	}
+	if (sinkFile.is_open()) {
+		flushPending(sinkFile);
+		sinkFile.close();
+	}
+	if (path == nullptr) {
+		return true;
+	}
+
+	sinkFile.clear();
+	sinkFile.open(path, std::ios::out | std::ios::app);
+	if (!sinkFile.is_open()) {
+		return false;
+	}
+	flushed = next.load(std::memory_order_relaxed);
+	sinkRunning.store(true, std::memory_order_relaxed);
+	sinkThread = std::thread(&Logger::flushLoop, this);
+	return true;
+}
+
+void Logger::flushLoop() {
+	while (sinkRunning.load(std::memory_order_relaxed)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		flushPending(sinkFile);
+	}
+}
+
+void Logger::flushPending(std::ostream& file) {
+	uint64_t last = next.load(std::memory_order_acquire);
+	if (last == flushed) {
+		return;
+	}
+
+	std::string out;
+	if (last - flushed > kCapacity) {
+		out += std::to_string(last - flushed - kCapacity) + " log entries lost\n";
+		flushed = last - kCapacity;
+	}
+
+	Entry entry;
+	for (uint64_t sequence = flushed + 1; sequence <= last; ++sequence) {
+		if (!read(sequence, entry)) {
+			uint64_t published = slots[sequence & (kCapacity - 1)].sequence.load(std::memory_order_acquire);
+			if (published < sequence) {
+				break; // still being written, pick it up on the next pass
+			}
+		}
+		else {
+			format(entry, out);
+		}
+		flushed = sequence;
+	}
+
+	file << out;
+	file.flush();
+}
+
+int Logger::dump(const char* path) {
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		return -1;
+	}
+
+	uint64_t last = next.load(std::memory_order_acquire);
+	uint64_t first = last > kCapacity ? last - kCapacity + 1 : 1;
+	std::string out;
+	Entry entry;
+	int written = 0;
+	for (uint64_t sequence = first; sequence <= last; ++sequence) {
+		if (read(sequence, entry)) {
+			format(entry, out);
+			++written;
+		}
+	}
+
+	file << out;
+	return file.good() ? written : -1;
+}
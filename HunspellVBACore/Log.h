@@ -0,0 +1,153 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+enum class LogLevel : int {
+	Debug = 0,
+	Info = 1,
+	Warning = 2,
+	Error = 3,
+	Off = 4
+};
+
+/**
+ * @brief Per call-site state used for rate limiting.
+ *
+ * One static instance lives at every HUNSPELL_LOG call site. A site writes at
+ * most Logger::kMaxPerSecond entries per second; the rest are counted and the
+ * count is attached to the next entry that gets through.
+ */
+struct LogSite {
+	LogSite(LogLevel level, const char* message)
+		: level(level), message(message), windowStart(0), windowCount(0), suppressed(0) {
+	}
+
+	const LogLevel level;
+	const char* const message;
+	std::atomic<uint64_t> windowStart;
+	std::atomic<uint32_t> windowCount;
+	std::atomic<uint64_t> suppressed;
+};
+
+/**
+ * @brief Leveled logger writing into a lock-free in-memory ring buffer.
+ *
+ * Writing an entry never formats text, takes a lock or touches a file: the
+ * message pointer, an optional number and up to kDetailSize bytes of detail
+ * text are copied into a slot claimed with one fetch_add. Formatting happens
+ * when the buffer is dumped or, if a file sink is set, on a background thread
+ * that polls the buffer.
+ */
+class Logger {
+public:
+	static const size_t kCapacity = 1024;
+	static const size_t kDetailSize = 96;
+	static const uint32_t kMaxPerSecond = 10;
+
+	static Logger& instance();
+
+	bool accepts(LogLevel level) const {
+		return (int)level >= this->level.load(std::memory_order_relaxed);
+	}
+
+	void setLevel(LogLevel level) { this->level.store((int)level, std::memory_order_relaxed); }
+
+	void write(LogSite& site, long long value, const char* detail);
+
+	/**
+	 * @brief Append entries to a file from a background thread.
+	 *
+	 * Passing NULL stops the thread after a final flush. The sink must be
+	 * stopped before the module is unloaded.
+	 *
+	 * @return true if the file could be opened
+	 */
+	bool setFile(const char* path);
+
+	/**
+	 * @brief Write the entries currently held in memory to a file.
+	 * @return number of entries written, or -1 if the file could not be created
+	 */
+	int dump(const char* path);
+
+	~Logger();
+
+private:
+	static const size_t kDetailWords = kDetailSize / sizeof(uint64_t);
+
+	struct Slot {
+		std::atomic<uint64_t> sequence;
+		std::atomic<uint64_t> timestampMs;
+		std::atomic<const LogSite*> site;
+		std::atomic<long long> value;
+		std::atomic<uint64_t> suppressed;
+		std::atomic<uint64_t> detail[kDetailWords];
+	};
+
+	struct Entry {
+		uint64_t sequence;
+		uint64_t timestampMs;
+		const LogSite* site;
+		long long value;
+		uint64_t suppressed;
+		char detail[kDetailSize + 1];
+	};
+
+	Logger();
+
+	bool read(uint64_t sequence, Entry& entry) const;
+	static void format(const Entry& entry, std::string& out);
+	void flushLoop();
+	void flushPending(std::ostream& file);
+
+	std::atomic<int> level;
+	std::atomic<uint64_t> next;
+	Slot slots[kCapacity];
+
+	std::mutex sinkMutex;
+	std::thread sinkThread;
+	std::atomic<bool> sinkRunning;
+	std::ofstream sinkFile;
+	uint64_t flushed;
+};
+
+#define HUNSPELL_LOG(level, message, value, detail) \
+	do { \
+		if (Logger::instance().accepts(level)) { \
+			static LogSite hunspellLogSite(level, message); \
+			Logger::instance().write(hunspellLogSite, (long long)(value), (detail)); \
+		} \
+	} while (0)
+
+#define LOG_ERROR(message) HUNSPELL_LOG(LogLevel::Error, message, 0, nullptr)
+#define LOG_ERROR_CODE(message, code) HUNSPELL_LOG(LogLevel::Error, message, code, nullptr)
+#define LOG_ERROR_TEXT(message, text) HUNSPELL_LOG(LogLevel::Error, message, 0, text)
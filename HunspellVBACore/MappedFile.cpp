@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr), view(nullptr), length(0) {
+}
+
+bool MappedFile::open(const char* path) {
+	close();
+
+	// Shared for delete too, so a snapshot or segment can be replaced while mapped.
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || (unsigned long long)fileSize.QuadPart > (size_t)-1) {
+		close();
+		return false;
+	}
+	if (fileSize.QuadPart == 0) {
+		return true;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle == nullptr) {
+		close();
+		return false;
+	}
+
+	view = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		close();
+		return false;
+	}
+	length = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void MappedFile::close() {
+	if (view != nullptr) {
+		UnmapViewOfFile(view);
+		view = nullptr;
+	}
+	if (mappingHandle != nullptr) {
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+	}
+	if (fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(fileHandle);
+		fileHandle = INVALID_HANDLE_VALUE;
+	}
+	length = 0;
+}
+
+#else
+
+MappedFile::MappedFile() : fileDescriptor(-1), view(nullptr), length(0) {
+}
+
+bool MappedFile::open(const char* path) {
+	close();
+
+	fileDescriptor = ::open(path, O_RDONLY);
+	if (fileDescriptor < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(fileDescriptor, &status) != 0 || !S_ISREG(status.st_mode)) {
+		close();
+		return false;
+	}
+	if (status.st_size == 0) {
+		return true;
+	}
+
+	void* address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (address == MAP_FAILED) {
+		close();
+		return false;
+	}
+	madvise(address, (size_t)status.st_size, MADV_SEQUENTIAL);
+	view = (const char*)address;
+	length = (size_t)status.st_size;
+	return true;
+}
+
+void MappedFile::close() {
+	if (view != nullptr) {
+		munmap((void*)view, length);
+		view = nullptr;
+	}
+	if (fileDescriptor >= 0) {
+		::close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+	length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "PerfectHash.h"
+#include <algorithm>
+#include <utility>
+
+uint64_t PerfectHash::hash(std::string_view key) {
+	// FNV-1a, 64 bit
+	uint64_t value = 14695981039346656037ULL;
+	for (char c : key) {
+		value ^= (unsigned char)c;
+		value *= 1099511628211ULL;
+	}
+	return value;
+}
+
+uint64_t PerfectHash::mix(uint64_t hash, uint64_t seed) {
+	// splitmix64 finalizer
+	uint64_t value = hash + seed * 0x9E3779B97F4A7C15ULL;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
+
+bool PerfectHash::build(const std::vector<std::string_view>& keys) {
+	slots = (uint32_t)keys.size();
+	seeds.clear();
+	if (slots == 0) {
+		return true;
+	}
+
+	std::vector<uint64_t> hashes;
+	hashes.reserve(keys.size());
+	for (std::string_view key : keys) {
+		hashes.push_back(hash(key));
+	}
+
+	// Keys with the same hash never get apart, whatever the seeds.
+	std::vector<uint64_t> sorted = hashes;
+	std::sort(sorted.begin(), sorted.end());
+	if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+		slots = 0;
+		return false;
+	}
+
+	const size_t bucketCount = bucketsFor(keys.size());
+	for (bucketSeed = 1; bucketSeed <= 8; ++bucketSeed) {
+		std::vector<std::vector<uint32_t>> buckets(bucketCount);
+		for (uint32_t i = 0; i < slots; ++i) {
+			buckets[mix(hashes[i], bucketSeed) % bucketCount].push_back(i);
+		}
+
+		std::vector<uint32_t> order(bucketCount);
+		for (uint32_t i = 0; i < bucketCount; ++i) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[&](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+		seeds.assign(bucketCount, 0);
+		std::vector<bool> taken(slots, false);
+		std::vector<uint32_t> placed;
+		bool failed = false;
+
+		for (uint32_t bucket : order) {
+			const std::vector<uint32_t>& members = buckets[bucket];
+			if (members.empty()) {
+				break;
+			}
+
+			bool found = false;
+			// The last buckets are placed into a nearly full table, which takes
+			// up to about as many tries as there are slots.
+			for (uint32_t seed = 0; seed != UINT32_MAX && !found; ++seed) {
+				placed.clear();
+				found = true;
+				for (uint32_t key : members) {
+					uint32_t slot = (uint32_t)(mix(hashes[key], seed) % slots);
+					if (taken[slot] || std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+						found = false;
+						break;
+					}
+					placed.push_back(slot);
+				}
+				if (found) {
+					seeds[bucket] = seed;
+					for (uint32_t slot : placed) {
+						taken[slot] = true;
+					}
+				}
+			}
+			if (!found) {
+				failed = true;
+				break;
+			}
+		}
+
+		if (!failed) {
+			return true;
+		}
+	}
+
+	slots = 0;
+	seeds.clear();
+	return false;
+}
+
+bool PerfectHash::assign(uint32_t keyCount, uint64_t storedBucketSeed, std::vector<uint32_t> storedSeeds) {
+	if (keyCount != 0 && storedSeeds.size() != bucketsFor(keyCount)) {
+		return false;
+	}
+	slots = keyCount;
+	bucketSeed = storedBucketSeed;
+	seeds = keyCount != 0 ? std::move(storedSeeds) : std::vector<uint32_t>();
+	return true;
+}
+
+uint32_t PerfectHash::lookup(std::string_view key) const {
+	if (slots == 0) {
+		return 0;
+	}
+	uint64_t value = hash(key);
+	uint32_t seed = seeds[mix(value, bucketSeed) % seeds.size()];
+	return (uint32_t)(mix(value, seed) % slots);
+}
@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Minimal perfect hash over a fixed set of string keys.
+ *
+ * Hash-and-displace construction (CHD): keys are first spread over n/4
+ * buckets; buckets are then placed largest first, each with the smallest
+ * seed that sends all of its keys to free slots. A lookup is two hashes and
+ * one table read, and the table costs a byte per key.
+ *
+ * Building takes a while for large sets, so a built hash can be stored
+ * (getBucketSeed, getSeeds) and restored with assign.
+ *
+ * Keys not in the set map to an arbitrary slot, so callers must compare the
+ * stored key before trusting a match.
+ */
+class PerfectHash {
+public:
+	/** @return false if no hash was found (duplicate keys, for example) */
+	bool build(const std::vector<std::string_view>& keys);
+
+	/**
+	 * @brief Restore a hash built earlier for keyCount keys.
+	 * @return false if seeds cannot belong to such a hash; lookups of the
+	 *         keys must still be checked against the slots they were built for
+	 */
+	bool assign(uint32_t keyCount, uint64_t bucketSeed, std::vector<uint32_t> seeds);
+
+	/** @return slot in [0, size()) */
+	uint32_t lookup(std::string_view key) const;
+
+	size_t size() const { return slots; }
+	size_t memoryBytes() const { return seeds.size() * sizeof(uint32_t); }
+	uint64_t getBucketSeed() const { return bucketSeed; }
+	const std::vector<uint32_t>& getSeeds() const { return seeds; }
+
+	static uint64_t hash(std::string_view key);
+
+private:
+	static size_t bucketsFor(size_t keyCount) { return keyCount / 4 + 1; }
+	static uint64_t mix(uint64_t hash, uint64_t seed);
+
+	uint64_t bucketSeed = 0;
+	uint32_t slots = 0;
+	std::vector<uint32_t> seeds;
+};
@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ScratchArena.h"
+#include <cstdint>
+#include <new>
+
+ScratchArena::~ScratchArena() {
+	for (const Block& block : blocks) {
+		::operator delete(block.data);
+	}
+}
+
+void ScratchArena::reset() {
+	while (held > kMaxRetained) {
+		held -= blocks.back().size;
+		::operator delete(blocks.back().data);
+		blocks.pop_back();
+	}
+	current = 0;
+	used = 0;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+	for (;; ++current, used = 0) {
+		if (current == blocks.size()) {
+			addBlock(bytes, alignment);
+		}
+		const Block& block = blocks[current];
+		// Aligned by address: operator new only aligns blocks for the
+		// fundamental types, and std::pmr may ask for more.
+		uintptr_t start = reinterpret_cast<uintptr_t>(block.data);
+		size_t offset = (size_t)(((start + used + alignment - 1) & ~(uintptr_t)(alignment - 1)) - start);
+		if (offset <= block.size && bytes <= block.size - offset) {
+			used = offset + bytes;
+			return block.data + offset;
+		}
+	}
+}
+
+void ScratchArena::addBlock(size_t bytes, size_t alignment) {
+	// Blocks double with the total held, so a call that needs a lot of
+	// memory reaches it in a few steps.
+	size_t size = held < kBlockSize ? kBlockSize : held;
+	if (size < bytes + alignment - 1) {
+		size = bytes + alignment - 1;
+	}
+	blocks.reserve(blocks.size() + 1);
+	Block block = { static_cast<char*>(::operator new(size)), size };
+	blocks.push_back(block);
+	held += size;
+}
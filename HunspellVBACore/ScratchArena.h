@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Bump allocator for the temporary buffers of one engine call.
+ *
+ * Containers built during a call (candidate sets, deletion lists, rankings)
+ * take their memory from the arena through std::pmr, which only moves a
+ * pointer forward; deallocation does nothing. A Scope resets the arena when
+ * the outermost call returns, and the blocks are kept for the next call, so
+ * after the first few calls the heap is not touched at all. Blocks beyond
+ * kMaxRetained are given back on reset, so one pathological word does not
+ * pin its memory for the life of the handle.
+ *
+ * Not thread-safe: each SpellEngine owns one, like its other buffers.
+ */
+class ScratchArena : public std::pmr::memory_resource {
+public:
+	static const size_t kBlockSize = 16 * 1024;
+	static const size_t kMaxRetained = 1024 * 1024;
+
+	/** Resets the arena when the outermost scope ends. */
+	class Scope {
+	public:
+		explicit Scope(ScratchArena& arena) : arena(arena) { ++arena.depth; }
+		~Scope() {
+			if (--arena.depth == 0) {
+				arena.reset();
+			}
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		ScratchArena& arena;
+	};
+
+	ScratchArena() = default;
+	~ScratchArena();
+
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator=(const ScratchArena&) = delete;
+
+	/** Make every block available again; memory handed out before is invalid. */
+	void reset();
+
+	/** @return bytes held in blocks */
+	size_t capacity() const { return held; }
+
+private:
+	struct Block {
+		char* data;
+		size_t size;
+	};
+
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	/** Append a block that fits bytes at any address alignment. */
+	void addBlock(size_t bytes, size_t alignment);
+	void do_deallocate(void*, size_t, size_t) override {}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	std::vector<Block> blocks;
+	size_t current = 0; // block being filled
+	size_t used = 0;    // bytes used in it
+	size_t held = 0;
+	int depth = 0;
+};
+
+/**
+ * @brief Copy text into memory, for sets of string views built during a call.
+ *
+ * A set of views with the text in the arena looks up as fast as a set of
+ * std::string, where a set of pmr strings can be twice as slow (libstdc++
+ * caches the hash codes of the former only).
+ */
+template <typename Char>
+std::basic_string_view<Char> ScratchCopy(std::pmr::memory_resource* memory, std::basic_string_view<Char> text) {
+	Char* copy = static_cast<Char*>(memory->allocate(text.size() * sizeof(Char), alignof(Char)));
+	std::copy(text.begin(), text.end(), copy);
+	return std::basic_string_view<Char>(copy, text.size());
+}
@@ -0,0 +1,273 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include "DictionaryFile.h"
+#include "MappedFile.h"
+
+namespace
+{
+	const char kMagic[8] = { 'H', 'V', 'S', 'N', 'A', 'P', '0', '1' };
+
+	void PutUInt32(std::string& out, uint32_t value) {
+		for (int i = 0; i < 4; ++i) {
+			out += (char)((value >> (8 * i)) & 0xFF);
+		}
+	}
+
+	void PutUInt64(std::string& out, uint64_t value) {
+		PutUInt32(out, (uint32_t)value);
+		PutUInt32(out, (uint32_t)(value >> 32));
+	}
+
+	void PutString(std::string& out, const std::string& value) {
+		PutUInt32(out, (uint32_t)value.size());
+		out += value;
+	}
+
+	/** Reads the header fields in order; any read past the end fails the whole parse. */
+	class Reader {
+	public:
+		Reader(const char* data, size_t size) : data(data), size(size) {}
+
+		bool ok() const { return valid; }
+		size_t position() const { return offset; }
+
+		uint32_t uint32() {
+			if (!has(4)) {
+				return 0;
+			}
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data + offset);
+			offset += 4;
+			return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+		}
+
+		uint64_t uint64() {
+			uint64_t low = uint32();
+			return low | ((uint64_t)uint32() << 32);
+		}
+
+		uint8_t uint8() {
+			return has(1) ? (uint8_t)data[offset++] : 0;
+		}
+
+		std::string string() {
+			uint32_t length = uint32();
+			if (!has(length)) {
+				return std::string();
+			}
+			std::string value(data + offset, length);
+			offset += length;
+			return value;
+		}
+
+	private:
+		bool has(size_t bytes) {
+			valid = valid && size - offset >= bytes;
+			return valid;
+		}
+
+		const char* data;
+		size_t size;
+		size_t offset = 0;
+		bool valid = true;
+	};
+
+	bool FileStamp(const std::string& path, uint64_t& size, int64_t& modified) {
+#ifdef _WIN32
+		struct _stat64 info;
+		if (_stat64(path.c_str(), &info) != 0) {
+			return false;
+		}
+#else
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0) {
+			return false;
+		}
+#endif
+		size = (uint64_t)info.st_size;
+		modified = (int64_t)info.st_mtime;
+		return true;
+	}
+
+	/** 64-bit FNV-1a of the file's bytes */
+	bool HashContents(const std::string& path, uint64_t& hash) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		hash = 0xcbf29ce484222325ULL;
+		char buffer[64 * 1024];
+		while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(buffer);
+			for (std::streamsize i = 0; i < file.gcount(); ++i) {
+				hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+			}
+		}
+		return file.eof();
+	}
+}
+
+bool StampSnapshotSource(const std::string& path, EngineSnapshot::Source& source) {
+	std::string file = DictionaryFile::resolve(path.c_str());
+	source.path = path;
+	return !file.empty() && FileStamp(file, source.size, source.modified) && HashContents(file, source.hash);
+}
+
+bool SnapshotIsCurrent(const EngineSnapshot& snapshot) {
+	for (const EngineSnapshot::Source& source : snapshot.sources) {
+		std::string file = DictionaryFile::resolve(source.path.c_str());
+		uint64_t size;
+		int64_t modified;
+		if (file.empty() || !FileStamp(file, size, modified)) {
+			return false;
+		}
+		if (size == source.size && modified == source.modified) {
+			continue;
+		}
+		uint64_t hash;
+		if (size != source.size || !HashContents(file, hash) || hash != source.hash) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool WriteSnapshot(const char* path, const EngineSnapshot& snapshot, const char* automatonPath) {
+	std::ifstream automaton(automatonPath, std::ios::binary);
+	if (!automaton) {
+		return false;
+	}
+
+	std::string header(kMagic, sizeof(kMagic));
+	PutUInt32(header, (uint32_t)snapshot.sources.size());
+	for (const EngineSnapshot::Source& source : snapshot.sources) {
+		PutString(header, source.path);
+		PutUInt64(header, source.size);
+		PutUInt64(header, (uint64_t)source.modified);
+		PutUInt64(header, source.hash);
+		header += (char)(source.encrypted ? 1 : 0);
+	}
+	PutUInt32(header, (uint32_t)snapshot.addedWords.size());
+	for (const std::string& word : snapshot.addedWords) {
+		PutString(header, word);
+	}
+	PutUInt32(header, snapshot.tokenFilter.rules);
+	PutUInt64(header, snapshot.tokenFilter.maxUppercaseLength);
+	PutUInt64(header, snapshot.guardrails.maxCheckLength);
+	PutUInt64(header, snapshot.guardrails.maxSuggestLength);
+	PutUInt64(header, snapshot.guardrails.candidateBudget);
+	PutUInt32(header, snapshot.guardrails.suggestTimeoutMs);
+	PutUInt32(header, snapshot.backend);
+	PutUInt32(header, (uint32_t)snapshot.ranking);
+	PutString(header, snapshot.frequencyListPath);
+	PutString(header, snapshot.correctionsPath);
+	uint64_t automatonOffset = (header.size() + 8 + 7) & ~(uint64_t)7;
+	PutUInt64(header, automatonOffset);
+	header.resize((size_t)automatonOffset, '\0');
+
+#ifdef _WIN32
+	int process = _getpid();
+#else
+	int process = (int)getpid();
+#endif
+	std::string temporaryPath = std::string(path) + "." + std::to_string(process) + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file << header << automaton.rdbuf();
+		if (!file) {
+			file.close();
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+	}
+	// Replaced in one step, so there is always a snapshot at path. A handle
+	// restored from the old file keeps reading it through its mapping.
+#ifdef _WIN32
+	bool replaced = MoveFileExA(temporaryPath.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	bool replaced = std::rename(temporaryPath.c_str(), path) == 0;
+#endif
+	if (!replaced) {
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool ReadSnapshot(const char* path, EngineSnapshot& snapshot) {
+	MappedFile file;
+	if (!file.open(path) || file.size() < sizeof(kMagic) || memcmp(file.data(), kMagic, sizeof(kMagic)) != 0) {
+		return false;
+	}
+
+	Reader reader(file.data() + sizeof(kMagic), file.size() - sizeof(kMagic));
+	EngineSnapshot loaded;
+	uint32_t sources = reader.uint32();
+	for (uint32_t i = 0; i < sources && reader.ok(); ++i) {
+		EngineSnapshot::Source source;
+		source.path = reader.string();
+		source.size = reader.uint64();
+		source.modified = (int64_t)reader.uint64();
+		source.hash = reader.uint64();
+		source.encrypted = reader.uint8() != 0;
+		loaded.sources.push_back(std::move(source));
+	}
+	uint32_t words = reader.uint32();
+	for (uint32_t i = 0; i < words && reader.ok(); ++i) {
+		loaded.addedWords.push_back(reader.string());
+	}
+	loaded.tokenFilter.rules = reader.uint32();
+	loaded.tokenFilter.maxUppercaseLength = (size_t)reader.uint64();
+	loaded.guardrails.maxCheckLength = (size_t)reader.uint64();
+	loaded.guardrails.maxSuggestLength = (size_t)reader.uint64();
+	loaded.guardrails.candidateBudget = (size_t)reader.uint64();
+	loaded.guardrails.suggestTimeoutMs = reader.uint32();
+	loaded.backend = reader.uint32();
+	loaded.ranking = (SuggestionRanking)reader.uint32();
+	loaded.frequencyListPath = reader.string();
+	loaded.correctionsPath = reader.string();
+	loaded.automatonOffset = reader.uint64();
+
+	// An .aff and a .dic at least, and the automaton after the header.
+	if (!reader.ok() || loaded.sources.size() < 2 || loaded.backend > 2 || loaded.automatonOffset % 8 != 0
+		|| loaded.automatonOffset < sizeof(kMagic) + reader.position() || loaded.automatonOffset >= file.size()) {
+		return false;
+	}
+	snapshot = std::move(loaded);
+	return true;
+}
@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SpellEngine.h"
+
+/**
+ * @brief Everything SpellEngine::saveSnapshot() records about an engine.
+ *
+ * File layout, little-endian; strings are a uint32 byte count and UTF-8:
+ *   char[8]  "HVSNAP01"
+ *   uint32   source count, then per source (the .aff file, then every .dic
+ *            in load order): string path, uint64 size, int64 modification
+ *            time, uint64 FNV-1a hash of the contents, uint8 encrypted
+ *   uint32   added word count, then the words as strings
+ *   uint32   token filter rules, uint64 longest skipped uppercase token
+ *   uint64   guardrail lengths and budget, uint32 suggest timeout
+ *   uint32   suggestion backend (0 Hunspell, 1 SymSpell, 2 trigram),
+ *            uint32 ranking, string frequency list
+ *   string   correction table
+ *   uint64   automaton offset
+ *   padding  to the offset, a multiple of 8
+ *   automaton of every dictionary form and added word (Automaton layout)
+ *
+ * Keys of encrypted dictionaries are not stored; the snapshot is restored
+ * with the key again.
+ */
+struct EngineSnapshot {
+	struct Source {
+		std::string path;
+		uint64_t size = 0;
+		int64_t modified = 0;
+		uint64_t hash = 0;
+		bool encrypted = false;
+	};
+
+	std::vector<Source> sources;
+	std::vector<std::string> addedWords;
+	TokenFilter tokenFilter;
+	Guardrails guardrails;
+	uint32_t backend = 0;
+	SuggestionRanking ranking = SuggestionRanking::Similarity;
+	std::string frequencyListPath;
+	std::string correctionsPath;
+	uint64_t automatonOffset = 0;
+};
+
+/**
+ * @brief Record size, modification time and content hash of a dictionary file.
+ *
+ * A file missing under its own name is looked up as name + ".hz", like
+ * Hunspell does; the compressed file is the one stamped then.
+ * @return false if the file cannot be read
+ */
+bool StampSnapshotSource(const std::string& path, EngineSnapshot::Source& source);
+
+/**
+ * @brief Check that every source still has the contents it was saved with.
+ *
+ * A file with the recorded size and modification time is taken as
+ * unchanged; one that was touched or copied is hashed again, so only a
+ * change of contents makes a snapshot stale.
+ */
+bool SnapshotIsCurrent(const EngineSnapshot& snapshot);
+
+/**
+ * @brief Write snapshot and the automaton file at automatonPath as one file.
+ *
+ * The file is written next to path and then renamed, so a snapshot being
+ * replaced is never seen half-written.
+ */
+bool WriteSnapshot(const char* path, const EngineSnapshot& snapshot, const char* automatonPath);
+
+/** @return false if the file is missing or malformed */
+bool ReadSnapshot(const char* path, EngineSnapshot& snapshot);
@@ -0,0 +1,1050 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "SpellEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+#include "AffixRules.h"
+#include "DictionaryFile.h"
+#include "DictionarySegment.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
+#include "Tokenizer.h"
+#include "Trace.h"
+#include "Utf.h"
+
+namespace
+{
+	/** Hunspell's own limit (MAXSUGGESTION), so both backends return as many. */
+	const size_t kMaxSuggestions = 15;
+
+	/** @return number of bytes produced by a UTF-16 to UTF-8 conversion */
+	size_t AssignUtf8(std::u16string_view token, std::string& out) {
+		ToUtf8(token, out);
+		return out.size();
+	}
+
+	size_t AssignUtf8(std::string_view token, std::string& out) {
+		out.assign(token.data(), token.size());
+		return 0;
+	}
+
+	std::string ToUtf8String(std::u16string_view text) {
+		TraceSpan convert("utf16_to_utf8", "convert");
+		std::string utf8str;
+		ToUtf8(text, utf8str);
+		return utf8str;
+	}
+
+	/** The files and runtime additions Hunspell and the indexes are built from. */
+	struct Sources {
+		const std::string& affixPath;
+		const std::vector<std::string>& dictionaryPaths; // the main .dic first, then addDictionary()
+		const std::vector<std::string>& dictionaryKeys; // per dictionary path, empty for none
+		const std::vector<std::string>& addedWords;
+
+		const char* keyOf(size_t dictionary) const {
+			return dictionaryKeys[dictionary].empty() ? nullptr : dictionaryKeys[dictionary].c_str();
+		}
+	};
+
+	std::shared_ptr<Hunspell> LoadHunspell(const Sources& sources) {
+		TraceSpan span("load", "hunspell");
+		std::shared_ptr<Hunspell> loaded(new Hunspell(DictionaryFile::hunspellPath(sources.affixPath.c_str()).c_str(),
+			DictionaryFile::hunspellPath(sources.dictionaryPaths[0].c_str()).c_str(), sources.keyOf(0)));
+		for (size_t i = 1; i < sources.dictionaryPaths.size(); ++i) {
+			loaded->add_dic(DictionaryFile::hunspellPath(sources.dictionaryPaths[i].c_str()).c_str(), sources.keyOf(i));
+		}
+		for (const std::string& word : sources.addedWords) {
+			loaded->add(word);
+		}
+		return loaded;
+	}
+
+	/** Bring a freshly built index up to date with addDictionary() and addWord() calls made so far. */
+	bool AddSources(const Sources& sources, SuggestionBackend& index) {
+		for (size_t i = 1; i < sources.dictionaryPaths.size(); ++i) {
+			if (!index.addDictionary(sources.dictionaryPaths[i].c_str(), sources.keyOf(i))) {
+				return false;
+			}
+		}
+		for (const std::string& word : sources.addedWords) {
+			index.addWord(word);
+		}
+		return true;
+	}
+
+	/** @return 0 on success, -1 if the dictionary cannot be indexed, -2 if the frequency list cannot be read */
+	int BuildSymSpell(const Sources& sources, SuggestionRanking ranking, const std::string& frequencyListPath,
+		std::unique_ptr<SuggestionBackend>& out) {
+		TraceSpan span("build_index", "symspell");
+		std::unique_ptr<SymSpellBackend> index(new SymSpellBackend());
+		if (!index->load(sources.affixPath.c_str(), sources.dictionaryPaths[0].c_str(), sources.keyOf(0))
+			|| !AddSources(sources, *index)) {
+			return -1;
+		}
+		if (ranking == SuggestionRanking::Frequency
+			&& (frequencyListPath.empty() || !index->loadFrequencies(frequencyListPath.c_str()))) {
+			return -2;
+		}
+		index->setRanking(ranking);
+		out = std::move(index);
+		return 0;
+	}
+
+	/** @return 0 on success, -1 if the dictionary cannot be indexed */
+	int BuildTrigramIndex(const Sources& sources, std::unique_ptr<SuggestionBackend>& out) {
+		TraceSpan span("build_index", "trigram");
+		std::unique_ptr<TrigramBackend> index(new TrigramBackend());
+		if (!index->load(sources.affixPath.c_str(), sources.dictionaryPaths[0].c_str(), sources.keyOf(0))
+			|| !AddSources(sources, *index)) {
+			return -1;
+		}
+		out = std::move(index);
+		return 0;
+	}
+
+	std::unique_ptr<Automaton> LoadAutomatonFile(const std::string& path) {
+		TraceSpan span("load_automaton", "automaton");
+		std::unique_ptr<Automaton> loaded(new Automaton());
+		if (!loaded->load(path.c_str())) {
+			loaded.reset();
+		}
+		return loaded;
+	}
+
+	/** Map the shared segment of sources' dictionary files, building it first if no process has yet. */
+	std::unique_ptr<Automaton> AttachSegment(const std::string& directory, const Sources& sources) {
+		TraceSpan span("attach_segment", "automaton");
+		std::string segmentPath = DictionarySegmentPath(directory, sources.affixPath, sources.dictionaryPaths);
+		if (segmentPath.empty()) {
+			return nullptr;
+		}
+		std::unique_ptr<Automaton> loaded = LoadAutomatonFile(segmentPath);
+		if (!loaded) {
+			AutomatonBuildSummary summary;
+			PublishDictionarySegment(segmentPath, sources.affixPath, sources.dictionaryPaths, sources.dictionaryKeys, summary);
+			loaded = LoadAutomatonFile(segmentPath);
+		}
+		return loaded;
+	}
+}
+
+/**
+ * @brief The thread timed suggest() calls run on.
+ *
+ * Hunspell cannot be interrupted, so a call that outlives its timeout is
+ * abandoned: it finishes on the worker, which keeps the instance alive
+ * until then and takes no other call meanwhile.
+ */
+class SpellEngine::SuggestWorker {
+public:
+	SuggestWorker() : thread(&SuggestWorker::loop, this) {}
+
+	/** Waits for an abandoned call to return. */
+	~SuggestWorker() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		queued.notify_one();
+		thread.join();
+	}
+
+	/** @return true while an abandoned call runs */
+	bool busy() const { return abandoned.load(std::memory_order_acquire) != nullptr; }
+
+	/** @return true if an abandoned call runs on speller */
+	bool holds(const Hunspell* speller) const { return speller != nullptr && abandoned.load(std::memory_order_acquire) == speller; }
+
+	/**
+	 * @brief Run one suggest on the worker and wait up to timeoutMs for it.
+	 * @return false if the call timed out and was abandoned
+	 */
+	bool run(const std::shared_ptr<Hunspell>& speller, const std::string& word, bool suffixOnly, unsigned timeoutMs,
+		std::vector<std::string>& suggestions) {
+		std::unique_lock<std::mutex> lock(mutex);
+		call = Call{ speller, word, suffixOnly };
+		finished = false;
+		queued.notify_one();
+		if (!done.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return finished; })) {
+			abandoned.store(speller.get(), std::memory_order_release);
+			return false;
+		}
+		suggestions = std::move(result);
+		return true;
+	}
+
+private:
+	struct Call {
+		std::shared_ptr<Hunspell> speller; // NULL while none is queued or running
+		std::string word;
+		bool suffixOnly = false;
+	};
+
+	void loop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			queued.wait(lock, [this]() { return stopping || call.speller; });
+			if (!call.speller) {
+				return;
+			}
+			Call running = std::move(call);
+			call = Call();
+			lock.unlock();
+			std::vector<std::string> suggestions;
+			try {
+				suggestions = running.suffixOnly ? running.speller->suffix_suggest(running.word) : running.speller->suggest(running.word);
+			}
+			catch (...) {
+				// Reported as no suggestions; there is no caller to rethrow to.
+			}
+			running.speller.reset();
+			lock.lock();
+			result = std::move(suggestions);
+			finished = true;
+			abandoned.store(nullptr, std::memory_order_release);
+			done.notify_one();
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable queued;
+	std::condition_variable done;
+	Call call;
+	bool finished = false;
+	bool stopping = false;
+	std::vector<std::string> result;
+	std::atomic<const Hunspell*> abandoned{ nullptr }; // instance a timed out call still runs on
+	std::thread thread; // last, so it starts after the members it uses
+};
+
+/** What a reload() job built, installed by finishReload(). */
+struct SpellEngine::Reload {
+	bool loaded = false;
+	std::shared_ptr<Hunspell> hunspell; // NULL if the engine had not loaded one yet
+	std::unique_ptr<SuggestionBackend> backend;
+	std::unique_ptr<Automaton> automaton;
+
+	// What the job started from, to catch up with or detect changes made meanwhile.
+	size_t dictionaries = 0;
+	size_t words = 0;
+	std::string backendName;
+	std::string automatonPath;
+	std::string segmentDirectory;
+};
+
+SpellEngine::SpellEngine(const char* affixFilePath, const char* dictionaryFilePath, bool loadHunspell, const char* key)
+	: affixPath(affixFilePath), dictionaryPaths(1, dictionaryFilePath), dictionaryKeys(1, key != nullptr ? key : "") {
+	if (loadHunspell) {
+		instance();
+	}
+}
+
+SpellEngine::~SpellEngine() {
+	if (reloadJob.valid()) {
+		reloadJob.wait();
+	}
+	if (retireJob.valid()) {
+		retireJob.wait();
+	}
+}
+
+Hunspell* SpellEngine::loaded() {
+	if (suggestWorker && suggestWorker->holds(hunspell.get())) {
+		// Hunspell is not thread-safe; the worker keeps the instance until
+		// the call returns and this engine loads its own.
+		hunspell.reset();
+	}
+	return hunspell.get();
+}
+
+Hunspell& SpellEngine::instance() {
+	if (loaded() == nullptr) {
+		// Dictionaries and words added before the first load are replayed.
+		hunspell = LoadHunspell(Sources{ affixPath, dictionaryPaths, dictionaryKeys, addedWords });
+	}
+	return *hunspell;
+}
+
+template <typename Char>
+bool SpellEngine::isFiltered(std::basic_string_view<Char> token) {
+	unsigned rule = tokenFilter.classify(token);
+	if (rule == 0) {
+		return false;
+	}
+	if (statistics.isEnabled()) {
+		switch (rule) {
+		case TokenFilter::kDigits: statistics.add(statistics.filteredDigits); break;
+		case TokenFilter::kUrls: statistics.add(statistics.filteredUrls); break;
+		case TokenFilter::kEmails: statistics.add(statistics.filteredEmails); break;
+		default: statistics.add(statistics.filteredUppercase); break;
+		}
+	}
+	return true;
+}
+
+bool SpellEngine::tripped(size_t length, size_t limit) {
+	trip = GuardrailTrip::None;
+	if (limit == 0 || length <= limit) {
+		return false;
+	}
+	trip = GuardrailTrip::Length;
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.skippedLength);
+	}
+	return true;
+}
+
+bool SpellEngine::spell(const std::string& word) {
+	StatsTimer timer(statistics, statistics.spellLatency);
+	if (automaton) {
+		TraceSpan span("spell", "automaton");
+		// Hunspell retries "Word" and "WORD" as "word"; so does the lookup
+		// where the dictionary has no case rules that would stop it.
+		bool hit = automaton->contains(word)
+			|| (FoldAsciiCase(word, foldBuffer) && foldsAsciiCase() && automaton->contains(foldBuffer));
+		if (statistics.isEnabled()) {
+			statistics.add(statistics.automatonLookups);
+			if (hit) {
+				statistics.add(statistics.automatonHits);
+			}
+		}
+		if (hit) {
+			return true;
+		}
+	}
+
+	// Compounds, case variants, runtime additions and twofold affixes are
+	// not in the automaton and still need Hunspell.
+	TraceSpan span("spell", "hunspell");
+	return instance().spell(word);
+}
+
+void SpellEngine::readAffixRules() {
+	AffixRules rules;
+	bool read = rules.load(affixPath.c_str(), dictionaryKeys[0].empty() ? nullptr : dictionaryKeys[0].c_str());
+	asciiCaseFolding = read && rules.foldsAsciiCase();
+	tryLength = read ? rules.tryLength() : 0;
+}
+
+bool SpellEngine::foldsAsciiCase() {
+	if (asciiCaseFolding < 0) {
+		readAffixRules();
+	}
+	return asciiCaseFolding != 0;
+}
+
+size_t SpellEngine::hunspellCandidates(const std::string& word) {
+	if (asciiCaseFolding < 0) {
+		readAffixRules();
+	}
+	size_t length = 0;
+	for (char byte : word) {
+		length += ((unsigned char)byte & 0xC0) != 0x80;
+	}
+	// Every TRY character inserted at and substituted for each position,
+	// then the swaps and moves of character pairs; the n-gram pass and
+	// compound checks come on top.
+	return length * (2 * tryLength + length);
+}
+
+bool SpellEngine::check(std::u16string_view word) {
+	pollReload();
+	if (tripped(word.size(), guardrails.maxCheckLength) || isFiltered(word)) {
+		if (statistics.isEnabled()) {
+			statistics.add(statistics.checkCalls);
+		}
+		return true;
+	}
+	{
+		TraceSpan convert("utf16_to_utf8", "convert");
+		ToUtf8(word, wordBuffer);
+	}
+	return checkBuffer(wordBuffer.size());
+}
+
+bool SpellEngine::check(std::string_view word) {
+	pollReload();
+	if (tripped(word.size(), guardrails.maxCheckLength) || isFiltered(word)) {
+		if (statistics.isEnabled()) {
+			statistics.add(statistics.checkCalls);
+		}
+		return true;
+	}
+	wordBuffer.assign(word.data(), word.size());
+	return checkBuffer(0);
+}
+
+bool SpellEngine::checkBuffer(size_t convertedBytes) {
+	bool correct = spell(wordBuffer);
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.checkCalls);
+		statistics.add(statistics.wordsChecked);
+		statistics.add(statistics.bytesConverted, convertedBytes);
+		if (!correct) {
+			statistics.add(statistics.misses);
+		}
+	}
+	return correct;
+}
+
+std::vector<std::string> SpellEngine::runSuggest(const std::string& word, bool suffixOnly, size_t limit) {
+	pollReload();
+	ScratchArena::Scope scope(scratch);
+	std::vector<std::string> suggestions;
+	if (!suffixOnly && corrections) {
+		bool hit = corrections->lookup(word, suggestions);
+		if (statistics.isEnabled()) {
+			statistics.add(statistics.correctionLookups);
+			if (hit) {
+				statistics.add(statistics.correctionHits);
+				statistics.add(statistics.suggestCalls);
+				statistics.add(statistics.suggestionsReturned, suggestions.size());
+			}
+		}
+		if (hit) {
+			return suggestions;
+		}
+	}
+	SuggestionBackend* suggester = suffixOnly ? nullptr : suggestionBackend();
+	if (suggester != nullptr) {
+		TraceSpan span("suggest", suggester->name());
+		StatsTimer timer(statistics, statistics.suggestLatency);
+		const size_t budget = guardrails.candidateBudget;
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(guardrails.suggestTimeoutMs);
+		CandidateList candidates(&scratch);
+		suggester->suggest(word, 2 * kMaxSuggestions, candidates);
+		size_t verified = 0;
+		for (const std::pmr::string& candidate : candidates) {
+			if (suggestions.size() == limit) {
+				break;
+			}
+			if (budget != 0 && verified == budget) {
+				trip = GuardrailTrip::Budget;
+				break;
+			}
+			if (guardrails.suggestTimeoutMs != 0 && std::chrono::steady_clock::now() > deadline) {
+				suggestions.clear();
+				trip = GuardrailTrip::Timeout;
+				break;
+			}
+			++verified;
+			wordBuffer.assign(candidate);
+			if (instance().spell(wordBuffer)) {
+				suggestions.push_back(wordBuffer);
+			}
+		}
+	}
+	else {
+		TraceSpan span(suffixOnly ? "suffix_suggest" : "suggest", "hunspell");
+		StatsTimer timer(statistics, statistics.suggestLatency);
+		suggestions = hunspellSuggest(word, suffixOnly);
+	}
+	if (statistics.isEnabled()) {
+		if (trip == GuardrailTrip::Budget) {
+			statistics.add(statistics.skippedBudget);
+		}
+		else if (trip == GuardrailTrip::Timeout) {
+			statistics.add(statistics.skippedTimeout);
+		}
+		statistics.add(suffixOnly ? statistics.suffixSuggestCalls : statistics.suggestCalls);
+		statistics.add(statistics.bytesConverted, word.size());
+		statistics.add(statistics.suggestionsReturned, suggestions.size());
+	}
+	return suggestions;
+}
+
+std::vector<std::string> SpellEngine::hunspellSuggest(const std::string& word, bool suffixOnly) {
+	if (guardrails.candidateBudget != 0 && hunspellCandidates(word) > guardrails.candidateBudget) {
+		trip = GuardrailTrip::Budget;
+		return std::vector<std::string>();
+	}
+	if (guardrails.suggestTimeoutMs == 0) {
+		return suffixOnly ? instance().suffix_suggest(word) : instance().suggest(word);
+	}
+
+	if (!suggestWorker) {
+		try {
+			suggestWorker.reset(new SuggestWorker());
+		}
+		catch (const std::system_error&) {
+			return suffixOnly ? instance().suffix_suggest(word) : instance().suggest(word);
+		}
+	}
+	std::vector<std::string> suggestions;
+	if (suggestWorker->busy()) {
+		// Refused rather than queued: the late call may take as long again.
+		trip = GuardrailTrip::Timeout;
+		return suggestions;
+	}
+	instance();
+	if (!suggestWorker->run(hunspell, word, suffixOnly, guardrails.suggestTimeoutMs, suggestions)) {
+		trip = GuardrailTrip::Timeout;
+	}
+	return suggestions;
+}
+
+std::vector<std::string> SpellEngine::suggest(std::u16string_view word) {
+	if (tripped(word.size(), guardrails.maxSuggestLength)) {
+		return std::vector<std::string>();
+	}
+	ToUtf8(word, queryBuffer);
+	return runSuggest(queryBuffer, false, kMaxSuggestions);
+}
+
+std::vector<std::string> SpellEngine::suggest(std::string_view word) {
+	if (tripped(word.size(), guardrails.maxSuggestLength)) {
+		return std::vector<std::string>();
+	}
+	queryBuffer.assign(word);
+	return runSuggest(queryBuffer, false, kMaxSuggestions);
+}
+
+std::vector<std::string> SpellEngine::suffixSuggest(std::u16string_view word) {
+	if (tripped(word.size(), guardrails.maxSuggestLength)) {
+		return std::vector<std::string>();
+	}
+	ToUtf8(word, queryBuffer);
+	return runSuggest(queryBuffer, true, kMaxSuggestions);
+}
+
+bool SpellEngine::checkAndSuggest(std::u16string_view word, size_t maxSuggestions, std::vector<std::string>& suggestions) {
+	suggestions.clear();
+	if (check(word)) {
+		return true;
+	}
+	if (maxSuggestions != 0 && !tripped(word.size(), guardrails.maxSuggestLength)) {
+		// A rejected word was converted into wordBuffer, which the suggest
+		// pass needs for its candidates.
+		queryBuffer.swap(wordBuffer);
+		suggestions = runSuggest(queryBuffer, false, std::min(maxSuggestions, kMaxSuggestions));
+		if (suggestions.size() > maxSuggestions) {
+			suggestions.resize(maxSuggestions);
+		}
+	}
+	return false;
+}
+
+std::vector<std::string> SpellEngine::analyze(std::u16string_view word) {
+	pollReload();
+	ToUtf8(word, wordBuffer);
+	TraceSpan span("analyze", "hunspell");
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.analyzeCalls);
+		statistics.add(statistics.bytesConverted, wordBuffer.size());
+	}
+	return instance().analyze(wordBuffer);
+}
+
+std::vector<std::string> SpellEngine::stem(std::u16string_view word) {
+	pollReload();
+	ToUtf8(word, wordBuffer);
+	TraceSpan span("stem", "hunspell");
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.stemCalls);
+		statistics.add(statistics.bytesConverted, wordBuffer.size());
+	}
+	return instance().stem(wordBuffer);
+}
+
+std::vector<std::string> SpellEngine::generate(std::u16string_view word, std::u16string_view example) {
+	pollReload();
+	ToUtf8(word, wordBuffer);
+	ToUtf8(example, queryBuffer);
+	TraceSpan span("generate", "hunspell");
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.generateCalls);
+		statistics.add(statistics.bytesConverted, wordBuffer.size() + queryBuffer.size());
+	}
+	return instance().generate(wordBuffer, queryBuffer);
+}
+
+std::vector<std::string> SpellEngine::stemText(std::u16string_view text) {
+	// Documents repeat most of their words, so each distinct token is stemmed
+	// once and every distinct stem is returned once.
+	pollReload();
+	ScratchArena::Scope scope(scratch);
+	std::pmr::unordered_set<std::string_view> seenTokens(&scratch);
+	std::pmr::unordered_set<std::string_view> seenStems(&scratch);
+	std::vector<std::string> stems;
+	uint64_t tokens = 0;
+	uint64_t bytes = 0;
+
+	TraceSpan tokenize("tokenize", "tokenize");
+	WhitespaceTokenizer<char16_t> tokenizer(text);
+	std::u16string_view token;
+	size_t offset;
+	while (tokenizer.next(token, offset)) {
+		TrimPunctuation(token, offset);
+		if (token.empty()) {
+			continue;
+		}
+
+		++tokens;
+		ToUtf8(token, wordBuffer);
+		bytes += wordBuffer.size();
+		if (seenTokens.count(wordBuffer) != 0) {
+			continue;
+		}
+		seenTokens.insert(ScratchCopy<char>(&scratch, wordBuffer));
+
+		std::vector<std::string> tokenStems;
+		{
+			TraceSpan span("stem", "hunspell");
+			tokenStems = instance().stem(wordBuffer);
+		}
+		if (tokenStems.empty()) {
+			tokenStems.push_back(wordBuffer);
+		}
+		for (std::string& tokenStem : tokenStems) {
+			if (seenStems.count(tokenStem) == 0) {
+				seenStems.insert(ScratchCopy<char>(&scratch, tokenStem));
+				stems.push_back(std::move(tokenStem));
+			}
+		}
+	}
+	tokenize.finish();
+
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.stemTextCalls);
+		statistics.add(statistics.wordsChecked, tokens);
+		statistics.add(statistics.bytesConverted, bytes);
+	}
+	return stems;
+}
+
+template <typename Char>
+size_t SpellEngine::scanMisspellings(std::basic_string_view<Char> text, const MisspellingCallback& callback) {
+	pollReload();
+	TraceSpan tokenize("tokenize", "tokenize");
+	WhitespaceTokenizer<Char> tokenizer(text);
+	std::basic_string_view<Char> token;
+	size_t offset;
+	uint64_t words = 0;
+	uint64_t bytes = 0;
+	size_t misspellings = 0;
+
+	while (tokenizer.next(token, offset)) {
+		if (tripped(token.size(), guardrails.maxCheckLength) || isFiltered(token)) {
+			continue;
+		}
+		bytes += AssignUtf8(token, wordBuffer);
+		++words;
+		if (spell(wordBuffer)) {
+			continue;
+		}
+
+		++misspellings;
+		Misspelling misspelling = { offset, token.size(), std::string_view(wordBuffer) };
+		if (!callback(misspelling)) {
+			break;
+		}
+	}
+	tokenize.finish();
+
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.misspellingsCalls);
+		statistics.add(statistics.wordsChecked, words);
+		statistics.add(statistics.misses, misspellings);
+		statistics.add(statistics.bytesConverted, bytes);
+	}
+	return misspellings;
+}
+
+size_t SpellEngine::forEachMisspelling(std::u16string_view text, const MisspellingCallback& callback) {
+	return scanMisspellings(text, callback);
+}
+
+size_t SpellEngine::forEachMisspelling(std::string_view text, const MisspellingCallback& callback) {
+	return scanMisspellings(text, callback);
+}
+
+bool SpellEngine::forEachMisspellingInFile(const char* path, const MisspellingCallback& callback, TextEncoding& encoding) {
+	MappedFile file;
+	if (!file.open(path)) {
+		return false;
+	}
+
+	std::string_view bytes(file.data(), file.size());
+	size_t bomSize;
+	encoding = DetectEncoding(bytes, bomSize);
+	bytes.remove_prefix(bomSize);
+
+	if (encoding == TextEncoding::Utf8) {
+		forEachMisspelling(bytes, [&](const Misspelling& misspelling) {
+			Misspelling inFile = { bomSize + misspelling.offset, misspelling.length, misspelling.word };
+			return callback(inFile);
+		});
+		return true;
+	}
+
+	// The mapping is page aligned and the BOM is two bytes, so the text can
+	// be read as UTF-16 directly.
+	std::u16string_view text(reinterpret_cast<const char16_t*>(bytes.data()), bytes.size() / 2);
+	if (encoding == TextEncoding::Utf16LE) {
+		forEachMisspelling(text, [&](const Misspelling& misspelling) {
+			Misspelling inFile = { bomSize + misspelling.offset * 2, misspelling.length * 2, misspelling.word };
+			return callback(inFile);
+		});
+		return true;
+	}
+
+	// UTF-16BE: swap one window at a time, cut after the last whitespace so
+	// no token is split between windows.
+	const size_t kWindow = 64 * 1024;
+	std::u16string window;
+	window.reserve(kWindow);
+	bool stopped = false;
+	size_t start = 0;
+	while (start < text.size() && !stopped) {
+		size_t end = start + kWindow < text.size() ? start + kWindow : text.size();
+		window.clear();
+		for (size_t i = start; i < end; ++i) {
+			char16_t c = text[i];
+			window += (char16_t)((c >> 8) | (c << 8));
+		}
+		if (end < text.size()) {
+			size_t cut = window.size();
+			while (cut > 0 && !IsTokenSpace(window[cut - 1])) {
+				--cut;
+			}
+			if (cut > 0) {
+				window.resize(cut);
+				end = start + cut;
+			}
+		}
+
+		forEachMisspelling(std::u16string_view(window), [&](const Misspelling& misspelling) {
+			Misspelling inFile = { bomSize + (start + misspelling.offset) * 2, misspelling.length * 2, misspelling.word };
+			stopped = !callback(inFile);
+			return !stopped;
+		});
+		start = end;
+	}
+	return true;
+}
+
+long long SpellEngine::loadCorrections(const char* path) {
+	TraceSpan span("load_corrections", "corrections");
+	std::unique_ptr<CorrectionTable> table(new CorrectionTable());
+	if (!table->load(path)) {
+		return -1;
+	}
+	corrections = std::move(table);
+	correctionsPath = path;
+	return (long long)corrections->size();
+}
+
+long long SpellEngine::loadAutomaton(const char* path) {
+	std::unique_ptr<Automaton> loaded = LoadAutomatonFile(path);
+	if (!loaded) {
+		return -1;
+	}
+	automaton = std::move(loaded);
+	automatonPath = path;
+	segmentDirectory.clear();
+	return (long long)automaton->wordCount();
+}
+
+long long SpellEngine::attachSharedDictionary(const char* directory) {
+	std::unique_ptr<Automaton> loaded = AttachSegment(directory, Sources{ affixPath, dictionaryPaths, dictionaryKeys, addedWords });
+	if (!loaded) {
+		return -1;
+	}
+	automaton = std::move(loaded);
+	automatonPath.clear();
+	segmentDirectory = directory;
+	return (long long)automaton->wordCount();
+}
+
+void SpellEngine::clearAutomaton() {
+	automaton.reset();
+	automatonPath.clear();
+	segmentDirectory.clear();
+}
+
+bool SpellEngine::reload() {
+	if (reloadJob.valid()) {
+		return false;
+	}
+
+	// The job only works on copies, so the engine stays usable meanwhile.
+	try {
+		reloadJob = std::async(std::launch::async, [affix = affixPath, paths = dictionaryPaths, keys = dictionaryKeys,
+			words = addedWords, loadHunspell = hunspell != nullptr, backendName = std::string(backend ? backend->name() : ""),
+			ranking = symSpellRanking, frequencies = symSpellFrequencies, automatonFile = automatonPath,
+			directory = segmentDirectory, ready = &reloadReady]() {
+			TraceSpan span("reload", "reload");
+			std::unique_ptr<Reload> result;
+			try {
+				result.reset(new Reload());
+				result->dictionaries = paths.size();
+				result->words = words.size();
+				result->backendName = backendName;
+				result->automatonPath = automatonFile;
+				result->segmentDirectory = directory;
+
+				Sources sources = { affix, paths, keys, words };
+				if (!DictionaryFile::resolve(affix.c_str()).empty() && !DictionaryFile::resolve(paths[0].c_str()).empty()) {
+					int built = 0;
+					if (backendName == "symspell") {
+						built = BuildSymSpell(sources, ranking, frequencies, result->backend);
+					}
+					else if (backendName == "trigram") {
+						built = BuildTrigramIndex(sources, result->backend);
+					}
+					if (built == 0) {
+						if (loadHunspell) {
+							result->hunspell = LoadHunspell(sources);
+						}
+						// An automaton that cannot be loaded only sends every word to Hunspell.
+						if (!directory.empty()) {
+							result->automaton = AttachSegment(directory, sources);
+						}
+						else if (!automatonFile.empty()) {
+							result->automaton = LoadAutomatonFile(automatonFile);
+						}
+						result->loaded = true;
+					}
+				}
+			}
+			catch (...) {
+				// Typically out of memory: the reload fails as a whole, what
+				// was built is dropped and the current dictionary stays.
+				if (result) {
+					result->loaded = false;
+				}
+			}
+			ready->store(true, std::memory_order_release);
+			return result;
+		});
+	}
+	catch (const std::system_error&) {
+		return false;
+	}
+	return true;
+}
+
+int SpellEngine::finishReload() {
+	if (!reloadJob.valid()) {
+		return 0;
+	}
+	std::unique_ptr<Reload> result = reloadJob.get();
+	reloadReady.store(false, std::memory_order_relaxed);
+	if (!result || !result->loaded) {
+		return -1;
+	}
+
+	// Catch up with addDictionary() and addWord() calls made while the job ran.
+	TraceSpan span("install", "reload");
+	try {
+		for (size_t i = result->dictionaries; i < dictionaryPaths.size(); ++i) {
+			const char* key = dictionaryKeys[i].empty() ? nullptr : dictionaryKeys[i].c_str();
+			if (result->hunspell) {
+				result->hunspell->add_dic(DictionaryFile::hunspellPath(dictionaryPaths[i].c_str()).c_str(), key);
+			}
+			if (result->backend) {
+				result->backend->addDictionary(dictionaryPaths[i].c_str(), key);
+			}
+		}
+		for (size_t i = result->words; i < addedWords.size(); ++i) {
+			if (result->hunspell) {
+				result->hunspell->add(addedWords[i]);
+			}
+			if (result->backend) {
+				result->backend->addWord(addedWords[i]);
+			}
+		}
+	}
+	catch (const std::exception&) {
+		return -1;
+	}
+
+	// A Hunspell that was not loaded yet is loaded from the new files on
+	// first use. Backends and automatons replaced meanwhile are kept.
+	hunspell.swap(result->hunspell);
+	if (result->backendName == (backend ? backend->name() : "")) {
+		backend.swap(result->backend);
+	}
+	if (result->automatonPath == automatonPath && result->segmentDirectory == segmentDirectory) {
+		automaton.swap(result->automaton);
+	}
+	asciiCaseFolding = -1; // the .aff may have changed too
+
+	// Freeing a dictionary takes as long as a good part of loading it, so
+	// the replaced instances are freed off the caller's thread.
+	try {
+		retireJob = std::async(std::launch::async, [retired = std::move(result)]() mutable { retired.reset(); });
+	}
+	catch (const std::system_error&) {
+	}
+	return 1;
+}
+
+int SpellEngine::saveSnapshot(const char* path) const {
+	TraceSpan span("save", "snapshot");
+	EngineSnapshot snapshot;
+	snapshot.sources.resize(dictionaryPaths.size() + 1);
+	if (!StampSnapshotSource(affixPath, snapshot.sources[0])) {
+		return -1;
+	}
+	for (size_t i = 0; i < dictionaryPaths.size(); ++i) {
+		if (!StampSnapshotSource(dictionaryPaths[i], snapshot.sources[i + 1])) {
+			return -1;
+		}
+		snapshot.sources[i + 1].encrypted = !dictionaryKeys[i].empty();
+	}
+	snapshot.addedWords = addedWords;
+	snapshot.tokenFilter = tokenFilter;
+	snapshot.guardrails = guardrails;
+	if (backend || pendingBackend != 0) {
+		snapshot.backend = backend ? (strcmp(backend->name(), "trigram") == 0 ? 2 : 1) : pendingBackend;
+		snapshot.ranking = symSpellRanking;
+		snapshot.frequencyListPath = symSpellFrequencies;
+	}
+	snapshot.correctionsPath = correctionsPath;
+
+	std::string automatonFile = std::string(path) + ".dawg.tmp";
+	AutomatonBuildSummary summary;
+	if (BuildDictionaryAutomaton(affixPath, dictionaryPaths, dictionaryKeys, 0, true, automatonFile.c_str(), summary,
+		&addedWords) != 0) {
+		std::remove(automatonFile.c_str());
+		return -2;
+	}
+	bool written = WriteSnapshot(path, snapshot, automatonFile.c_str());
+	std::remove(automatonFile.c_str());
+	return written ? 0 : -3;
+}
+
+long long SpellEngine::restoreSnapshot(const char* path, const EngineSnapshot& snapshot, const char* key) {
+	TraceSpan span("restore", "snapshot");
+	std::unique_ptr<Automaton> loaded(new Automaton());
+	if (!loaded->load(path, snapshot.automatonOffset)) {
+		return -1;
+	}
+
+	// Hunspell is not loaded yet, so none of this is replayed until it is.
+	for (size_t i = 2; i < snapshot.sources.size(); ++i) {
+		dictionaryPaths.push_back(snapshot.sources[i].path);
+		dictionaryKeys.push_back(snapshot.sources[i].encrypted && key != nullptr ? key : "");
+	}
+	addedWords = snapshot.addedWords;
+	tokenFilter = snapshot.tokenFilter;
+	guardrails = snapshot.guardrails;
+	automaton = std::move(loaded);
+	automatonPath.clear();
+	segmentDirectory.clear();
+	if (!snapshot.correctionsPath.empty()) {
+		loadCorrections(snapshot.correctionsPath.c_str());
+	}
+	// Building the index takes as long as loading Hunspell, so it waits for
+	// the first suggest() too.
+	backend.reset();
+	pendingBackend = snapshot.backend;
+	symSpellRanking = snapshot.ranking;
+	symSpellFrequencies = snapshot.frequencyListPath;
+	return (long long)automaton->wordCount();
+}
+
+SuggestionBackend* SpellEngine::suggestionBackend() {
+	if (pendingBackend != 0) {
+		// Tried once: if the index cannot be built, Hunspell suggests.
+		int which = pendingBackend;
+		pendingBackend = 0;
+		TraceSpan span("restore_backend", "snapshot");
+		if (which == 1) {
+			useSymSpell(symSpellRanking, symSpellFrequencies.empty() ? nullptr : symSpellFrequencies.c_str());
+		}
+		else {
+			useTrigramIndex();
+		}
+	}
+	return backend.get();
+}
+
+int SpellEngine::addWord(std::u16string_view word) {
+	pollReload();
+	std::string utf8str = ToUtf8String(word);
+	TraceSpan span("add", "hunspell");
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.addWordCalls);
+	}
+	// Not loaded yet: the word is added when Hunspell is.
+	Hunspell* speller = loaded();
+	int result = speller != nullptr ? speller->add(utf8str) : 0;
+	if (result == 0) {
+		if (backend) {
+			backend->addWord(utf8str);
+		}
+		addedWords.push_back(std::move(utf8str));
+	}
+	return result;
+}
+
+int SpellEngine::addDictionary(const char* dictionaryFilePath, const char* key) {
+	pollReload();
+	TraceSpan span("add_dic", "hunspell");
+	if (statistics.isEnabled()) {
+		statistics.add(statistics.addDictionaryCalls);
+	}
+	// Not loaded yet: Hunspell's add_dic only fails when the file cannot be
+	// opened, so that is all there is to check now.
+	Hunspell* speller = loaded();
+	int result = speller != nullptr ? speller->add_dic(DictionaryFile::hunspellPath(dictionaryFilePath).c_str(), key)
+		: (DictionaryFile::resolve(dictionaryFilePath).empty() ? 1 : 0);
+	if (result == 0) {
+		if (backend) {
+			backend->addDictionary(dictionaryFilePath, key);
+		}
+		dictionaryPaths.push_back(dictionaryFilePath);
+		dictionaryKeys.push_back(key != nullptr ? key : "");
+	}
+	return result;
+}
+
+int SpellEngine::useSymSpell(SuggestionRanking ranking, const char* frequencyListPath) {
+	std::string frequencies = frequencyListPath != nullptr ? frequencyListPath : "";
+	int result = BuildSymSpell(Sources{ affixPath, dictionaryPaths, dictionaryKeys, addedWords }, ranking, frequencies, backend);
+	if (result == 0) {
+		pendingBackend = 0;
+		symSpellRanking = ranking;
+		symSpellFrequencies = frequencies;
+	}
+	return result;
+}
+
+int SpellEngine::useTrigramIndex() {
+	int result = BuildTrigramIndex(Sources{ affixPath, dictionaryPaths, dictionaryKeys, addedWords }, backend);
+	if (result == 0) {
+		pendingBackend = 0;
+	}
+	return result;
+}
@@ -0,0 +1,403 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <hunspell.hxx>
+#include "Automaton.h"
+#include "CorrectionTable.h"
+#include "HandleStats.h"
+#include "ScratchArena.h"
+#include "SymSpellBackend.h"
+#include "Tokenizer.h"
+#include "TrigramBackend.h"
+#include "Utf.h"
+
+struct EngineSnapshot;
+
+/**
+ * @brief A misspelled token reported by SpellEngine::forEachMisspelling.
+ *
+ * offset and length are in code units of the text that was passed in
+ * (UTF-16 units for std::u16string_view input, bytes for UTF-8 input).
+ * word is the token in UTF-8 and is only valid during the callback.
+ */
+struct Misspelling {
+	uint64_t offset;
+	size_t length;
+	std::string_view word;
+};
+
+/** Return false to stop the scan early. */
+typedef std::function<bool(const Misspelling&)> MisspellingCallback;
+
+/**
+ * @brief Limits that keep one pathological token (a pasted base64 blob, a
+ * long run-together string) from stalling the caller in Hunspell.
+ *
+ * 0 disables a limit. Lengths are in code units of the word passed in
+ * (UTF-16 units, or bytes for UTF-8 input), so they are tested before
+ * anything is converted.
+ */
+struct Guardrails {
+	/** Longer words are not checked and count as correct. */
+	size_t maxCheckLength = 0;
+	/** Longer words get no suggestions. */
+	size_t maxSuggestLength = 0;
+	/** Candidates a suggestion backend may verify with Hunspell per suggest(). */
+	size_t candidateBudget = 0;
+	/** Wall-clock limit of one suggest(); a late suggest returns nothing. */
+	unsigned suggestTimeoutMs = 0;
+};
+
+/** @brief Why the last check() or suggest() was skipped or cut short. */
+enum class GuardrailTrip {
+	None = 0,
+	Length = 1,
+	Budget = 2,
+	Timeout = 3
+};
+
+/**
+ * @brief Platform-neutral spell checking engine around one Hunspell instance.
+ *
+ * Text comes in as UTF-16 (std::u16string_view) or UTF-8 (std::string_view)
+ * and results go out as UTF-8 strings or through callbacks. The engine keeps
+ * its own statistics and records trace spans, so every front end (the VBA
+ * DLL, the command line tools, benchmarks) reports the same numbers.
+ *
+ * Like Hunspell itself, an engine must not be used by several threads at
+ * the same time.
+ */
+class SpellEngine {
+	struct Reload;
+	class SuggestWorker;
+
+public:
+	/**
+	 * @param loadHunspell - false to load the dictionary into Hunspell only
+	 *        when a word first needs it, for engines whose correct words are
+	 *        answered by a shared automaton (see attachSharedDictionary)
+	 * @param key - key of hzip-encrypted .aff/.dic files, NULL otherwise
+	 */
+	SpellEngine(const char* affixFilePath, const char* dictionaryFilePath, bool loadHunspell = true,
+		const char* key = nullptr);
+
+	~SpellEngine();
+
+	SpellEngine(const SpellEngine&) = delete;
+	SpellEngine& operator=(const SpellEngine&) = delete;
+
+	bool check(std::u16string_view word);
+	bool check(std::string_view word);
+
+	std::vector<std::string> suggest(std::u16string_view word);
+	std::vector<std::string> suggest(std::string_view word);
+	std::vector<std::string> suffixSuggest(std::u16string_view word);
+
+	/**
+	 * @brief check() and, for a misspelled word, suggest() in one call.
+	 *
+	 * The word is converted once and the suggest pass starts from the same
+	 * buffer. A suggestion backend stops verifying candidates as soon as it
+	 * has maxSuggestions of them.
+	 * @param maxSuggestions - most suggestions to return (at most 15); 0 only checks
+	 * @param suggestions - replaced with the suggestions, empty for a correct word
+	 * @return check()'s result
+	 */
+	bool checkAndSuggest(std::u16string_view word, size_t maxSuggestions, std::vector<std::string>& suggestions);
+
+	std::vector<std::string> analyze(std::u16string_view word);
+	std::vector<std::string> stem(std::u16string_view word);
+	std::vector<std::string> generate(std::u16string_view word, std::u16string_view example);
+
+	/**
+	 * @brief Stem every token of text, each distinct token once.
+	 * @return distinct stems in order of first appearance; tokens without a
+	 *         stem are returned unchanged.
+	 */
+	std::vector<std::string> stemText(std::u16string_view text);
+
+	/**
+	 * @brief Split text on whitespace and report every misspelled token.
+	 * @return number of misspellings reported
+	 */
+	size_t forEachMisspelling(std::u16string_view text, const MisspellingCallback& callback);
+	size_t forEachMisspelling(std::string_view text, const MisspellingCallback& callback);
+
+	/**
+	 * @brief Report every misspelling in a file without reading it into memory.
+	 *
+	 * The file is memory-mapped and checked in place; UTF-16BE text is
+	 * byte-swapped through a fixed-size window. Misspelling offsets and
+	 * lengths are in bytes from the start of the file, BOM included.
+	 *
+	 * @param encoding - receives the encoding found by DetectEncoding
+	 * @return false if the file could not be opened or mapped
+	 */
+	bool forEachMisspellingInFile(const char* path, const MisspellingCallback& callback, TextEncoding& encoding);
+
+	/** @return 0 on success, otherwise Hunspell's error code. */
+	int addWord(std::u16string_view word);
+
+	/**
+	 * @param dictionaryFilePath - a .dic file, or its hzip-compressed .dic.hz
+	 * @param key - key of an encrypted .hz file, NULL otherwise
+	 * @return 0 on success, otherwise Hunspell's error code.
+	 */
+	int addDictionary(const char* dictionaryFilePath, const char* key = nullptr);
+
+	/**
+	 * @brief Answer suggest() for known misspellings from a precomputed table.
+	 *
+	 * Replaces any table loaded before. On failure the previous table is kept.
+	 * @return number of entries, or -1 if the file could not be loaded
+	 */
+	long long loadCorrections(const char* path);
+
+	/** Drop the correction table so every suggest() goes to Hunspell again. */
+	void clearCorrections() {
+		corrections.reset();
+		correctionsPath.clear();
+	}
+
+	/**
+	 * @brief Accept words found in a prebuilt automaton without asking Hunspell.
+	 *
+	 * The automaton holds the surface forms of the dictionary (see
+	 * HunspellVBACli build-automaton); words it does not contain still go
+	 * to Hunspell, so results do not change, only the cost of correct words.
+	 * Replaces any automaton loaded before. On failure the previous one is kept.
+	 * @return number of words in the automaton, or -1 if the file could not be loaded
+	 */
+	long long loadAutomaton(const char* path);
+
+	/**
+	 * @brief Load the automaton shared by every process that uses the same dictionary files.
+	 *
+	 * The segment for the engine's .aff and .dic files is looked up in
+	 * directory. The first process builds it (every form is expanded and
+	 * verified with Hunspell, which takes seconds); later ones map the same
+	 * file read-only, so the OS keeps a single copy of its pages. Together
+	 * with a lazily loaded Hunspell, an engine that only sees correct words
+	 * never parses the dictionary at all; added words and misses stay private
+	 * to the engine's own Hunspell.
+	 * @return number of words in the segment, or -1 if a dictionary file is
+	 *         missing, the segment cannot be built or loaded, or another
+	 *         process is building it (see PublishDictionarySegment)
+	 */
+	long long attachSharedDictionary(const char* directory);
+
+	/**
+	 * @brief Load the dictionary files again on a background thread.
+	 *
+	 * For when an updated .dic or .aff is published while the engine is in
+	 * use. The engine keeps answering from the current dictionary until the
+	 * new one is complete; the next call after that installs it as a whole,
+	 * together with a rebuilt suggestion index and automaton (a shared
+	 * segment is looked up or built again for the new files, an automaton
+	 * loaded from a file is loaded again from the same path). Dictionaries
+	 * and words added before and during the reload are replayed. A suggest
+	 * still running on the old Hunspell (see Guardrails) finishes on it, and
+	 * the old instance is freed after that.
+	 * @return false if a reload is already running
+	 */
+	bool reload();
+
+	/**
+	 * @brief Wait for the reload started by reload() and install it.
+	 * @return 1 when installed, 0 when no reload was running, -1 when a
+	 *         dictionary file could not be read or memory ran out; the
+	 *         current one is kept then
+	 */
+	int finishReload();
+
+	/** @return true from reload() until the new dictionary is installed */
+	bool reloadPending() const { return reloadJob.valid(); }
+
+	/**
+	 * @brief Write the engine's complete state into one file.
+	 *
+	 * Records the dictionary files with their size, time and content hash,
+	 * the added words, token filter, guardrails, suggestion backend and
+	 * correction table, and an automaton of every dictionary form and added
+	 * word. Building and verifying the automaton takes seconds, once per
+	 * snapshot. Keys of encrypted dictionaries are not stored.
+	 * @return 0 on success, -1 a dictionary file cannot be read, -2 the
+	 *         automaton cannot be built, -3 the file cannot be written
+	 */
+	int saveSnapshot(const char* path) const;
+
+	/**
+	 * @brief Take over the state recorded by saveSnapshot().
+	 *
+	 * For an engine just created from the snapshot's .aff and first .dic
+	 * with loadHunspell false: correct words are answered by the automaton
+	 * in the snapshot file, and Hunspell is loaded, with every dictionary and
+	 * added word, only when a word is not in it. A suggestion index is
+	 * rebuilt by the first suggest() (Hunspell's own suggest is used if that
+	 * fails); a correction table is loaded again if it can still be read.
+	 * Check ReadSnapshot() and SnapshotIsCurrent() first.
+	 * @param key - key of the encrypted dictionaries, NULL if there are none
+	 * @return number of words in the automaton, -1 if it cannot be loaded
+	 */
+	long long restoreSnapshot(const char* path, const EngineSnapshot& snapshot, const char* key);
+
+	/** @return false while Hunspell has not been needed yet */
+	bool hunspellLoaded() const { return hunspell != nullptr; }
+
+	/** Send every check to Hunspell again. */
+	void clearAutomaton();
+
+	/**
+	 * @brief Answer suggest() from a symmetric-delete index instead of Hunspell's suggest.
+	 *
+	 * The index covers the files the engine was created with, every
+	 * dictionary and word added since, and words added later. Candidates are
+	 * still checked with Hunspell before they are returned.
+	 *
+	 * @param frequencyListPath - word list for SuggestionRanking::Frequency, ignored otherwise
+	 * @return 0 on success, -1 if the dictionary cannot be indexed, -2 if the
+	 *         frequency list cannot be read; on failure the current backend is kept
+	 */
+	int useSymSpell(SuggestionRanking ranking, const char* frequencyListPath);
+
+	/**
+	 * @brief Answer suggest() from an inverted trigram index over the dictionary roots.
+	 *
+	 * Like Hunspell's n-gram pass, but only roots sharing trigrams with the
+	 * misspelling are scored, so the cost does not grow with the dictionary.
+	 * Covers the same files and words as useSymSpell().
+	 * @return 0 on success, -1 if the dictionary cannot be indexed; on failure
+	 *         the current backend is kept
+	 */
+	int useTrigramIndex();
+
+	/**
+	 * @brief Skip tokens matched by filter in check() and the misspelling scans.
+	 *
+	 * Skipped tokens count as correct without being converted or passed to
+	 * Hunspell; the statistics count them per rule.
+	 */
+	void setTokenFilter(const TokenFilter& filter) { tokenFilter = filter; }
+	const TokenFilter& getTokenFilter() const { return tokenFilter; }
+
+	/**
+	 * @brief Bound the time a single word can take in check() and suggest().
+	 *
+	 * Words over a length limit are skipped: check() reports them as correct
+	 * and suggest() returns no suggestions. When the candidate budget runs
+	 * out, suggest() returns the candidates verified so far. Hunspell's own
+	 * suggest cannot be interrupted, so with a timeout it runs on a worker
+	 * thread; if it is late, it is left to finish there with the current
+	 * Hunspell instance, and the engine loads a fresh one on its next call.
+	 * Scans skip over-long tokens the same way. Every trip is counted in the
+	 * statistics.
+	 */
+	void setGuardrails(const Guardrails& limits) { guardrails = limits; }
+	const Guardrails& getGuardrails() const { return guardrails; }
+
+	/** @return the guardrail that skipped or cut short the last check() or suggest() */
+	GuardrailTrip lastTrip() const { return trip; }
+
+	/** Go back to Hunspell's own suggest. */
+	void useHunspellSuggest() { backend.reset(); pendingBackend = 0; }
+
+	/** @return heap memory held by the suggestion backend, 0 for Hunspell's own */
+	size_t suggestionBackendBytes() const { return backend ? backend->memoryBytes() : 0; }
+
+	HandleStats& stats() { return statistics; }
+	const HandleStats& stats() const { return statistics; }
+
+private:
+	template <typename Char>
+	size_t scanMisspellings(std::basic_string_view<Char> text, const MisspellingCallback& callback);
+
+	template <typename Char>
+	bool isFiltered(std::basic_string_view<Char> token);
+
+	bool tripped(size_t length, size_t limit);
+	std::vector<std::string> hunspellSuggest(const std::string& word, bool suffixOnly);
+
+	/** Install a finished reload; one relaxed load while none is. */
+	void pollReload() {
+		if (reloadReady.load(std::memory_order_acquire)) {
+			finishReload();
+		}
+	}
+
+	Hunspell& instance();
+	/** @return the loaded instance, NULL if none is or a timed out suggest() still runs on it */
+	Hunspell* loaded();
+	bool spell(const std::string& word);
+	void readAffixRules();
+	bool foldsAsciiCase();
+	/** @return the candidates Hunspell's suggest would try for word, to hold against the budget */
+	size_t hunspellCandidates(const std::string& word);
+	bool checkBuffer(size_t convertedBytes);
+	/** @return the suggestion backend, built first if restoreSnapshot() left it pending; null for Hunspell's own */
+	SuggestionBackend* suggestionBackend();
+	/** @param limit - suggestions after which a backend stops verifying candidates */
+	std::vector<std::string> runSuggest(const std::string& word, bool suffixOnly, size_t limit);
+
+	std::shared_ptr<Hunspell> hunspell; // shared with a suggest() worker that timed out
+	std::string affixPath;
+	std::vector<std::string> dictionaryPaths; // the main .dic first, then addDictionary()
+	std::vector<std::string> dictionaryKeys; // per dictionary path, empty for none; the first also opens the .aff
+	std::vector<std::string> addedWords;
+	std::unique_ptr<Automaton> automaton;
+	std::string automatonPath; // file loadAutomaton() read, loaded again by reload()
+	std::string segmentDirectory; // set by attachSharedDictionary(), for reload()
+	std::unique_ptr<CorrectionTable> corrections;
+	std::string correctionsPath; // for saveSnapshot()
+	std::unique_ptr<SuggestionBackend> backend;
+	int pendingBackend = 0; // backend restoreSnapshot() left to the first suggest(): 1 SymSpell, 2 trigram
+	SuggestionRanking symSpellRanking = SuggestionRanking::Similarity;
+	std::string symSpellFrequencies; // frequency list of the SymSpell index, for reload()
+	TokenFilter tokenFilter;
+	Guardrails guardrails;
+	GuardrailTrip trip = GuardrailTrip::None;
+	HandleStats statistics;
+	std::string wordBuffer;
+	std::string queryBuffer; // the word being suggested for, while wordBuffer holds candidates
+	std::string foldBuffer; // lowercase form of a capitalised word, for the automaton
+	int asciiCaseFolding = -1; // AffixRules::foldsAsciiCase() of the .aff, -1 until needed
+	size_t tryLength = 0; // AffixRules::tryLength(), read along with asciiCaseFolding
+	ScratchArena scratch; // containers of one suggest() or stemText()
+
+	// Declared last so the destructor waits for a running reload before
+	// anything it signals is destroyed.
+	std::atomic<bool> reloadReady{ false };
+	std::future<std::unique_ptr<Reload>> reloadJob;
+	std::future<void> retireJob; // frees what the last reload replaced
+	std::unique_ptr<SuggestWorker> suggestWorker; // runs suggest() calls under a timeout, started by the first
+};
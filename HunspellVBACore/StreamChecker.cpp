@@ -0,0 +1,162 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "StreamChecker.h"
+#include "Tokenizer.h"
+#include "Trace.h"
+
+StreamChecker::StreamChecker(SpellEngine& engine, TextEncoding encoding, size_t maxTokenUnits, size_t maxQueued)
+	: engine(engine), encoding(encoding), maxTokenUnits(maxTokenUnits), maxQueued(maxQueued),
+	tokenOffset(0), streamPosition(0), skipping(false), stopped(false), hasOddByte(false), oddByte(0) {
+}
+
+void StreamChecker::appendUnit(char16_t unit) {
+	size_t tokenUnits = encoding == TextEncoding::Utf8 ? token8.size() : token16.size();
+	if (tokenUnits == 0 && !skipping) {
+		tokenOffset = streamPosition;
+	}
+	if (skipping) {
+		return;
+	}
+	if (tokenUnits >= maxTokenUnits) {
+		// Not a word; drop it rather than buffer an unbounded run.
+		skipping = true;
+		token8.clear();
+		token16.clear();
+		return;
+	}
+	if (encoding == TextEncoding::Utf8) {
+		token8 += (char)unit;
+		if (tokenOffset == 0 && token8 == "\xEF\xBB\xBF") {
+			token8.clear(); // byte order mark
+		}
+	}
+	else if (unit != 0xFEFF || streamPosition != 0) {
+		token16 += unit;
+	}
+}
+
+bool StreamChecker::endToken() {
+	skipping = false;
+	const std::string* word = &token8;
+	size_t units = token8.size();
+	if (encoding != TextEncoding::Utf8) {
+		units = token16.size();
+		if (units != 0) {
+			ToUtf8(token16, utf8);
+			word = &utf8;
+		}
+	}
+	if (units == 0) {
+		return true;
+	}
+	if (queueFull()) {
+		return false;
+	}
+
+	uint32_t length = (uint32_t)(encoding == TextEncoding::Utf8 ? units : units * 2);
+	if (!stopped && !engine.check(std::string_view(*word))) {
+		if (callback) {
+			Misspelling misspelling = { tokenOffset, length, std::string_view(*word) };
+			stopped = !callback(misspelling);
+		}
+		else {
+			queue.push_back({ tokenOffset, length, *word });
+		}
+	}
+	token8.clear();
+	token16.clear();
+	return true;
+}
+
+size_t StreamChecker::push(const void* data, size_t size) {
+	TraceSpan span("stream_push", "stream");
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	size_t consumed = 0;
+
+	if (encoding == TextEncoding::Utf8) {
+		for (; consumed < size; ++consumed) {
+			char c = (char)bytes[consumed];
+			if (IsTokenSpace(c)) {
+				if (!endToken()) {
+					break;
+				}
+			}
+			else {
+				appendUnit((unsigned char)c);
+			}
+			++streamPosition;
+		}
+		return consumed;
+	}
+
+	while (consumed < size) {
+		char16_t unit;
+		size_t unitBytes;
+		if (hasOddByte) {
+			unit = encoding == TextEncoding::Utf16LE
+				? (char16_t)(oddByte | (bytes[consumed] << 8))
+				: (char16_t)((oddByte << 8) | bytes[consumed]);
+			unitBytes = 1;
+		}
+		else if (consumed + 1 < size) {
+			unit = encoding == TextEncoding::Utf16LE
+				? (char16_t)(bytes[consumed] | (bytes[consumed + 1] << 8))
+				: (char16_t)((bytes[consumed] << 8) | bytes[consumed + 1]);
+			unitBytes = 2;
+		}
+		else {
+			hasOddByte = true;
+			oddByte = bytes[consumed];
+			++consumed;
+			break;
+		}
+
+		if (IsTokenSpace(unit)) {
+			if (!endToken()) {
+				break;
+			}
+		}
+		else {
+			appendUnit(unit);
+		}
+		hasOddByte = false;
+		consumed += unitBytes;
+		streamPosition += 2;
+	}
+	return consumed;
+}
+
+bool StreamChecker::finish() {
+	return endToken();
+}
+
+size_t StreamChecker::drain(std::deque<StreamMisspelling>& out, size_t max) {
+	size_t moved = 0;
+	while (moved < max && !queue.empty()) {
+		out.push_back(std::move(queue.front()));
+		queue.pop_front();
+		++moved;
+	}
+	return moved;
+}
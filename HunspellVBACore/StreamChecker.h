@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include "SpellEngine.h"
+
+/** A misspelling found by StreamChecker; offset and length are in bytes of the stream. */
+struct StreamMisspelling {
+	uint64_t offset;
+	uint32_t length;
+	std::string word;
+};
+
+/**
+ * @brief Checks text that arrives in arbitrary chunks.
+ *
+ * Chunks may end anywhere, in the middle of a word, of a UTF-8 sequence or of
+ * a UTF-16 code unit; the incomplete tail is carried over to the next push.
+ * Memory is bounded: a token longer than maxTokenUnits is skipped instead of
+ * buffered, and results wait in a queue of at most maxQueued entries. When
+ * the queue is full, push stops early and returns how many bytes it took, so
+ * the caller drains and pushes the rest again.
+ *
+ * If a callback is set, results go to it instead of the queue and push always
+ * consumes everything. The callback returns false to stop checking; the rest
+ * of the stream is then accepted and ignored. A byte order mark at the start
+ * of the stream is skipped.
+ *
+ * A stream uses its engine without locking and must not outlive it.
+ */
+class StreamChecker {
+public:
+	static const size_t kDefaultMaxTokenUnits = 256;
+	static const size_t kDefaultMaxQueued = 1024;
+
+	StreamChecker(SpellEngine& engine, TextEncoding encoding,
+		size_t maxTokenUnits = kDefaultMaxTokenUnits, size_t maxQueued = kDefaultMaxQueued);
+
+	void setCallback(MisspellingCallback callback) { this->callback = std::move(callback); }
+
+	/** @return number of bytes consumed, less than size only when the queue is full */
+	size_t push(const void* data, size_t size);
+
+	/**
+	 * @brief Check the last token. Call after the final push.
+	 * @return false if the queue is full; drain and call again
+	 */
+	bool finish();
+
+	/** Move up to max queued results to out. @return number moved */
+	size_t drain(std::deque<StreamMisspelling>& out, size_t max);
+
+	size_t queued() const { return queue.size(); }
+	/** @return the index-th queued result, left in the queue; index < queued() */
+	const StreamMisspelling& queuedAt(size_t index) const { return queue[index]; }
+	/** Remove the first count queued results, once the caller has copied them. */
+	void discard(size_t count) { queue.erase(queue.begin(), queue.begin() + (std::min)(count, queue.size())); }
+	uint64_t position() const { return streamPosition; }
+
+private:
+	bool queueFull() const { return !callback && queue.size() >= maxQueued; }
+	void appendUnit(char16_t unit);
+	bool endToken();
+
+	SpellEngine& engine;
+	TextEncoding encoding;
+	size_t maxTokenUnits;
+	size_t maxQueued;
+	MisspellingCallback callback;
+	std::deque<StreamMisspelling> queue;
+
+	std::u16string token16;
+	std::string token8;
+	std::string utf8;
+	uint64_t tokenOffset;
+	uint64_t streamPosition;
+	bool skipping;
+	bool stopped;
+	bool hasOddByte;
+	unsigned char oddByte;
+};
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** Candidates of one suggest() call, in the caller's scratch memory. */
+typedef std::pmr::vector<std::pmr::string> CandidateList;
+
+/**
+ * @brief Replacement for Hunspell's own suggest pass.
+ *
+ * A backend proposes candidate corrections for a misspelled UTF-8 word, best
+ * first. SpellEngine still checks every candidate with Hunspell before
+ * returning it, so a backend may over-generate.
+ */
+class SuggestionBackend {
+public:
+	virtual ~SuggestionBackend() = default;
+
+	/**
+	 * @brief Append up to maxCount candidates for word to out, best first.
+	 *
+	 * Buffers needed only during the call come from out's memory resource,
+	 * which the engine resets when the call returns.
+	 */
+	virtual void suggest(std::string_view word, size_t maxCount, CandidateList& out) const = 0;
+
+	/** Make a word added at runtime (AddWord) available as a candidate. */
+	virtual void addWord(std::string_view word) = 0;
+
+	/**
+	 * @brief Make the words of an extra .dic file available as candidates.
+	 * @param key - key of an encrypted .hz file, NULL otherwise
+	 */
+	virtual bool addDictionary(const char* dictionaryFilePath, const char* key) = 0;
+
+	/** @return approximate heap memory held by the backend */
+	virtual size_t memoryBytes() const = 0;
+
+	/** @return short name used in traces and benchmark output */
+	virtual const char* name() const = 0;
+};
@@ -0,0 +1,397 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SymSpellBackend.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include "EditDistance.h"
+#include "ScratchArena.h"
+#include "Utf.h"
+
+namespace
+{
+	const size_t kMaxWordLength = 64;
+	const size_t kMergeThreshold = 65536;
+	const int kDepthShift = 30;
+	const uint32_t kBaseMask = (1u << kDepthShift) - 1;
+
+	uint32_t Hash(std::u32string_view text) {
+		uint32_t hash = 2166136261u;
+		for (char32_t c : text) {
+			hash = (hash ^ (uint32_t)c) * 16777619u;
+		}
+		return hash;
+	}
+
+	/** A string obtained from a word by deleting depth characters. */
+	struct Deletion {
+		std::pmr::u32string text;
+		int depth;
+
+		bool operator<(const Deletion& other) const {
+			return text != other.text ? text < other.text : depth < other.depth;
+		}
+	};
+
+	/** Collect every string obtained by deleting up to distance characters, each once at its smallest depth. */
+	void CollectDeletes(std::u32string_view text, int distance, std::pmr::vector<Deletion>& out) {
+		std::pmr::memory_resource* memory = out.get_allocator().resource();
+		out.push_back({ std::pmr::u32string(text, memory), 0 });
+		size_t begin = 0;
+		for (int level = 1; level <= distance; ++level) {
+			size_t end = out.size();
+			for (size_t i = begin; i < end; ++i) {
+				for (size_t k = 0; k < out[i].text.size(); ++k) {
+					// Deleting any character of a run gives the same string.
+					if (k > 0 && out[i].text[k] == out[i].text[k - 1]) {
+						continue;
+					}
+					std::pmr::u32string shorter(out[i].text, memory);
+					shorter.erase(k, 1);
+					out.push_back({ std::move(shorter), level });
+				}
+			}
+			begin = end;
+		}
+		std::sort(out.begin(), out.end());
+		out.erase(std::unique(out.begin(), out.end(), [](const Deletion& a, const Deletion& b) {
+			return a.text == b.text;
+		}), out.end());
+	}
+}
+
+bool SymSpellBackend::load(const char* affixFilePath, const char* dictionaryFilePath, const char* key) {
+	entries.clear();
+	suffixIndex.clear();
+	bases.clear();
+	postings.clear();
+	recent.clear();
+	if (!rules.load(affixFilePath, key) || !rules.readDictionary(dictionaryFilePath, entries, key)) {
+		entries.clear();
+		return false;
+	}
+	indexEntries(0);
+	return true;
+}
+
+bool SymSpellBackend::addDictionary(const char* dictionaryFilePath, const char* key) {
+	size_t first = entries.size();
+	if (!rules.readDictionary(dictionaryFilePath, entries, key)) {
+		return false;
+	}
+	indexEntries(first);
+	return true;
+}
+
+void SymSpellBackend::addWord(std::string_view word) {
+	AffixRules::Entry entry;
+	DecodeUtf8(word, entry.stem);
+	if (entry.stem.empty()) {
+		return;
+	}
+	entries.push_back(std::move(entry));
+	indexEntries(entries.size() - 1);
+}
+
+void SymSpellBackend::indexEntries(size_t firstEntry) {
+	std::vector<Posting> added;
+	std::vector<uint16_t> strips;
+	for (size_t i = firstEntry; i < entries.size(); ++i) {
+		const AffixRules::Entry& entry = entries[i];
+		if (entry.stem.size() > kMaxWordLength) {
+			continue;
+		}
+
+		// One base for the stem itself and one per distinct strip length.
+		strips.assign(1, 0);
+		for (uint32_t flag : entry.flags) {
+			const AffixRules::AffixClass* suffixes = rules.suffixes(flag);
+			if (suffixes == nullptr) {
+				continue;
+			}
+			if (suffixIndex.find(flag) == suffixIndex.end()) {
+				std::vector<SuffixKey>& keys = suffixIndex[flag];
+				for (const AffixRules::Rule& rule : suffixes->rules) {
+					keys.push_back({ rule.affix, (uint16_t)rule.strip.size(), (uint16_t)rule.add.size(), &rule });
+				}
+			}
+			for (const AffixRules::Rule& rule : suffixes->rules) {
+				if (!rule.strip.empty() && AffixRules::suffixApplies(rule, entry.stem)) {
+					strips.push_back((uint16_t)rule.strip.size());
+				}
+			}
+		}
+		std::sort(strips.begin(), strips.end());
+		strips.erase(std::unique(strips.begin(), strips.end()), strips.end());
+		for (uint16_t strip : strips) {
+			indexBase((uint32_t)i, strip, added);
+		}
+	}
+
+	std::sort(added.begin(), added.end());
+	if (postings.empty()) {
+		postings.swap(added);
+		postings.shrink_to_fit();
+		return;
+	}
+	std::vector<Posting> merged;
+	merged.reserve(recent.size() + added.size());
+	std::merge(recent.begin(), recent.end(), added.begin(), added.end(), std::back_inserter(merged));
+	recent.swap(merged);
+	if (recent.size() > kMergeThreshold) {
+		mergePostings();
+	}
+}
+
+void SymSpellBackend::indexBase(uint32_t entry, uint16_t strip, std::vector<Posting>& out) {
+	uint32_t index = (uint32_t)bases.size();
+	bases.push_back({ entry, strip });
+
+	std::pmr::vector<Deletion> deletes;
+	CollectDeletes(baseText(bases.back()), kMaxDistance, deletes);
+	for (const Deletion& deleted : deletes) {
+		out.push_back({ Hash(deleted.text), index | ((uint32_t)deleted.depth << kDepthShift) });
+	}
+	std::sort(out.end() - deletes.size(), out.end());
+	out.erase(std::unique(out.end() - deletes.size(), out.end(), [](const Posting& a, const Posting& b) {
+		return a.first == b.first;
+	}), out.end());
+}
+
+void SymSpellBackend::mergePostings() {
+	std::vector<Posting> merged;
+	merged.reserve(postings.size() + recent.size());
+	std::merge(postings.begin(), postings.end(), recent.begin(), recent.end(), std::back_inserter(merged));
+	postings.swap(merged);
+	recent.clear();
+}
+
+const std::vector<SymSpellBackend::SuffixKey>* SymSpellBackend::suffixKeys(uint32_t flag) const {
+	auto found = suffixIndex.find(flag);
+	return found == suffixIndex.end() ? nullptr : &found->second;
+}
+
+std::u32string_view SymSpellBackend::baseText(const Base& base) const {
+	const std::u32string& stem = entries[base.entry].stem;
+	return std::u32string_view(stem.data(), stem.size() - base.strip);
+}
+
+bool SymSpellBackend::loadFrequencies(const char* path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	std::vector<std::pair<std::string, long long>> list;
+	std::string line;
+	while (std::getline(file, line)) {
+		if (list.empty() && line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+			line.erase(0, 3);
+		}
+		size_t end = line.find_first_of(" \t\r");
+		if (end == 0 || line.empty()) {
+			continue;
+		}
+		std::string word = line.substr(0, end);
+		long long count = -1;
+		if (end != std::string::npos) {
+			size_t digits = line.find_first_not_of(" \t", end);
+			if (digits != std::string::npos && line[digits] >= '0' && line[digits] <= '9') {
+				count = atoll(line.c_str() + digits);
+			}
+		}
+		list.emplace_back(std::move(word), count);
+	}
+
+	frequencies.clear();
+	frequencies.reserve(list.size());
+	for (size_t i = 0; i < list.size(); ++i) {
+		uint64_t value = list[i].second >= 0 ? (uint64_t)list[i].second : (uint64_t)(list.size() - i);
+		frequencies.emplace(std::move(list[i].first), value);
+	}
+	return true;
+}
+
+void SymSpellBackend::collectForms(std::u32string_view text, int maxDistance,
+	std::pmr::unordered_set<std::u32string_view>& found) const {
+	std::pmr::memory_resource* memory = found.get_allocator().resource();
+	std::pmr::unordered_set<uint64_t> visited(memory);
+	std::pmr::vector<Deletion> deletes(memory);
+	std::pmr::u32string form(memory);
+
+	// Distance from the tail to each distinct suffix string, computed on
+	// first use for the current split; most bases share the same suffixes.
+	std::pmr::vector<signed char> tailDistance(memory);
+
+	for (size_t split = 0; split <= text.size(); ++split) {
+		std::u32string_view head = text.substr(0, split);
+		std::u32string_view tail = text.substr(split);
+		const DistancePattern headPattern(head, memory);
+		const DistancePattern tailPattern(tail, memory);
+		tailDistance.assign(rules.affixes().size(), -1);
+		deletes.clear();
+		CollectDeletes(head, maxDistance, deletes);
+
+		for (const Deletion& deleted : deletes) {
+			// Strings within maxDistance share a deletion of at most
+			// maxDistance characters from each side.
+			Posting probe(Hash(deleted.text), 0);
+			for (const std::vector<Posting>* list : { &postings, &recent }) {
+				auto it = std::lower_bound(list->begin(), list->end(), probe);
+				for (; it != list->end() && it->first == probe.first; ++it) {
+					if ((int)(it->second >> kDepthShift) > maxDistance) {
+						continue;
+					}
+					uint32_t baseIndex = it->second & kBaseMask;
+					const Base& base = bases[baseIndex];
+					std::u32string_view baseString = baseText(base);
+					if (std::abs((int)baseString.size() - (int)split) > maxDistance
+						|| !visited.insert(((uint64_t)baseIndex << 8) | split).second) {
+						continue;
+					}
+					int headDistance = headPattern.distance(baseString, maxDistance);
+					if (headDistance > maxDistance) {
+						continue;
+					}
+					int budget = maxDistance - headDistance;
+
+					const AffixRules::Entry& entry = entries[base.entry];
+					if (base.strip == 0 && (int)tail.size() <= budget) {
+						// The stem outlives the call; only new forms are copied.
+						found.insert(entry.stem);
+					}
+					for (uint32_t flag : entry.flags) {
+						const std::vector<SuffixKey>* keys = suffixKeys(flag);
+						if (keys == nullptr) {
+							continue;
+						}
+						// Keys are ordered by suffix length; only those within
+						// budget of the tail length can match.
+						size_t shortest = tail.size() > (size_t)budget ? tail.size() - budget : 0;
+						auto key = std::lower_bound(keys->begin(), keys->end(), shortest,
+							[](const SuffixKey& k, size_t length) { return k.addLength < length; });
+						for (; key != keys->end() && key->addLength <= tail.size() + budget; ++key) {
+							if (key->strip != base.strip) {
+								continue;
+							}
+							signed char& distance = tailDistance[key->affix];
+							if (distance < 0) {
+								distance = (signed char)tailPattern.distance(key->rule->add, maxDistance);
+							}
+							if (distance > budget || !AffixRules::suffixApplies(*key->rule, entry.stem)) {
+								continue;
+							}
+							form.assign(baseString);
+							form += key->rule->add;
+							if (found.count(form) == 0) {
+								found.insert(ScratchCopy<char32_t>(memory, form));
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void SymSpellBackend::suggest(std::string_view word, size_t maxCount, CandidateList& out) const {
+	std::pmr::memory_resource* memory = out.get_allocator().resource();
+	std::pmr::u32string misspelling(memory);
+	DecodeUtf8(word, misspelling);
+	if (misspelling.empty() || misspelling.size() > kMaxWordLength || maxCount == 0) {
+		return;
+	}
+
+	// Most typos are a single edit away, and the distance 1 search is far
+	// cheaper; only when it finds nothing is distance 2 searched.
+	const std::u32string_view text(misspelling);
+	std::pmr::unordered_set<std::u32string_view> found(memory);
+	for (int distance = 1; distance <= kMaxDistance && found.empty(); ++distance) {
+		collectForms(text, distance, found);
+		found.erase(text);
+	}
+
+	struct Candidate {
+		int distance;
+		uint64_t frequency;
+		int similarity;
+		std::pmr::string utf8;
+	};
+	std::pmr::vector<std::u32string_view> views(found.begin(), found.end(), memory);
+	std::pmr::vector<int> distances(views.size(), memory);
+	DistancePattern(text, memory).distances(views.data(), views.size(), kMaxDistance, distances.data());
+
+	// Frequencies are keyed by std::string; one key buffer serves every lookup.
+	std::string key;
+	std::pmr::vector<Candidate> candidates(memory);
+	candidates.reserve(found.size());
+	for (size_t i = 0; i < views.size(); ++i) {
+		std::u32string_view candidate = views[i];
+		Candidate ranked = { distances[i], 0, 0, std::pmr::string(memory) };
+		ranked.similarity = Similarity(text, candidate);
+		AppendUtf8(std::u32string_view(candidate), ranked.utf8);
+		if (ranking == SuggestionRanking::Frequency) {
+			key.assign(ranked.utf8);
+			auto frequency = frequencies.find(key);
+			if (frequency != frequencies.end()) {
+				ranked.frequency = frequency->second;
+			}
+		}
+		candidates.push_back(std::move(ranked));
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		if (a.distance != b.distance) {
+			return a.distance < b.distance;
+		}
+		if (a.frequency != b.frequency) {
+			return a.frequency > b.frequency;
+		}
+		if (a.similarity != b.similarity) {
+			return a.similarity > b.similarity;
+		}
+		return a.utf8 < b.utf8;
+	});
+
+	for (size_t i = 0; i < candidates.size() && i < maxCount; ++i) {
+		out.push_back(std::move(candidates[i].utf8));
+	}
+}
+
+size_t SymSpellBackend::memoryBytes() const {
+	size_t bytes = entries.capacity() * sizeof(AffixRules::Entry)
+		+ bases.capacity() * sizeof(Base)
+		+ (postings.capacity() + recent.capacity()) * sizeof(Posting);
+	for (const AffixRules::Entry& entry : entries) {
+		bytes += entry.stem.capacity() * sizeof(char32_t) + entry.flags.capacity() * sizeof(uint32_t);
+	}
+	for (const auto& keys : suffixIndex) {
+		bytes += keys.second.capacity() * sizeof(SuffixKey);
+	}
+	for (const auto& frequency : frequencies) {
+		bytes += sizeof(frequency) + frequency.first.capacity() + 2 * sizeof(void*);
+	}
+	return bytes;
+}
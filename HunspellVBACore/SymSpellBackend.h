@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "AffixRules.h"
+#include "SuggestionBackend.h"
+
+/** How SymSpellBackend orders candidates at the same edit distance. */
+enum class SuggestionRanking {
+	Similarity = 0, ///< n-gram and common-substring score in the style of Hunspell's ngsuggest
+	Frequency = 1   ///< word frequencies from a list, similarity for ties
+};
+
+/**
+ * @brief Symmetric-delete (SymSpell) candidate search over a Hunspell dictionary.
+ *
+ * Materialising every surface form does not scale to agglutinative
+ * dictionaries (tk-TM expands to about 7.5 million words), so the index is
+ * built over affix bases instead: every stem, and every stem with the
+ * characters a suffix rule strips removed. Each base contributes all of its
+ * deletions of up to kMaxDistance characters.
+ *
+ * A lookup splits the misspelling at every position. The head is matched
+ * against bases through the delete index, and the tail against the suffixes
+ * the base's flags allow, within whatever distance the head left over. Since
+ * an alignment of word and base + suffix always splits at some position,
+ * this finds every suffixed form within the distance. Distance 2 is only
+ * searched when nothing is found at distance 1. Prefixed forms and
+ * compounds are not searched.
+ */
+class SymSpellBackend : public SuggestionBackend {
+public:
+	static const int kMaxDistance = 2;
+
+	/**
+	 * @param key - key of encrypted .hz files (see DictionaryFile), NULL otherwise
+	 * @return false if the .aff or .dic file cannot be read
+	 */
+	bool load(const char* affixFilePath, const char* dictionaryFilePath, const char* key = nullptr);
+
+	/**
+	 * @brief Read "word [count]" lines (UTF-8) used by SuggestionRanking::Frequency.
+	 *
+	 * Words without a count rank by their position in the list.
+	 * @return false if the file cannot be read
+	 */
+	bool loadFrequencies(const char* path);
+
+	void setRanking(SuggestionRanking value) { ranking = value; }
+
+	void suggest(std::string_view word, size_t maxCount, CandidateList& out) const override;
+	void addWord(std::string_view word) override;
+	bool addDictionary(const char* dictionaryFilePath, const char* key) override;
+	size_t memoryBytes() const override;
+	const char* name() const override { return "symspell"; }
+
+	size_t baseCount() const { return bases.size(); }
+
+private:
+	/** A stem with strip characters removed from its end. */
+	struct Base {
+		uint32_t entry;
+		uint16_t strip;
+	};
+
+	/**
+	 * One deletion of a base: (hash of the deleted string, base index with
+	 * the number of deleted characters in the top two bits).
+	 */
+	typedef std::pair<uint32_t, uint32_t> Posting;
+
+	/**
+	 * Compact copy of a suffix rule for the lookup loop, which visits tens of
+	 * thousands of rules per word; AffixRules::Rule is too large to scan.
+	 */
+	struct SuffixKey {
+		uint32_t affix;
+		uint16_t strip;
+		uint16_t addLength;
+		const AffixRules::Rule* rule;
+	};
+
+	void collectForms(std::u32string_view text, int maxDistance, std::pmr::unordered_set<std::u32string_view>& found) const;
+	void indexEntries(size_t firstEntry);
+	void indexBase(uint32_t entry, uint16_t strip, std::vector<Posting>& out);
+	std::u32string_view baseText(const Base& base) const;
+	void mergePostings();
+	const std::vector<SuffixKey>* suffixKeys(uint32_t flag) const;
+
+	AffixRules rules;
+	std::vector<AffixRules::Entry> entries;
+	std::unordered_map<uint32_t, std::vector<SuffixKey>> suffixIndex; // by flag, ordered by addLength
+	std::vector<Base> bases;
+	std::vector<Posting> postings; // sorted by hash
+	std::vector<Posting> recent;   // sorted, merged into postings when it grows
+	std::unordered_map<std::string, uint64_t> frequencies;
+	SuggestionRanking ranking = SuggestionRanking::Similarity;
+};
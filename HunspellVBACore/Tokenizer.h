@@ -0,0 +1,180 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief Whitespace test used for tokenizing, identical for UTF-8 and UTF-16.
+ *
+ * Matches isspace() in the "C" locale, which is what operator>> on an
+ * istringstream used to split GetMisspellings input.
+ */
+template <typename Char>
+inline bool IsTokenSpace(Char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * @brief ASCII punctuation trimmed from the ends of tokens for stemming.
+ *
+ * Hyphens and apostrophes are kept because they occur inside words.
+ */
+template <typename Char>
+inline bool IsTrimmedPunctuation(Char c) {
+	return (c >= '!' && c <= '/' && c != '-' && c != '\'') ||
+		(c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~');
+}
+
+/**
+ * @brief Splits text into whitespace-separated tokens without copying.
+ *
+ * Offsets and lengths are in code units of the input.
+ */
+template <typename Char>
+class WhitespaceTokenizer {
+public:
+	explicit WhitespaceTokenizer(std::basic_string_view<Char> text) : text(text), position(0) {
+	}
+
+	bool next(std::basic_string_view<Char>& token, size_t& offset) {
+		while (position < text.size() && IsTokenSpace(text[position])) {
+			++position;
+		}
+		if (position == text.size()) {
+			return false;
+		}
+
+		offset = position;
+		while (position < text.size() && !IsTokenSpace(text[position])) {
+			++position;
+		}
+		token = text.substr(offset, position - offset);
+		return true;
+	}
+
+private:
+	std::basic_string_view<Char> text;
+	size_t position;
+};
+
+/** Remove IsTrimmedPunctuation characters from both ends of token. */
+template <typename Char>
+inline void TrimPunctuation(std::basic_string_view<Char>& token, size_t& offset) {
+	while (!token.empty() && IsTrimmedPunctuation(token.front())) {
+		token.remove_prefix(1);
+		++offset;
+	}
+	while (!token.empty() && IsTrimmedPunctuation(token.back())) {
+		token.remove_suffix(1);
+	}
+}
+
+/**
+ * @brief Classifies tokens that should not be spell checked at all.
+ *
+ * Spreadsheets and forms are full of invoice numbers, dates, URLs, e-mail
+ * addresses and codes that Hunspell would only flag. classify() looks at
+ * each code unit once and reports the first enabled rule the token matches;
+ * with no rules enabled it returns without reading the token.
+ */
+struct TokenFilter {
+	/** Tokens containing an ASCII digit: numbers, dates, amounts, part codes. */
+	static const unsigned kDigits = 1;
+	/** Tokens with a scheme ("https://...") or starting with "www.". */
+	static const unsigned kUrls = 2;
+	/** Tokens with one '@' followed by a domain containing a dot. */
+	static const unsigned kEmails = 4;
+	/** ASCII tokens without lowercase letters, up to maxUppercaseLength units long. */
+	static const unsigned kUppercase = 8;
+	static const unsigned kAll = kDigits | kUrls | kEmails | kUppercase;
+
+	unsigned rules = 0;
+	/** 0 skips all-uppercase tokens of any length. */
+	size_t maxUppercaseLength = 0;
+
+	/** @return the rule (one of the k* flags) that skips token, or 0 to check it */
+	template <typename Char>
+	unsigned classify(std::basic_string_view<Char> token) const {
+		if (rules == 0 || token.empty()) {
+			return 0;
+		}
+
+		typedef typename std::make_unsigned<Char>::type Unit;
+		const size_t none = std::basic_string_view<Char>::npos;
+		bool digit = false;
+		bool lower = false;
+		bool upper = false;
+		bool nonAscii = false;
+		bool scheme = false;
+		size_t at = none;
+		size_t ats = 0;
+		size_t lastDot = none;
+		for (size_t i = 0; i < token.size(); ++i) {
+			Unit c = (Unit)token[i];
+			if (c >= '0' && c <= '9') {
+				digit = true;
+			}
+			else if (c >= 'a' && c <= 'z') {
+				lower = true;
+			}
+			else if (c >= 'A' && c <= 'Z') {
+				upper = true;
+			}
+			else if (c == '@') {
+				at = i;
+				++ats;
+			}
+			else if (c == '.') {
+				lastDot = i;
+			}
+			else if (c == ':') {
+				scheme = scheme || (i > 0 && i + 2 < token.size() && token[i + 1] == '/' && token[i + 2] == '/');
+			}
+			else if (c >= 0x80) {
+				nonAscii = true;
+			}
+		}
+
+		if ((rules & kDigits) && digit) {
+			return kDigits;
+		}
+		if ((rules & kUrls) && (scheme || (token.size() > 4 && (token[0] | 0x20) == 'w'
+			&& (token[1] | 0x20) == 'w' && (token[2] | 0x20) == 'w' && token[3] == '.'))) {
+			return kUrls;
+		}
+		if ((rules & kEmails) && ats == 1 && at > 0 && lastDot != none && lastDot > at + 1 && lastDot + 1 < token.size()) {
+			return kEmails;
+		}
+		// Case is only known for ASCII letters, so tokens with other letters
+		// are always checked.
+		if ((rules & kUppercase) && upper && !lower && !nonAscii
+			&& (maxUppercaseLength == 0 || token.size() <= maxUppercaseLength)) {
+			return kUppercase;
+		}
+		return 0;
+	}
+};
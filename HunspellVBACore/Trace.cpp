@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	uint32_t CurrentThreadId() {
+		static std::atomic<uint32_t> nextThreadId(1);
+		thread_local uint32_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+		return threadId;
+	}
+}
+
+TraceBuffer& TraceBuffer::instance() {
+	static TraceBuffer buffer;
+	return buffer;
+}
+
+TraceBuffer::TraceBuffer() : enabled(false), next(0), slots(nullptr) {
+}
+
+void TraceBuffer::setEnabled(bool enable) {
+	if (enable && slots.load(std::memory_order_acquire) == nullptr) {
+		Slot* allocated = new Slot[kCapacity];
+		for (size_t i = 0; i < kCapacity; ++i) {
+			allocated[i].sequence.store(0, std::memory_order_relaxed);
+		}
+		Slot* expected = nullptr;
+		if (!slots.compare_exchange_strong(expected, allocated, std::memory_order_acq_rel)) {
+			delete[] allocated;
+		}
+	}
+	enabled.store(enable, std::memory_order_relaxed);
+}
+
+uint64_t TraceBuffer::now() {
+	static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void TraceBuffer::record(const char* name, const char* category, uint64_t startNs, uint64_t endNs) {
+	Slot* buffer = slots.load(std::memory_order_acquire);
+	if (buffer == nullptr) {
+		return;
+	}
+
+	uint64_t index = next.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = buffer[index & (kCapacity - 1)];
+
+	// Sequence 0 marks the slot as being written; readers skip it.
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.category.store(category, std::memory_order_relaxed);
+	slot.startNs.store(startNs, std::memory_order_relaxed);
+	slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+	slot.threadId.store(CurrentThreadId(), std::memory_order_relaxed);
+	slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void TraceBuffer::clear() {
+	Slot* buffer = slots.load(std::memory_order_acquire);
+	if (buffer == nullptr) {
+		return;
+	}
+	for (size_t i = 0; i < kCapacity; ++i) {
+		buffer[i].sequence.store(0, std::memory_order_relaxed);
+	}
+}
+
+int TraceBuffer::writeJson(const char* path) const {
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		return -1;
+	}
+
+	const Slot* buffer = slots.load(std::memory_order_acquire);
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	int written = 0;
+	char line[256];
+	for (size_t i = 0; buffer != nullptr && i < kCapacity; ++i) {
+		const Slot& slot = buffer[i];
+		uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence == 0) {
+			continue;
+		}
+		const char* name = slot.name.load(std::memory_order_relaxed);
+		const char* category = slot.category.load(std::memory_order_relaxed);
+		uint64_t startNs = slot.startNs.load(std::memory_order_relaxed);
+		uint64_t durationNs = slot.durationNs.load(std::memory_order_relaxed);
+		uint32_t threadId = slot.threadId.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+			continue; // overwritten while we were reading it
+		}
+
+		snprintf(line, sizeof(line), "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			written == 0 ? "" : ",", name, category, threadId, startNs / 1000.0, durationNs / 1000.0);
+		file << line;
+		++written;
+	}
+	file << "\n]}\n";
+	return file.good() ? written : -1;
+}
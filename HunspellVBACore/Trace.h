@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Process-wide ring buffer of completed spans for Chrome trace-event output.
+ *
+ * Recording is lock-free: a writer claims a slot with one fetch_add and
+ * publishes it with a sequence number, so concurrent exports never wait on
+ * each other. When the buffer wraps the oldest spans are overwritten.
+ * Span names and categories must be string literals; only the pointer is kept.
+ * The slots are allocated the first time tracing is enabled.
+ */
+class TraceBuffer {
+public:
+	static const size_t kCapacity = 1 << 16;
+
+	static TraceBuffer& instance();
+
+	bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+	void setEnabled(bool enable);
+
+	/** Nanoseconds since the first call, on a monotonic clock. */
+	static uint64_t now();
+
+	void record(const char* name, const char* category, uint64_t startNs, uint64_t endNs);
+	void clear();
+
+	/**
+	 * @brief Write the buffered spans as a Chrome trace-event JSON file.
+	 * @return number of spans written, or -1 if the file could not be created.
+	 */
+	int writeJson(const char* path) const;
+
+private:
+	struct Slot {
+		std::atomic<uint64_t> sequence;
+		std::atomic<const char*> name;
+		std::atomic<const char*> category;
+		std::atomic<uint64_t> startNs;
+		std::atomic<uint64_t> durationNs;
+		std::atomic<uint32_t> threadId;
+	};
+
+	TraceBuffer();
+
+	std::atomic<bool> enabled;
+	std::atomic<uint64_t> next;
+	std::atomic<Slot*> slots;
+};
+
+/**
+ * @brief Records the lifetime of the scope as one span while tracing is enabled.
+ */
+class TraceSpan {
+public:
+	TraceSpan(const char* name, const char* category)
+		: name(name), category(category), startNs(0), active(TraceBuffer::instance().isEnabled()) {
+		if (active) {
+			startNs = TraceBuffer::now();
+		}
+	}
+
+	~TraceSpan() {
+		finish();
+	}
+
+	/** Ends the span before the end of the scope. */
+	void finish() {
+		if (active) {
+			TraceBuffer::instance().record(name, category, startNs, TraceBuffer::now());
+			active = false;
+		}
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+	const char* name;
+	const char* category;
+	uint64_t startNs;
+	bool active;
+};
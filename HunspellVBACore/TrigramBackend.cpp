@@ -0,0 +1,263 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "TrigramBackend.h"
+#include <algorithm>
+#include <array>
+#include <unordered_set>
+#include "EditDistance.h"
+#include "ScratchArena.h"
+#include "Utf.h"
+
+namespace
+{
+	const size_t kMaxWordLength = 64;
+
+	/** Code point 0 marks the start of a word, so roots are matched as word beginnings. */
+	const char32_t kBoundary = 0;
+
+	uint64_t Key(char32_t a, char32_t b, char32_t c) {
+		return ((uint64_t)a << 42) | ((uint64_t)b << 21) | (uint64_t)c;
+	}
+
+	/**
+	 * Distinct trigrams of the boundary-marked text. The end is not marked:
+	 * most forms are a root followed by a suffix, so a root's trigrams should
+	 * all occur inside the word.
+	 */
+	void Trigrams(std::u32string_view text, std::pmr::vector<uint64_t>& out) {
+		out.clear();
+		if (text.empty()) {
+			return;
+		}
+		if (text.size() == 1) {
+			out.push_back(Key(kBoundary, text[0], kBoundary));
+			return;
+		}
+		out.push_back(Key(kBoundary, text[0], text[1]));
+		for (size_t i = 0; i + 2 < text.size(); ++i) {
+			out.push_back(Key(text[i], text[i + 1], text[i + 2]));
+		}
+		std::sort(out.begin(), out.end());
+		out.erase(std::unique(out.begin(), out.end()), out.end());
+	}
+
+	/** Letter counts of a word, with code points folded into kLetterBuckets buckets. */
+	const size_t kLetterBuckets = 64;
+	typedef std::array<int8_t, kLetterBuckets> LetterCounts;
+
+	void CountLetters(std::u32string_view text, LetterCounts& counts) {
+		counts.fill(0);
+		for (char32_t c : text) {
+			++counts[c % kLetterBuckets];
+		}
+	}
+
+	/**
+	 * Lower bound of the edit distance from the letter counts alone: every
+	 * edit removes at most one surplus letter on either side. Folding letters
+	 * into buckets only lowers the bound, so it is still safe to reject on.
+	 */
+	int LetterDistance(const LetterCounts& word, std::u32string_view candidate) {
+		LetterCounts counts = word;
+		for (char32_t c : candidate) {
+			--counts[c % kLetterBuckets];
+		}
+		int missing = 0;
+		int extra = 0;
+		for (int8_t count : counts) {
+			if (count > 0) {
+				missing += count;
+			}
+			else {
+				extra -= count;
+			}
+		}
+		return std::max(missing, extra);
+	}
+
+	/** Short words tolerate fewer edits, as with Hunspell's own suggestions. */
+	int MaxDistance(size_t length) {
+		return length <= 4 ? 1 : length <= 8 ? 2 : 3;
+	}
+}
+
+bool TrigramBackend::load(const char* affixFilePath, const char* dictionaryFilePath, const char* key) {
+	entries.clear();
+	trigramCounts.clear();
+	postings.clear();
+	if (!rules.load(affixFilePath, key) || !rules.readDictionary(dictionaryFilePath, entries, key)) {
+		entries.clear();
+		return false;
+	}
+	indexEntries(0);
+	return true;
+}
+
+bool TrigramBackend::addDictionary(const char* dictionaryFilePath, const char* key) {
+	size_t first = entries.size();
+	if (!rules.readDictionary(dictionaryFilePath, entries, key)) {
+		return false;
+	}
+	indexEntries(first);
+	return true;
+}
+
+void TrigramBackend::addWord(std::string_view word) {
+	AffixRules::Entry entry;
+	DecodeUtf8(word, entry.stem);
+	if (entry.stem.empty()) {
+		return;
+	}
+	entries.push_back(std::move(entry));
+	indexEntries(entries.size() - 1);
+}
+
+void TrigramBackend::indexEntries(size_t firstEntry) {
+	std::pmr::vector<uint64_t> trigrams;
+	trigramCounts.resize(entries.size(), 0);
+	for (size_t i = firstEntry; i < entries.size(); ++i) {
+		const std::u32string& stem = entries[i].stem;
+		if (stem.size() > kMaxWordLength) {
+			continue;
+		}
+		Trigrams(stem, trigrams);
+		trigramCounts[i] = (uint8_t)trigrams.size();
+		for (uint64_t trigram : trigrams) {
+			postings[trigram].push_back((uint32_t)i);
+		}
+	}
+}
+
+void TrigramBackend::suggest(std::string_view word, size_t maxCount, CandidateList& out) const {
+	std::pmr::memory_resource* memory = out.get_allocator().resource();
+	std::pmr::u32string misspelling(memory);
+	DecodeUtf8(word, misspelling);
+	if (misspelling.empty() || misspelling.size() > kMaxWordLength || maxCount == 0) {
+		return;
+	}
+	const std::u32string_view text(misspelling);
+
+	// Count shared trigrams for the roots on the misspelling's posting lists
+	// only; every other root shares none.
+	std::pmr::vector<uint64_t> trigrams(memory);
+	Trigrams(text, trigrams);
+	sharedCounts.resize(entries.size(), 0);
+	touched.clear();
+	for (uint64_t trigram : trigrams) {
+		auto list = postings.find(trigram);
+		if (list == postings.end()) {
+			continue;
+		}
+		for (uint32_t entry : list->second) {
+			if (sharedCounts[entry]++ == 0) {
+				touched.push_back(entry);
+			}
+		}
+	}
+
+	// A root scores its shared trigrams minus the ones the misspelling lacks.
+	std::pmr::vector<std::pair<int, uint32_t>> roots(memory);
+	for (uint32_t entry : touched) {
+		int score = 2 * (int)sharedCounts[entry] - (int)trigramCounts[entry];
+		sharedCounts[entry] = 0;
+		roots.emplace_back(-score, entry);
+	}
+	if (roots.size() > kMaxRoots) {
+		std::nth_element(roots.begin(), roots.begin() + kMaxRoots, roots.end());
+		roots.resize(kMaxRoots);
+	}
+
+	const int maxDistance = MaxDistance(text.size());
+	const size_t minLength = text.size() > (size_t)maxDistance ? text.size() - maxDistance : 0;
+	LetterCounts counts;
+	CountLetters(text, counts);
+	std::pmr::unordered_set<std::u32string_view> seen(memory);
+	std::pmr::vector<std::u32string_view> forms(memory);
+	for (const auto& root : roots) {
+		rules.expand(entries[root.second], minLength, text.size() + maxDistance, [&](std::u32string_view form) {
+			if (form == text || LetterDistance(counts, form) > maxDistance || seen.count(form) != 0) {
+				return;
+			}
+			// form points into expand()'s buffer; keep a copy.
+			forms.push_back(ScratchCopy(memory, form));
+			seen.insert(forms.back());
+		}, memory);
+	}
+	std::pmr::vector<int> distances(forms.size(), memory);
+	DistancePattern(text, memory).distances(forms.data(), forms.size(), maxDistance, distances.data());
+
+	std::pmr::u32string letters(text, memory);
+	std::sort(letters.begin(), letters.end());
+	std::pmr::u32string formLetters(memory);
+	struct Candidate {
+		int distance;
+		bool rearranged;
+		int similarity;
+		std::pmr::string utf8;
+	};
+	std::pmr::vector<Candidate> candidates(memory);
+	for (size_t i = 0; i < forms.size(); ++i) {
+		if (distances[i] > maxDistance) {
+			continue;
+		}
+		std::u32string_view form = forms[i];
+		Candidate candidate = { distances[i], false, 0, std::pmr::string(memory) };
+		formLetters.assign(form);
+		std::sort(formLetters.begin(), formLetters.end());
+		candidate.rearranged = formLetters == letters;
+		candidate.similarity = Similarity(text, form);
+		AppendUtf8(form, candidate.utf8);
+		candidates.push_back(std::move(candidate));
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		if (a.distance != b.distance) {
+			return a.distance < b.distance;
+		}
+		// Swapped letters are the most common typo at any distance, which is
+		// why Hunspell tries them first too.
+		if (a.rearranged != b.rearranged) {
+			return a.rearranged;
+		}
+		if (a.similarity != b.similarity) {
+			return a.similarity > b.similarity;
+		}
+		return a.utf8 < b.utf8;
+	});
+
+	for (size_t i = 0; i < candidates.size() && i < maxCount; ++i) {
+		out.push_back(std::move(candidates[i].utf8));
+	}
+}
+
+size_t TrigramBackend::memoryBytes() const {
+	size_t bytes = entries.capacity() * sizeof(AffixRules::Entry) + trigramCounts.capacity();
+	for (const AffixRules::Entry& entry : entries) {
+		bytes += entry.stem.capacity() * sizeof(char32_t) + entry.flags.capacity() * sizeof(uint32_t);
+	}
+	for (const auto& list : postings) {
+		bytes += sizeof(list) + 2 * sizeof(void*) + list.second.capacity() * sizeof(uint32_t);
+	}
+	return bytes;
+}
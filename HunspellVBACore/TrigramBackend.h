@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "AffixRules.h"
+#include "SuggestionBackend.h"
+
+/**
+ * @brief Candidate search through an inverted trigram index over dictionary roots.
+ *
+ * Hunspell's n-gram pass scores every root of the dictionary against the
+ * misspelling, so it slows down with every dictionary added. Here each
+ * root (and each word added at runtime) is listed under the trigrams of its
+ * beginning-marked text, and a lookup only visits the posting lists of the
+ * misspelling's own trigrams. The kMaxRoots roots that share most of their
+ * trigrams with the misspelling are expanded with the affix rules, and the
+ * forms within a length-dependent edit distance are ranked by distance and
+ * Similarity().
+ *
+ * Posting lists only grow at the end (root ids are assigned in order), so
+ * AddWord and AddDictionary update the index in place.
+ */
+class TrigramBackend : public SuggestionBackend {
+public:
+	/** Roots expanded per lookup; Hunspell's ngsuggest keeps as many (MAX_ROOTS). */
+	static const size_t kMaxRoots = 100;
+
+	/**
+	 * @param key - key of encrypted .hz files (see DictionaryFile), NULL otherwise
+	 * @return false if the .aff or .dic file cannot be read
+	 */
+	bool load(const char* affixFilePath, const char* dictionaryFilePath, const char* key = nullptr);
+
+	void suggest(std::string_view word, size_t maxCount, CandidateList& out) const override;
+	void addWord(std::string_view word) override;
+	bool addDictionary(const char* dictionaryFilePath, const char* key) override;
+	size_t memoryBytes() const override;
+	const char* name() const override { return "trigram"; }
+
+	size_t rootCount() const { return entries.size(); }
+
+private:
+	void indexEntries(size_t firstEntry);
+
+	AffixRules rules;
+	std::vector<AffixRules::Entry> entries;
+	std::vector<uint8_t> trigramCounts; // distinct trigrams per entry
+	std::unordered_map<uint64_t, std::vector<uint32_t>> postings; // trigram -> entries, ascending
+
+	// Lookup scratch, cleared through touched so a lookup does not pay for
+	// the whole dictionary. Like the engine, a backend is used by one thread.
+	mutable std::vector<uint8_t> sharedCounts;
+	mutable std::vector<uint32_t> touched;
+};
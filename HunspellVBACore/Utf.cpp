@@ -0,0 +1,252 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "Utf.h"
+#include <cstring>
+
+// SSE2 is part of x86-64 and the default target of 32-bit MSVC builds.
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HUNSPELLVBA_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	/**
+	 * Copy the leading ASCII units of text to out, one byte each, and return
+	 * how many there were. out must have room for size bytes.
+	 */
+	size_t NarrowAscii(const char16_t* text, size_t size, char* out) {
+		size_t i = 0;
+#ifdef HUNSPELLVBA_SSE2
+		// A unit is ASCII when none of its bits above 0x7F is set; packing
+		// then keeps its low byte.
+		const __m128i nonAscii = _mm_set1_epi16((short)0xFF80);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 8 <= size; i += 8) {
+			__m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, nonAscii), zero)) != 0xFFFF) {
+				break;
+			}
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(units, units));
+		}
+		if (i + 4 <= size) {
+			__m128i units = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(text + i));
+			if ((_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, nonAscii), zero)) & 0xFF) == 0xFF) {
+				int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(units, units));
+				memcpy(out + i, &bytes, 4);
+				i += 4;
+			}
+		}
+#endif
+		for (; i < size && text[i] < 0x80; ++i) {
+			out[i] = (char)text[i];
+		}
+		return i;
+	}
+
+	/** Write the UTF-8 encoding of c to out, which needs room for 4 bytes. @return the end of it */
+	char* EncodeCodePoint(char32_t c, char* out) {
+		if (c < 0x80) {
+			*out++ = (char)c;
+		}
+		else if (c < 0x800) {
+			*out++ = (char)(0xC0 | (c >> 6));
+			*out++ = (char)(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000) {
+			*out++ = (char)(0xE0 | (c >> 12));
+			*out++ = (char)(0x80 | ((c >> 6) & 0x3F));
+			*out++ = (char)(0x80 | (c & 0x3F));
+		}
+		else {
+			*out++ = (char)(0xF0 | (c >> 18));
+			*out++ = (char)(0x80 | ((c >> 12) & 0x3F));
+			*out++ = (char)(0x80 | ((c >> 6) & 0x3F));
+			*out++ = (char)(0x80 | (c & 0x3F));
+		}
+		return out;
+	}
+
+	template <typename String>
+	void AppendCodePoint(char32_t c, String& out) {
+		if (c < 0x80) {
+			out += (char)c;
+			return;
+		}
+		char bytes[4];
+		out.append(bytes, EncodeCodePoint(c, bytes) - bytes);
+	}
+
+	template <typename String>
+	void AppendCodePoints(std::u32string_view text, String& out) {
+		out.reserve(out.size() + text.size());
+		for (char32_t c : text) {
+			AppendCodePoint(c > 0x10FFFF ? 0xFFFD : c, out);
+		}
+	}
+
+	template <typename String>
+	void DecodeInto(std::string_view text, String& out) {
+		out.clear();
+		out.reserve(text.size());
+
+		for (size_t i = 0; i < text.size();) {
+			unsigned char lead = (unsigned char)text[i];
+			if (lead < 0x80) {
+				out += lead;
+				++i;
+				continue;
+			}
+
+			size_t length = lead >= 0xF0 && lead <= 0xF4 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC2 && lead < 0xE0 ? 2 : 0;
+			char32_t c = length == 4 ? lead & 0x07 : length == 3 ? lead & 0x0F : lead & 0x1F;
+			bool valid = length != 0 && i + length <= text.size();
+			for (size_t k = 1; valid && k < length; ++k) {
+				unsigned char next = (unsigned char)text[i + k];
+				valid = (next & 0xC0) == 0x80;
+				c = (c << 6) | (next & 0x3F);
+			}
+			if (valid && ((length == 3 && (c < 0x800 || (c >= 0xD800 && c <= 0xDFFF))) || (length == 4 && (c < 0x10000 || c > 0x10FFFF)))) {
+				valid = false;
+			}
+
+			if (valid) {
+				out += c;
+				i += length;
+			}
+			else {
+				out += (char32_t)0xFFFD;
+				++i;
+			}
+		}
+	}
+}
+
+void AppendUtf8(std::u16string_view text, std::string& out) {
+	// Encoded into a stack buffer that is appended once per word (or per
+	// 256 bytes of longer text), so the loop writes through a plain pointer.
+	char chunk[256];
+	char* end = chunk;
+	for (size_t i = 0; i < text.size(); ++i) {
+		if (end + 4 > chunk + sizeof(chunk)) {
+			out.append(chunk, end - chunk);
+			end = chunk;
+		}
+
+		char32_t c = text[i];
+		if (c < 0x80) {
+			// Runs of ASCII, usually the whole word, are narrowed in bulk.
+			size_t room = chunk + sizeof(chunk) - end;
+			size_t run = NarrowAscii(text.data() + i, text.size() - i < room ? text.size() - i : room, end);
+			end += run;
+			i += run - 1;
+			continue;
+		}
+		if (c >= 0xD800 && c <= 0xDFFF) {
+			if (c <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+				c = 0x10000 + ((c - 0xD800) << 10) + (text[i + 1] - 0xDC00);
+				++i;
+			}
+			else {
+				c = 0xFFFD;
+			}
+		}
+		end = EncodeCodePoint(c, end);
+	}
+	out.append(chunk, end - chunk);
+}
+
+void AppendUtf8(std::u32string_view text, std::string& out) {
+	AppendCodePoints(text, out);
+}
+
+void AppendUtf8(std::u32string_view text, std::pmr::string& out) {
+	AppendCodePoints(text, out);
+}
+
+void DecodeUtf8(std::string_view text, std::u32string& out) {
+	DecodeInto(text, out);
+}
+
+void DecodeUtf8(std::string_view text, std::pmr::u32string& out) {
+	DecodeInto(text, out);
+}
+
+bool FoldAsciiCase(std::string_view word, std::string& out) {
+	size_t upper = 0;
+	size_t lower = 0;
+	for (char c : word) {
+		if ((unsigned char)c >= 0x80) {
+			return false;
+		}
+		upper += c >= 'A' && c <= 'Z';
+		lower += c >= 'a' && c <= 'z';
+	}
+	bool initial = upper == 1 && word[0] >= 'A' && word[0] <= 'Z';
+	if (!initial && (upper == 0 || lower != 0)) {
+		return false;
+	}
+
+	out.assign(word.data(), word.size());
+	for (char& c : out) {
+		if (c >= 'A' && c <= 'Z') {
+			c = (char)(c + ('a' - 'A'));
+		}
+	}
+	return true;
+}
+
+TextEncoding DetectEncoding(std::string_view bytes, size_t& bomSize) {
+	if (bytes.size() >= 3 && bytes.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+		bomSize = 3;
+		return TextEncoding::Utf8;
+	}
+	if (bytes.size() >= 2 && bytes.compare(0, 2, "\xFF\xFE") == 0) {
+		bomSize = 2;
+		return TextEncoding::Utf16LE;
+	}
+	if (bytes.size() >= 2 && bytes.compare(0, 2, "\xFE\xFF") == 0) {
+		bomSize = 2;
+		return TextEncoding::Utf16BE;
+	}
+
+	bomSize = 0;
+	size_t sample = bytes.size() < 4096 ? bytes.size() : 4096;
+	sample &= ~(size_t)1;
+	size_t evenZeros = 0;
+	size_t oddZeros = 0;
+	for (size_t i = 0; i < sample; i += 2) {
+		evenZeros += bytes[i] == 0;
+		oddZeros += bytes[i + 1] == 0;
+	}
+
+	size_t units = sample / 2;
+	if (units != 0 && oddZeros * 2 > units && evenZeros * 8 < units) {
+		return TextEncoding::Utf16LE;
+	}
+	if (units != 0 && evenZeros * 2 > units && oddZeros * 8 < units) {
+		return TextEncoding::Utf16BE;
+	}
+	return TextEncoding::Utf8;
+}
@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024-2025 Nazar Mammedov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+/** Encodings recognised by DetectEncoding. The values are part of the DLL interface. */
+enum class TextEncoding {
+	Utf8 = 0,
+	Utf16LE = 1,
+	Utf16BE = 2
+};
+
+/**
+ * @brief Append the UTF-8 encoding of UTF-16 text to out.
+ *
+ * Unpaired surrogates are replaced with U+FFFD, which is what
+ * WideCharToMultiByte(CP_UTF8, 0, ...) does, so results match the
+ * conversion the exports used before.
+ */
+void AppendUtf8(std::u16string_view text, std::string& out);
+
+/** Append the UTF-8 encoding of code points to out. */
+void AppendUtf8(std::u32string_view text, std::string& out);
+void AppendUtf8(std::u32string_view text, std::pmr::string& out);
+
+/**
+ * @brief Replace the contents of out with the code points of UTF-8 text.
+ *
+ * Malformed sequences decode to one U+FFFD per offending byte.
+ */
+void DecodeUtf8(std::string_view text, std::u32string& out);
+void DecodeUtf8(std::string_view text, std::pmr::u32string& out);
+
+/** Replace the contents of out with the UTF-8 encoding of text. */
+inline void ToUtf8(std::u16string_view text, std::string& out) {
+	out.clear();
+	AppendUtf8(text, out);
+}
+
+/**
+ * @brief Replace the contents of out with a capitalised ASCII word in lowercase.
+ *
+ * Only the two capitalisations Hunspell retries in lowercase are folded: an
+ * uppercase first letter with no other uppercase letters ("Word") and no
+ * lowercase letters at all ("WORD", "NATO's" is not).
+ *
+ * @return false, leaving out alone, if word has other bytes than ASCII or
+ *         another capitalisation
+ */
+bool FoldAsciiCase(std::string_view word, std::string& out);
+
+/**
+ * @brief Guess the encoding of raw file bytes.
+ *
+ * A byte order mark decides if there is one. Otherwise the first 4 KB are
+ * sampled: text where most bytes at odd (even) positions are zero is taken as
+ * UTF-16LE (BE), everything else as UTF-8.
+ *
+ * @param bomSize - receives the size of the byte order mark, 0 if none
+ */
+TextEncoding DetectEncoding(std::string_view bytes, size_t& bomSize);
@@ -22,10 +22,20 @@
  * SOFTWARE.
  */
 #include "pch.h"
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
 #include "CppUnitTest.h"
 #include "../HunspellVBA/HunspellVBA.h"
-#include "../HunspellVBA/HunspellVBA.cpp"
+#include "../HunspellVBACore/Automaton.h"
+#include "../HunspellVBACore/CorrectionTable.h"
+#include "../HunspellVBACore/ScratchArena.h"
+#include "../HunspellVBACore/Utf.h"
 #include <Windows.h>
 #include <oleauto.h>
 
@@ -33,6 +43,16 @@ using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace HunspellVBATests
 {
+	int __stdcall CollectFirstMisspelling(const char* word, int wordLength, int offset, int length, void* context) {
+		*static_cast<std::string*>(context) = std::string(word, wordLength) + "@" + std::to_string(offset) + ":" + std::to_string(length);
+		return 0;
+	}
+
+	int __stdcall CountItems(const char* item, int itemLength, int index, void* context) {
+		++*static_cast<int*>(context);
+		return 1;
+	}
+
 	TEST_CLASS(HunspellVBATests)
 	{
 	public:
@@ -42,13 +62,13 @@ namespace HunspellVBATests
 			const char* affixFilePath = "lang/tk-TM.aff";
 			const char* dictionaryFilePath = "lang/tk-TM.dic";
 
-			Hunspell* hunspell = nullptr;
+			HunspellHandle* hunspell = nullptr;
 
 			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
 
 			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
 
-			delete hunspell;
+			HunspellFree(hunspell);
 		}
 
 		TEST_METHOD(HunspellInitInvalidParametersTest)
@@ -56,7 +76,7 @@ namespace HunspellVBATests
 			const char* validAffixFilePath = "lang/tk-TM.aff";
 			const char* validDictionaryFilePath = "lang/tk-TM.dic";
 
-			Hunspell* hunspell = nullptr;
+			HunspellHandle* hunspell = nullptr;
 
 			// Test 1: Null pointer for Hunspell** parameter
 			try {
@@ -94,7 +114,7 @@ namespace HunspellVBATests
 				Assert::Fail(L"Unexpected exception type thrown.");
 			}
 
-			delete hunspell;
+			HunspellFree(hunspell);
 			hunspell = nullptr;
 		}
 
@@ -104,7 +124,7 @@ namespace HunspellVBATests
 		{
 			const char* affixFilePath = "lang/tk-TM.aff";
 			const char* dictionaryFilePath = "lang/tk-TM.dic";
-			Hunspell* hunspell = nullptr;
+			HunspellHandle* hunspell = nullptr;
 
 			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
 			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
@@ -126,7 +146,7 @@ namespace HunspellVBATests
 		{
 			const char* affixFilePath = "lang/tk-TM.aff";
 			const char* dictionaryFilePath = "lang/tk-TM.dic";
-			Hunspell* hunspell = nullptr;
+			HunspellHandle* hunspell = nullptr;
 
 			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
 			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
@@ -157,7 +177,7 @@ namespace HunspellVBATests
 		{
 			const char* affixFilePath = "lang/tk-TM.aff";
 			const char* dictionaryFilePath = "lang/tk-TM.dic";
-			Hunspell* hunspell = nullptr;
+			HunspellHandle* hunspell = nullptr;
 
 			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
 			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
@@ -179,11 +199,50 @@ namespace HunspellVBATests
 			HunspellFree(hunspell);
 		}
 
+		TEST_METHOD(CheckAndSuggestTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			int count = -1;
+			const char** suggestions = nullptr;
+			BSTR word = SysAllocString(L"kitap");
+			Assert::AreEqual(1, CheckAndSuggest(hunspell, word, 5, &suggestions, &count), L"Correct word");
+			Assert::IsNull(suggestions, L"No suggestions for a correct word");
+			Assert::AreEqual(0, count);
+			SysFreeString(word);
+
+			// The suggestions are the first ones GetSuggestions returns.
+			word = SysAllocString(L"bazal");
+			int allCount = 0;
+			const char** all = GetSuggestions(hunspell, word, &allCount);
+			Assert::AreEqual(0, CheckAndSuggest(hunspell, word, 2, &suggestions, &count), L"Misspelled word");
+			Assert::IsTrue(allCount > 0 && count == (allCount < 2 ? allCount : 2), L"Suggestions are bounded by maxCount");
+			for (int i = 0; i < count; ++i) {
+				Assert::AreEqual(std::string(all[i]), std::string(suggestions[i]));
+			}
+			FreeItems(suggestions, count);
+			FreeItems(all, allCount);
+
+			Assert::AreEqual(0, CheckAndSuggest(hunspell, word, 0, &suggestions, &count), L"maxCount 0 only checks");
+			Assert::IsNull(suggestions);
+			Assert::AreEqual(-3, CheckAndSuggest(hunspell, word, -1, &suggestions, &count), L"Negative maxCount");
+			Assert::AreEqual(-2, CheckAndSuggest(hunspell, word, 5, nullptr, &count));
+			Assert::AreEqual(-1, CheckAndSuggest(nullptr, word, 5, &suggestions, &count));
+			SysFreeString(word);
+
+			HunspellFree(hunspell);
+		}
+
 		TEST_METHOD(GetSuffixSuggestionsTest)
 		{
 			const char* affixFilePath = "lang/tk-TM.aff";
 			const char* dictionaryFilePath = "lang/tk-TM.dic";
-			Hunspell* hunspell = nullptr;
+			HunspellHandle* hunspell = nullptr;
 
 			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
 			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
@@ -210,7 +269,7 @@ namespace HunspellVBATests
 		{
 			const char* affixFilePath = "lang/tk-TM.aff";
 			const char* dictionaryFilePath = "lang/tk-TM.dic";
-			Hunspell* hunspell = nullptr;
+			HunspellHandle* hunspell = nullptr;
 
 			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
 			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
@@ -238,7 +297,7 @@ namespace HunspellVBATests
 		{
 			const char* affixFilePath = "lang/tk-TM.aff";
 			const char* dictionaryFilePath = "lang/tk-TM.dic";
-			Hunspell* hunspell = nullptr;
+			HunspellHandle* hunspell = nullptr;
 
 			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
 			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
@@ -260,5 +319,785 @@ namespace HunspellVBATests
 
 			HunspellFree(hunspell);
 		}
+
+		TEST_METHOD(StatsTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			BSTR word = SysAllocString(L"zanar");
+			CheckSpelling(hunspell, word);
+
+			int length = GetStats(hunspell, nullptr, 0);
+			std::string json(length + 1, '\0');
+			GetStats(hunspell, &json[0], length + 1);
+			Assert::IsTrue(json.find("\"enabled\":false") != std::string::npos, L"Stats are off by default");
+			Assert::IsTrue(json.find("\"check\":0") != std::string::npos, L"Nothing is counted while stats are off");
+
+			EnableStats(hunspell, 1);
+			CheckSpelling(hunspell, word);
+			CheckSpelling(hunspell, word);
+
+			length = GetStats(hunspell, nullptr, 0);
+			json.assign(length + 1, '\0');
+			GetStats(hunspell, &json[0], length + 1);
+			Assert::IsTrue(json.find("\"check\":2") != std::string::npos, L"Two checks are counted");
+			Assert::IsTrue(json.find("\"misses\":2") != std::string::npos, L"Two misses are counted");
+
+			ResetStats(hunspell);
+			length = GetStats(hunspell, nullptr, 0);
+			json.assign(length + 1, '\0');
+			GetStats(hunspell, &json[0], length + 1);
+			Assert::IsTrue(json.find("\"check\":0") != std::string::npos, L"Counters are reset");
+
+			SysFreeString(word);
+			HunspellFree(hunspell);
+		}
+
+		TEST_METHOD(TraceTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			TraceClear();
+			TraceEnable(1);
+			BSTR word = SysAllocString(L"şagal");
+			CheckSpelling(hunspell, word);
+			TraceEnable(0);
+
+			int spans = TraceDump("trace.json");
+			Assert::IsTrue(spans >= 3, L"CheckSpelling, conversion and spell spans are recorded");
+
+			std::ifstream traceFile("trace.json");
+			std::string trace((std::istreambuf_iterator<char>(traceFile)), std::istreambuf_iterator<char>());
+			Assert::IsTrue(trace.find("\"name\":\"CheckSpelling\"") != std::string::npos, L"Export span is in the trace");
+			Assert::IsTrue(trace.find("\"name\":\"spell\"") != std::string::npos, L"Spell span is in the trace");
+
+			SysFreeString(word);
+			HunspellFree(hunspell);
+		}
+
+		TEST_METHOD(LogTest)
+		{
+			LogSetLevel(3);
+
+			BSTR word = SysAllocString(L"şagal");
+			for (int i = 0; i < 100; ++i) {
+				bool result = CheckSpelling(nullptr, word);
+				Assert::IsFalse(result, L"Null handle is rejected");
+			}
+
+			int entries = LogDump("log.txt");
+			Assert::IsTrue(entries > 0, L"Errors are logged");
+			Assert::IsTrue(entries < 100, L"Repeated errors are rate limited");
+
+			std::ifstream logFile("log.txt");
+			std::string log((std::istreambuf_iterator<char>(logFile)), std::istreambuf_iterator<char>());
+			Assert::IsTrue(log.find("ERROR Null pointer passed for Hunspell instance.") != std::string::npos, L"Message is in the log");
+
+			LogSetLevel(2);
+			SysFreeString(word);
+		}
+
+		TEST_METHOD(StemTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			int count;
+			BSTR word = SysAllocString(L"okuwçynyň");
+			const char** stems = Stem(hunspell, word, &count);
+			Assert::AreNotEqual(0, count, L"No stems returned");
+
+			bool found = false;
+			for (int i = 0; i < count; ++i) {
+				found = found || std::string(stems[i]) == u8"okuwçy";
+			}
+			Assert::IsTrue(found, L"The stem of 'okuwçynyň' should be 'okuwçy'");
+			FreeItems(stems, count);
+
+			const char** analyses = Analyze(hunspell, word, &count);
+			Assert::AreNotEqual(0, count, L"No analyses returned");
+			FreeItems(analyses, count);
+			SysFreeString(word);
+
+			BSTR text = SysAllocString(L"Okuwçynyň okuwçy, okuwçynyň okuwçy!");
+			stems = StemText(hunspell, text, &count);
+			Assert::AreNotEqual(0, count, L"No stems returned for text");
+
+			std::unordered_set<std::string> unique;
+			for (int i = 0; i < count; ++i) {
+				Assert::IsTrue(unique.insert(stems[i]).second, L"Stems are deduplicated");
+			}
+			Assert::IsTrue(unique.count(u8"okuwçy") == 1, L"The stem 'okuwçy' is returned");
+			FreeItems(stems, count);
+			SysFreeString(text);
+
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(CheckFileTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			// UTF-16LE with BOM: "Hemme zatd gowy"
+			std::ofstream file("checkfile.txt", std::ios::binary);
+			file.write("\xFF\xFE", 2);
+			const wchar_t text[] = L"Hemme zatd gowy";
+			file.write((const char*)text, (sizeof(text) - sizeof(wchar_t)));
+			file.close();
+
+			int* ranges = nullptr;
+			int count = 0;
+			int encoding = CheckFile(hunspell, "checkfile.txt", &ranges, &count);
+			Assert::AreEqual(1, encoding, L"UTF-16LE is detected");
+			Assert::AreEqual(1, count, L"One misspelling expected");
+			Assert::AreEqual(14, ranges[0], L"Byte offset of 'zatd' includes the BOM");
+			Assert::AreEqual(8, ranges[1], L"Byte length of 'zatd'");
+			FreeRanges(ranges);
+
+			Assert::AreEqual(-3, CheckFile(hunspell, "missing.txt", &ranges, &count), L"Missing file is reported");
+
+			HunspellFree(hunspell);
+		}
+
+		TEST_METHOD(CheckRangeTest)
+		{
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, "lang/tk-TM.aff", "lang/tk-TM.dic");
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			// Range.Value of A1:B2: text, a number, nothing and text.
+			SAFEARRAYBOUND bounds[2] = { { 2, 1 }, { 2, 1 } };
+			VARIANT values;
+			VariantInit(&values);
+			V_VT(&values) = VT_ARRAY | VT_VARIANT;
+			V_ARRAY(&values) = SafeArrayCreate(VT_VARIANT, 2, bounds);
+			VARIANT cell;
+			VariantInit(&cell);
+			LONG a1[2] = { 1, 1 }, a2[2] = { 2, 1 }, b2[2] = { 2, 2 };
+			V_VT(&cell) = VT_BSTR;
+			V_BSTR(&cell) = SysAllocString(L"Hemme zatd gowy");
+			SafeArrayPutElement(V_ARRAY(&values), a1, &cell);
+			VariantClear(&cell);
+			V_VT(&cell) = VT_I4;
+			V_I4(&cell) = 42;
+			SafeArrayPutElement(V_ARRAY(&values), a2, &cell);
+			V_VT(&cell) = VT_BSTR;
+			V_BSTR(&cell) = SysAllocString(L"gowy zatd");
+			SafeArrayPutElement(V_ARRAY(&values), b2, &cell);
+			VariantClear(&cell);
+
+			int* records = nullptr;
+			int count = 0;
+			Assert::AreEqual(2, CheckRange(hunspell, &values, &records, &count));
+			Assert::AreEqual(2, count, L"Numbers and empty cells are skipped");
+			Assert::AreEqual(1, records[0], L"Row of A1");
+			Assert::AreEqual(1, records[1], L"Column of A1");
+			Assert::AreEqual(6, records[2], L"Offset of 'zatd' in A1");
+			Assert::AreEqual(4, records[3], L"Length of 'zatd'");
+			Assert::AreEqual(2, records[4], L"Row of B2");
+			Assert::AreEqual(2, records[5], L"Column of B2");
+			Assert::AreEqual(5, records[6], L"Offset of 'zatd' in B2");
+			FreeRanges(records);
+
+			// A one-cell range gives the value itself.
+			V_VT(&cell) = VT_BSTR;
+			V_BSTR(&cell) = SysAllocString(L"zatd");
+			Assert::AreEqual(1, CheckRange(hunspell, &cell, &records, &count));
+			FreeRanges(records);
+			VariantClear(&cell);
+			V_VT(&cell) = VT_R8;
+			V_R8(&cell) = 1.5;
+			Assert::AreEqual(-3, CheckRange(hunspell, &cell, &records, &count), L"Not text and not an array");
+			Assert::AreEqual(-2, CheckRange(hunspell, nullptr, &records, &count));
+			Assert::AreEqual(-1, CheckRange(nullptr, &values, &records, &count));
+
+			VariantClear(&values);
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(StreamTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			HunspellStream* stream = nullptr;
+			Assert::AreEqual(0, StreamOpen(hunspell, 0, &stream), L"Stream is opened");
+
+			// "zatd" is split between the two chunks
+			Assert::AreEqual(8, StreamPush(stream, "Hemme za", 8));
+			Assert::AreEqual(7, StreamPush(stream, "td gowy", 7));
+			Assert::AreEqual(1, StreamFinish(stream));
+
+			long long offsets[4];
+			int lengths[4];
+			const char** words = nullptr;
+			int count = StreamDrain(stream, 4, offsets, lengths, &words);
+			Assert::AreEqual(1, count, L"One misspelling expected");
+			Assert::AreEqual(6LL, offsets[0], L"Offset is global to the stream");
+			Assert::AreEqual(4, lengths[0]);
+			Assert::AreEqual("zatd", words[0]);
+			FreeItems(words, count);
+
+			StreamClose(stream);
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(CallbackTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			// The callback stops after the first result
+			std::string first;
+			BSTR text = SysAllocString(L"Hemme zatd gowy bazal");
+			Assert::AreEqual(1, GetMisspellingsCallback(hunspell, text, CollectFirstMisspelling, &first));
+			Assert::AreEqual(std::string("zatd@6:4"), first);
+			SysFreeString(text);
+
+			int delivered = 0;
+			int count = 0;
+			BSTR word = SysAllocString(L"zanar");
+			const char** suggestions = GetSuggestions(hunspell, word, &count);
+			Assert::AreEqual(count, GetSuggestionsCallback(hunspell, word, CountItems, &delivered));
+			Assert::AreEqual(count, delivered, L"Every suggestion is delivered");
+			FreeItems(suggestions, count);
+			SysFreeString(word);
+
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(CorrectionsTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			CorrectionTable::Entries entries;
+			entries.push_back({ "kitapb", { "kitap", "kitaby" } });
+			entries.push_back({ "zatd", { "zat" } });
+			Assert::IsTrue(CorrectionTable::write("corrections.bin", entries));
+			Assert::AreEqual(2, LoadCorrections(hunspell, "corrections.bin"));
+			Assert::AreEqual(-3, LoadCorrections(hunspell, "missing.bin"), L"A missing table is reported");
+
+			EnableStats(hunspell, 1);
+			int count;
+			BSTR word = SysAllocString(L"kitapb");
+			const char** suggestions = GetSuggestions(hunspell, word, &count);
+			Assert::AreEqual(2, count, L"Suggestions come from the table");
+			Assert::AreEqual("kitap", suggestions[0]);
+			FreeItems(suggestions, count);
+			SysFreeString(word);
+
+			char json[2048];
+			GetStats(hunspell, json, sizeof(json));
+			Assert::IsTrue(std::string(json).find("\"hits\":1") != std::string::npos, L"Table hit is counted");
+
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(SymSpellTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			Assert::AreEqual(-2, SetSuggestionBackend(hunspell, 3, 0, nullptr), L"Unknown backend is rejected");
+			Assert::AreEqual(-4, SetSuggestionBackend(hunspell, 1, 1, "missing.txt"), L"Missing frequency list is reported");
+			Assert::AreEqual(0, SetSuggestionBackend(hunspell, 1, 0, nullptr));
+
+			int count;
+			BSTR word = SysAllocString(L"kitapb");
+			const char** suggestions = GetSuggestions(hunspell, word, &count);
+			Assert::IsTrue(count > 0, L"Symmetric delete finds a candidate");
+			Assert::AreEqual("kitap", suggestions[0]);
+			FreeItems(suggestions, count);
+			SysFreeString(word);
+
+			// Suffixed forms are found through the affix rules.
+			word = SysAllocString(L"kitapdn");
+			suggestions = GetSuggestions(hunspell, word, &count);
+			bool found = false;
+			for (int i = 0; i < count; ++i) {
+				found = found || std::string(suggestions[i]) == "kitapdan";
+			}
+			Assert::IsTrue(found, L"kitapdan is suggested");
+			FreeItems(suggestions, count);
+			SysFreeString(word);
+
+			Assert::AreEqual(0, SetSuggestionBackend(hunspell, 0, 0, nullptr));
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(TrigramIndexTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+			Assert::AreEqual(0, SetSuggestionBackend(hunspell, 2, 0, nullptr));
+
+			int count;
+			BSTR word = SysAllocString(L"mekdeplr");
+			const char** suggestions = GetSuggestions(hunspell, word, &count);
+			Assert::IsTrue(count > 0, L"Trigram index finds a candidate");
+			Assert::AreEqual("mekdepler", suggestions[0]);
+			FreeItems(suggestions, count);
+			SysFreeString(word);
+
+			// Words added after the index was built are found without rebuilding it.
+			word = SysAllocString(L"gerontologiýa");
+			Assert::AreEqual(0, AddWord(hunspell, word));
+			SysFreeString(word);
+			word = SysAllocString(L"gerontologiya");
+			suggestions = GetSuggestions(hunspell, word, &count);
+			Assert::IsTrue(count > 0, L"Added word is suggested");
+			Assert::AreEqual("gerontologiýa", suggestions[0]);
+			FreeItems(suggestions, count);
+			SysFreeString(word);
+
+			Assert::AreEqual(0, SetSuggestionBackend(hunspell, 0, 0, nullptr));
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(TokenFilterTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			int count;
+			BSTR text = SysAllocString(L"INV-2024-17 https://example.com/tm info@example.com KDV zatd");
+			const char** items = GetMisspellings(hunspell, text, &count);
+			Assert::IsTrue(count > 1, L"Codes and addresses are flagged without a filter");
+			FreeItems(items, count);
+
+			EnableStats(hunspell, 1);
+			Assert::AreEqual(0, SetTokenFilter(hunspell, 1 + 2 + 4 + 8, 0));
+			items = GetMisspellings(hunspell, text, &count);
+			Assert::AreEqual(1, count, L"Only the misspelled word is left");
+			Assert::AreEqual("zatd", items[0]);
+			FreeItems(items, count);
+
+			int length = GetStats(hunspell, nullptr, 0);
+			std::string json(length + 1, '\0');
+			GetStats(hunspell, &json[0], length + 1);
+			Assert::IsTrue(json.find("\"filtered\":{\"digits\":1,\"urls\":1,\"emails\":1,\"uppercase\":1}") != std::string::npos,
+				L"Skipped tokens are counted per rule");
+
+			BSTR word = SysAllocString(L"KDV");
+			Assert::AreEqual(0, SetTokenFilter(hunspell, 8, 2));
+			Assert::IsFalse(CheckSpelling(hunspell, word), L"Longer uppercase tokens are checked");
+			Assert::AreEqual(0, SetTokenFilter(hunspell, 8, 3));
+			Assert::IsTrue(CheckSpelling(hunspell, word), L"Short uppercase tokens are skipped");
+
+			Assert::AreEqual(-2, SetTokenFilter(hunspell, 16, 0), L"Unknown rules are reported");
+			Assert::AreEqual(-1, SetTokenFilter(nullptr, 1, 0), L"Missing handle is reported");
+			SysFreeString(word);
+			SysFreeString(text);
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(GuardrailsTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+			EnableStats(hunspell, 1);
+			Assert::AreEqual(0, SetGuardrails(hunspell, 64, 32, 0, 0));
+
+			std::wstring blob;
+			for (int i = 0; i < 10; ++i) {
+				blob += L"QmFzZTY0IGJsb2IgcGFzdGVkIGludG8gYSBjZWxs";
+			}
+			BSTR word = SysAllocString(blob.c_str());
+			Assert::IsTrue(CheckSpelling(hunspell, word), L"Over-long words are skipped, not flagged");
+			Assert::AreEqual(1, GetLastSkip(hunspell));
+			int count = -1;
+			const char** suggestions = GetSuggestions(hunspell, word, &count);
+			Assert::AreEqual(0, count, L"Over-long words get no suggestions");
+			Assert::AreEqual(1, GetLastSkip(hunspell));
+			FreeItems(suggestions, count);
+			SysFreeString(word);
+
+			word = SysAllocString(L"kitapb");
+			Assert::IsFalse(CheckSpelling(hunspell, word), L"Short words are still checked");
+			Assert::AreEqual(0, GetLastSkip(hunspell));
+			Assert::AreEqual(0, SetGuardrails(hunspell, 0, 0, 10, 0));
+			suggestions = GetSuggestions(hunspell, word, &count);
+			Assert::AreEqual(0, count, L"The budget also bounds Hunspell's suggest");
+			Assert::AreEqual(2, GetLastSkip(hunspell));
+			FreeItems(suggestions, count);
+			Assert::AreEqual(0, SetGuardrails(hunspell, 0, 0, 0, 10000));
+			suggestions = GetSuggestions(hunspell, word, &count);
+			Assert::IsTrue(count > 0, L"Suggestions within the timeout are returned");
+			Assert::AreEqual(0, GetLastSkip(hunspell));
+			FreeItems(suggestions, count);
+			SysFreeString(word);
+
+			int length = GetStats(hunspell, nullptr, 0);
+			std::string json(length + 1, '\0');
+			GetStats(hunspell, &json[0], length + 1);
+			Assert::IsTrue(json.find("\"skipped\":{\"length\":2,\"budget\":1,\"timeout\":0}") != std::string::npos,
+				L"Trips are counted");
+
+			Assert::AreEqual(-2, SetGuardrails(hunspell, -1, 0, 0, 0));
+			Assert::AreEqual(-1, GetLastSkip(nullptr));
+			HunspellFree(hunspell);
+		}
+
+
+		TEST_METHOD(SharedDictionaryTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* first = nullptr;
+			HunspellHandle* second = nullptr;
+
+			int words = HunspellInitShared(&first, affixFilePath, dictionaryFilePath, ".");
+			Assert::IsNotNull(first, L"Failed to initialize Hunspell");
+			Assert::IsTrue(words > 0, L"The first handle builds the shared automaton");
+			Assert::AreEqual(words, HunspellInitShared(&second, affixFilePath, dictionaryFilePath, "."),
+				L"The second handle attaches to the same automaton");
+
+			BSTR word = SysAllocString(L"şagal");
+			Assert::IsTrue(CheckSpelling(second, word), L"Correct words are answered by the automaton");
+			SysFreeString(word);
+
+			word = SysAllocString(L"zanar");
+			Assert::IsFalse(CheckSpelling(second, word), L"Misspellings still go to Hunspell");
+			Assert::AreEqual(0, AddWord(second, word));
+			Assert::IsTrue(CheckSpelling(second, word), L"Added words are private to the handle");
+			Assert::IsFalse(CheckSpelling(first, word), L"Other handles do not see added words");
+			SysFreeString(word);
+
+			HunspellHandle* missing = nullptr;
+			Assert::AreEqual(-1, HunspellInitShared(&missing, affixFilePath, dictionaryFilePath, nullptr));
+			HunspellFree(second);
+			HunspellFree(first);
+		}
+
+
+		TEST_METHOD(ReloadDictionaryTest)
+		{
+			const char* dictionaryFilePath = "reload.dic";
+			std::ofstream("reload.dic", std::ios::binary) << "1\nzanar\n";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, "lang/tk-TM.aff", dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+			BSTR published = SysAllocString(L"pyrtyk");
+			BSTR added = SysAllocString(L"kalamdan");
+			Assert::IsFalse(CheckSpelling(hunspell, published));
+			Assert::AreEqual(0, AddWord(hunspell, added));
+
+			std::ofstream("reload.dic", std::ios::binary) << "2\nzanar\npyrtyk\n";
+			Assert::AreEqual(0, ReloadDictionary(hunspell, 0), L"Reload runs in the background");
+			Assert::AreEqual(-2, ReloadDictionary(hunspell, 0), L"One reload at a time");
+			Assert::AreEqual(1, ReloadDictionary(hunspell, 1), L"Waiting installs the running reload");
+			Assert::IsTrue(CheckSpelling(hunspell, published), L"Words of the new file are accepted");
+			Assert::IsTrue(CheckSpelling(hunspell, added), L"Added words survive the reload");
+
+			remove(dictionaryFilePath);
+			Assert::AreEqual(-3, ReloadDictionary(hunspell, 1), L"Missing files are reported");
+			Assert::IsTrue(CheckSpelling(hunspell, published), L"The current dictionary is kept");
+			Assert::AreEqual(-1, ReloadDictionary(nullptr, 1));
+			SysFreeString(added);
+			SysFreeString(published);
+			HunspellFree(hunspell);
+		}
+
+		TEST_METHOD(SnapshotTest)
+		{
+			const char* dictionaryFilePath = "snapshot.dic";
+			const char* snapshotFilePath = "snapshot.hvs";
+			std::ofstream("snapshot.dic", std::ios::binary) << "2\nzanar\npyrtyk\n";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, "lang/tk-TM.aff", dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+			BSTR added = SysAllocString(L"kalamdan");
+			Assert::AreEqual(0, AddWord(hunspell, added));
+			Assert::AreEqual(0, SaveHandleSnapshot(hunspell, snapshotFilePath));
+			HunspellFree(hunspell);
+
+			hunspell = nullptr;
+			Assert::IsTrue(LoadHandleSnapshot(&hunspell, snapshotFilePath, nullptr) >= 3, L"Words of the snapshot");
+			Assert::IsNotNull(hunspell);
+			BSTR word = SysAllocString(L"pyrtyk");
+			Assert::IsTrue(CheckSpelling(hunspell, word), L"Dictionary words are accepted");
+			Assert::IsTrue(CheckSpelling(hunspell, added), L"Added words are restored");
+			Assert::AreEqual(0, SaveHandleSnapshot(hunspell, snapshotFilePath), L"A restored handle saves over its own file");
+			Assert::IsTrue(CheckSpelling(hunspell, word), L"The handle still reads the replaced file");
+			HunspellFree(hunspell);
+			hunspell = nullptr;
+			Assert::IsTrue(LoadHandleSnapshot(&hunspell, snapshotFilePath, nullptr) >= 3, L"The saved snapshot loads");
+			HunspellFree(hunspell);
+
+			std::ofstream("snapshot.dic", std::ios::binary) << "1\nzanar\n";
+			Assert::AreEqual(-3, LoadHandleSnapshot(&hunspell, snapshotFilePath, nullptr), L"The dictionary changed");
+			Assert::IsNull(hunspell);
+			Assert::AreEqual(-2, LoadHandleSnapshot(&hunspell, "missing.hvs", nullptr));
+			Assert::AreEqual(-1, LoadHandleSnapshot(nullptr, snapshotFilePath, nullptr));
+			Assert::AreEqual(-1, SaveHandleSnapshot(nullptr, snapshotFilePath));
+			SysFreeString(word);
+			SysFreeString(added);
+			remove(snapshotFilePath);
+			remove(dictionaryFilePath);
+		}
+
+		TEST_METHOD(CompressedDictionaryTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* compressedFilePath = "lang/tk-TM_compressed.dic";
+			HunspellHandle* handle = nullptr;
+
+			Assert::AreEqual(0, HunspellInitWithKey(&handle, affixFilePath, "lang/tk-TM.dic", nullptr),
+				L"Plain dictionaries load as before");
+			Assert::IsNotNull(handle, L"Failed to initialize Hunspell");
+			Assert::AreEqual(-4, AddDictionaryWithKey(handle, compressedFilePath, "kalam"), L"Wrong key");
+			Assert::AreEqual(1, AddDictionaryWithKey(handle, compressedFilePath, "katip"), L"Read from the .hz file");
+
+			BSTR word = SysAllocString(L"gerontologiýa");
+			Assert::IsTrue(CheckSpelling(handle, word), L"Words of the compressed dictionary are accepted");
+			SysFreeString(word);
+			Assert::AreEqual(-3, AddDictionaryWithKey(handle, "lang/missing.dic", nullptr));
+			HunspellFree(handle);
+
+			HunspellHandle* missing = nullptr;
+			Assert::AreEqual(-2, HunspellInitWithKey(&missing, affixFilePath, "lang/missing.dic", nullptr));
+			Assert::IsNull(missing);
+		}
+
+
+		TEST_METHOD(RankCandidatesTest)
+		{
+			const char* candidates[] = { "kitaplar", "kitap", "mekdep", "kitapy" };
+			int distances[4];
+			int order[4];
+
+			BSTR word = SysAllocString(L"kitapb");
+			Assert::AreEqual(4, RankCandidates(word, candidates, 4, distances, order));
+			Assert::AreEqual(1, distances[1], L"One letter too many");
+			Assert::AreEqual(1, distances[3], L"One letter substituted");
+			Assert::AreEqual(3, distances[0]);
+			Assert::AreEqual(1, order[0], L"Closest first");
+			Assert::AreEqual(3, order[1], L"Ties keep their order");
+			Assert::AreEqual(0, order[2]);
+			Assert::AreEqual(2, order[3]);
+
+			// Swapped letters count once, and code points rather than bytes are compared.
+			const char* swapped[] = { "\xC3\xBD" "a\xC5\x88y", "a\xC3\xBD\xC5\x88y" };
+			SysFreeString(word);
+			word = SysAllocString(L"a\x00FD\x0148y");
+			Assert::AreEqual(2, RankCandidates(word, swapped, 2, distances, nullptr));
+			Assert::AreEqual(1, distances[0]);
+			Assert::AreEqual(0, distances[1]);
+
+			Assert::AreEqual(-2, RankCandidates(word, nullptr, 1, distances, order), L"Missing candidates are reported");
+			Assert::AreEqual(-1, RankCandidates(nullptr, candidates, 4, distances, order), L"Missing word is reported");
+			SysFreeString(word);
+		}
+
+
+		TEST_METHOD(AutomatonTest)
+		{
+			const char* affixFilePath = "lang/tk-TM.aff";
+			const char* dictionaryFilePath = "lang/tk-TM.dic";
+			HunspellHandle* hunspell = nullptr;
+
+			HunspellInit(&hunspell, affixFilePath, dictionaryFilePath);
+			Assert::IsNotNull(hunspell, L"Failed to initialize Hunspell");
+
+			// "zzzq" is only in the automaton, so accepting it proves the
+			// automaton answered; "kitapb" is in neither.
+			std::vector<std::string_view> words = { "kitapda", "kitap", "zzzq", "kitap" };
+			AutomatonBuilder builder;
+			Assert::IsTrue(builder.build(words, "automaton.bin"));
+			Assert::AreEqual(3, LoadAutomaton(hunspell, "automaton.bin"), L"Duplicates are dropped");
+			Assert::AreEqual(-3, LoadAutomaton(hunspell, "missing.bin"), L"A missing automaton is reported");
+
+			BSTR word = SysAllocString(L"zzzq");
+			Assert::IsTrue(CheckSpelling(hunspell, word), L"Word found in the automaton");
+			SysFreeString(word);
+			word = SysAllocString(L"zzz");
+			Assert::IsFalse(CheckSpelling(hunspell, word), L"Prefix of a word is not accepted");
+			SysFreeString(word);
+			word = SysAllocString(L"Zzzq");
+			Assert::IsTrue(CheckSpelling(hunspell, word), L"Capitalised words are looked up in lowercase");
+			SysFreeString(word);
+			word = SysAllocString(L"ZZZQ");
+			Assert::IsTrue(CheckSpelling(hunspell, word), L"Uppercase words are looked up in lowercase");
+			SysFreeString(word);
+			word = SysAllocString(L"ZzZq");
+			Assert::IsFalse(CheckSpelling(hunspell, word), L"Mixed case is not folded");
+			SysFreeString(word);
+			word = SysAllocString(L"kitapb");
+			Assert::IsFalse(CheckSpelling(hunspell, word), L"Hunspell still rejects misspellings");
+			SysFreeString(word);
+			word = SysAllocString(L"mekdep");
+			Assert::IsTrue(CheckSpelling(hunspell, word), L"Words missing from the automaton fall back to Hunspell");
+			SysFreeString(word);
+
+			// The targets are last in the file; send the last arc past the states.
+			std::ifstream source("automaton.bin", std::ios::binary);
+			std::string damaged((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+			damaged.replace(damaged.size() - 4, 4, "\xFF\xFF\xFF\x7F", 4);
+			std::ofstream("damaged.bin", std::ios::binary) << damaged;
+			Assert::AreEqual(-3, LoadAutomaton(hunspell, "damaged.bin"), L"A damaged automaton is rejected");
+			remove("damaged.bin");
+
+			HunspellFree(hunspell);
+		}
+
+		TEST_METHOD(ScratchArenaTest)
+		{
+			ScratchArena arena;
+			void* first = nullptr;
+			{
+				ScratchArena::Scope outer(arena);
+				first = arena.allocate(100, 1);
+				{
+					ScratchArena::Scope inner(arena);
+					(void)arena.allocate(100, 1);
+				}
+				Assert::IsTrue(arena.allocate(100, 1) != first, L"An inner scope does not reset the arena");
+
+				for (size_t alignment = 1; alignment <= 64; alignment *= 2) {
+					void* p = arena.allocate(3, alignment);
+					Assert::AreEqual((size_t)0, (size_t)(reinterpret_cast<uintptr_t>(p) % alignment), L"Allocations are aligned");
+				}
+
+				for (size_t i = 0; i < 64; ++i) {
+					(void)arena.allocate(64 * 1024, 8);
+				}
+				Assert::IsTrue(arena.capacity() > ScratchArena::kMaxRetained);
+			}
+			Assert::IsTrue(arena.capacity() > 0, L"Blocks are kept for the next call");
+			Assert::IsTrue(arena.capacity() <= ScratchArena::kMaxRetained, L"Blocks beyond kMaxRetained are released");
+			Assert::IsTrue(arena.allocate(100, 1) == first, L"The outermost scope resets the arena");
+		}
+
+		TEST_METHOD(Utf16ConversionTest)
+		{
+			// The plain encoder the bulk ASCII path has to agree with: unpaired
+			// surrogates become U+FFFD.
+			auto reference = [](std::u16string_view text) {
+				std::string out;
+				for (size_t i = 0; i < text.size(); ++i) {
+					char32_t c = text[i];
+					if (c >= 0xD800 && c <= 0xDFFF) {
+						if (c <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+							c = 0x10000 + ((c - 0xD800) << 10) + (text[i + 1] - 0xDC00);
+							++i;
+						}
+						else {
+							c = 0xFFFD;
+						}
+					}
+					if (c < 0x80) {
+						out += (char)c;
+					}
+					else if (c < 0x800) {
+						out += (char)(0xC0 | (c >> 6));
+						out += (char)(0x80 | (c & 0x3F));
+					}
+					else if (c < 0x10000) {
+						out += (char)(0xE0 | (c >> 12));
+						out += (char)(0x80 | ((c >> 6) & 0x3F));
+						out += (char)(0x80 | (c & 0x3F));
+					}
+					else {
+						out += (char)(0xF0 | (c >> 18));
+						out += (char)(0x80 | ((c >> 12) & 0x3F));
+						out += (char)(0x80 | ((c >> 6) & 0x3F));
+						out += (char)(0x80 | (c & 0x3F));
+					}
+				}
+				return out;
+			};
+
+			// ASCII runs around the 4- and 8-unit blocks, and around the
+			// 256-byte chunk the encoder appends in, each ended by a two-byte
+			// letter, a surrogate pair, and lone high and low surrogates, with
+			// and without text after them.
+			const std::u16string tails[] = { u"é", u"\U0001F600", std::u16string(1, (char16_t)0xD800), std::u16string(1, (char16_t)0xDC00) };
+			std::vector<size_t> runs = { 0, 1, 3, 4, 7, 8, 9, 12 };
+			for (size_t run = 248; run <= 264; ++run) {
+				runs.push_back(run);
+			}
+			std::string converted;
+			for (size_t run : runs) {
+				for (const std::u16string& tail : tails) {
+					for (const std::u16string& prefix : { std::u16string(), std::u16string(u"ç") }) {
+						std::u16string text = prefix + std::u16string(run, u'a') + tail;
+						ToUtf8(text, converted);
+						Assert::AreEqual(reference(text), converted);
+
+						text += u"bcdefghij";
+						ToUtf8(text, converted);
+						Assert::AreEqual(reference(text), converted);
+					}
+				}
+			}
+
+			// Mixed text several chunks long, appended after existing bytes.
+			std::u16string text;
+			for (int i = 0; i < 200; ++i) {
+				text += std::u16string((size_t)(i % 13), (char16_t)(u'a' + i % 26)) + tails[i % 4];
+			}
+			converted = "prefix";
+			AppendUtf8(text, converted);
+			Assert::AreEqual("prefix" + reference(text), converted);
+		}
 	};
 }
\ No newline at end of file